@@ -0,0 +1,379 @@
+/*
+Benchmark da rede social
+
+Descrição:
+- Mede as operações do grafo em tamanhos, densidades e modelos de geração configuráveis, com sementes fixas
+  para que os resultados sejam comparáveis entre commits.
+- Cada medida é repetida várias vezes; o resultado traz a mediana e o percentil 99 da latência, as arestas
+  percorridas por segundo (TEPS) quando a operação percorre um componente inteiro e o pico de memória (RSS).
+- A saída é um JSON na saída padrão. Qualquer saída impressa pelas funções medidas (mensagens) é descartada.
+- Usa só a interface pública da biblioteca (`redesocial.h`); as buscas de caminho medidas são as versões sem
+  impressão (`shortestPath`, `longestPath`, `longestPathBetween`). As buscas com peso rodam no mesmo grafo depois
+  de `generateRandomWeights`.
+- A BFS fora da memória lê um snapshot gravado em /tmp; como o arquivo acabou de ser gravado, ele costuma estar
+  no cache de páginas, então a medida mostra o custo do processamento em lotes, não o do disco.
+- As buscas do caminho mais longo (DFS) são exponenciais e rodam em um grafo pequeno à parte (`--dfs-users`).
+
+Uso:
+  ED_Benchmark [--users n] [--degree d] [--model uniform|preferential] [--runs r] [--generate-runs r]
+               [--seed s] [--dfs-users n]
+*/
+
+#include "redesocial.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// Estrutura para representar os parâmetros do benchmark
+typedef struct BenchmarkOptions {
+    int numUsers;  // Número de usuários do grafo principal
+    int averageDegree;  // Grau médio desejado
+    bool preferential;  // true para ligação preferencial, false para conexões uniformes
+    int runs;  // Repetições de cada consulta
+    int generateRuns;  // Repetições da geração do grafo
+    unsigned int seed;  // Semente base
+    int dfsUsers;  // Número de usuários do grafo usado nas buscas DFS
+} BenchmarkOptions;
+
+// Relógio monotônico em segundos
+static double nowSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Compara dois doubles para qsort
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Pico de memória do processo em KB
+static long peakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Gera as conexões do grafo segundo o modelo escolhido
+static void generateBenchmarkConnections(Graph* graph, const BenchmarkOptions* options, unsigned int seed) {
+    int degree = options->averageDegree;
+    if (options->preferential) {
+        generatePreferentialConnections(graph, degree / 2 > 0 ? degree / 2 : 1, seed);
+    } else {
+        long long maxConnections = (long long)graph->numUsers * (graph->numUsers - 1) / 2;
+        long long connections = (long long)graph->numUsers * degree / 2;
+        generateUniformConnections(graph, (int)(connections < maxConnections ? connections : maxConnections), seed);
+    }
+}
+
+// Escreve o resultado de uma medida no JSON
+// samples: Duração de cada repetição em segundos (é ordenado)
+// edges: Arestas percorridas por repetição (0 se TEPS não se aplica)
+static void reportBenchmark(FILE* json, const char* name, double* samples, int count, double edges, bool* first) {
+    qsort(samples, count, sizeof(double), compareDoubles);
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += samples[i];
+    }
+    double median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    int p99Index = (int)ceil(0.99 * count) - 1;
+    double p99 = samples[p99Index < 0 ? 0 : p99Index];
+
+    fprintf(json, "%s\n    {\"name\": \"%s\", \"runs\": %d, \"median_ms\": %.6f, \"p99_ms\": %.6f, \"mean_ms\": %.6f, ",
+            *first ? "" : ",", name, count, median * 1e3, p99 * 1e3, total / count * 1e3);
+    if (edges > 0) {
+        fprintf(json, "\"teps\": %.1f, ", edges * count / total);
+    } else {
+        fprintf(json, "\"teps\": null, ");
+    }
+    fprintf(json, "\"peak_rss_kb\": %ld}", peakRSS());
+    *first = false;
+}
+
+// Lê os argumentos; retorna false se algum for inválido
+static bool parseBenchmarkOptions(int argc, char* argv[], BenchmarkOptions* options) {
+    options->numUsers = 10000;
+    options->averageDegree = 8;
+    options->preferential = false;
+    options->runs = 100;
+    options->generateRuns = 3;
+    options->seed = 42;
+    options->dfsUsers = 10;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[i + 1];
+        if (strcmp(argv[i], "--users") == 0) {
+            options->numUsers = atoi(value);
+        } else if (strcmp(argv[i], "--degree") == 0) {
+            options->averageDegree = atoi(value);
+        } else if (strcmp(argv[i], "--model") == 0) {
+            if (strcmp(value, "uniform") != 0 && strcmp(value, "preferential") != 0) return false;
+            options->preferential = strcmp(value, "preferential") == 0;
+        } else if (strcmp(argv[i], "--runs") == 0) {
+            options->runs = atoi(value);
+        } else if (strcmp(argv[i], "--generate-runs") == 0) {
+            options->generateRuns = atoi(value);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options->seed = (unsigned int)strtoul(value, NULL, 10);
+        } else if (strcmp(argv[i], "--dfs-users") == 0) {
+            options->dfsUsers = atoi(value);
+        } else {
+            return false;
+        }
+        i++;
+    }
+    return options->numUsers >= 2 && options->averageDegree >= 1 && options->runs >= 1 &&
+           options->generateRuns >= 1 && options->dfsUsers >= 2;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseBenchmarkOptions(argc, argv, &options)) {
+        fprintf(stderr, "Uso: %s [--users n] [--degree d] [--model uniform|preferential] [--runs r] "
+                        "[--generate-runs r] [--seed s] [--dfs-users n]\n", argv[0]);
+        return 1;
+    }
+
+#ifdef ED_INSTRUMENTATION
+    atexit(instrumentationReportAtExit);  // Tabela em stderr, separada do JSON
+#endif
+
+    // O JSON vai para a saída padrão original; o que as funções medidas imprimem é descartado
+    FILE* json = fdopen(dup(STDOUT_FILENO), "w");
+    if (!json || !freopen("/dev/null", "w", stdout)) {
+        return 1;
+    }
+
+    int n = options.numUsers;
+    int runs = options.runs;
+    int maxRuns = runs > options.generateRuns ? runs : options.generateRuns;
+    double* samples = (double*)malloc(maxRuns * sizeof(double));
+    int* sources = (int*)malloc(runs * sizeof(int));
+    int* targets = (int*)malloc(runs * sizeof(int));
+    if (!samples || !sources || !targets) exit(1);
+
+    // Pares de consulta sorteados com a semente base
+    srand(options.seed);
+    for (int r = 0; r < runs; r++) {
+        sources[r] = rand() % n;
+        targets[r] = rand() % n;
+    }
+
+    fprintf(json, "{\n  \"config\": {\"users\": %d, \"average_degree\": %d, \"model\": \"%s\", \"runs\": %d, "
+                  "\"generate_runs\": %d, \"seed\": %u, \"dfs_users\": %d},\n  \"benchmarks\": [",
+            n, options.averageDegree, options.preferential ? "preferential" : "uniform", runs,
+            options.generateRuns, options.seed, options.dfsUsers);
+    bool first = true;
+
+    // Geração: cada repetição usa uma semente diferente; o grafo da primeira é usado nas consultas
+    Graph* graph = NULL;
+    for (int r = 0; r < options.generateRuns; r++) {
+        Graph* generated = createNumberedGraph(n);
+        double start = nowSeconds();
+        generateBenchmarkConnections(generated, &options, options.seed + r);
+        samples[r] = nowSeconds() - start;
+        if (r == 0) {
+            graph = generated;
+        } else {
+            freeGraph(generated);
+        }
+    }
+    reportBenchmark(json, options.preferential ? "generatePreferentialConnections" : "generateUniformConnections",
+                    samples, options.generateRuns, 0, &first);
+    long long numEdges = countConnections(graph);
+
+    // Construção do CSR a partir das listas de adjacência
+    for (int r = 0; r < options.generateRuns; r++) {
+        freeCSR(graph->csr);
+        graph->csr = NULL;
+        double start = nowSeconds();
+        getCSR(graph);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "buildCSR", samples, options.generateRuns, 0, &first);
+
+    // Listagem do grafo com a saída com buffer (descartada em /dev/null)
+    OutputBuffer* out = createOutputBuffer(STDOUT_FILENO, OUTPUT_BUFFER_SIZE);
+    for (int r = 0; r < options.generateRuns; r++) {
+        double start = nowSeconds();
+        outputGraph(out, graph);
+        outputFlush(out);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "outputGraph", samples, options.generateRuns, (double)numEdges, &first);
+    freeOutputBuffer(out);
+
+    // BFS de ponto a ponto sobre as listas encadeadas (sem alocação por consulta)
+    BFSScratch* scratch = createBFSScratch(n);
+    PathResult result;
+    result.path = (int*)malloc(n * sizeof(int));
+    if (!result.path) exit(1);
+    result.capacity = n;
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        shortestPath(graph, scratch, sources[r], targets[r], &result);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "shortestPath", samples, runs, 0, &first);
+
+    // BFS bidirecional (expande sempre a menor fronteira)
+    BFSScratch* backward = createBFSScratch(n);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        bidirectionalShortestPath(graph, scratch, backward, sources[r], targets[r], &result);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "bidirectionalShortestPath", samples, runs, 0, &first);
+    freeBFSScratch(backward);
+
+    // BFS distribuída entre 4 processos (faixas de IDs), mensagens por sockets Unix
+    PartitionedGraph* partitioned = createPartitionedGraph(graph, 4, NULL, NULL);
+    if (partitioned) {
+        for (int r = 0; r < runs; r++) {
+            double start = nowSeconds();
+            partitionedShortestPath(partitioned, sources[r], targets[r], &result);
+            samples[r] = nowSeconds() - start;
+        }
+        reportBenchmark(json, "partitionedShortestPath", samples, runs, 0, &first);
+        freePartitionedGraph(partitioned);
+    }
+
+    // BFS de ponto a ponto sobre o CSR
+    CSRGraph* csr = getCSR(graph);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        bfsShortestPathView(csr->offsets, csr->offsets + 1, csr->neighbors, scratch, sources[r], targets[r], NULL);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "bfsShortestPathView", samples, runs, 0, &first);
+
+    // BFS completa (árvore de BFS): TEPS = arestas do componente da origem / tempo
+    double componentEdges = 0;
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        BFSTree* tree = buildBFSTree(graph, sources[r]);
+        samples[r] = nowSeconds() - start;
+        long long degreeSum = 0;
+        for (int v = 0; v < n; v++) {
+            if (tree->distance[v] >= 0) degreeSum += graph->degree[v];
+        }
+        componentEdges += degreeSum / 2.0;
+        releaseBFSTree(tree);
+    }
+    reportBenchmark(json, "buildBFSTree", samples, runs, componentEdges / runs, &first);
+
+    // BFS completa fora da memória sobre o snapshot gravado em disco (bitmaps no mesmo diretório)
+    char snapshotPath[] = "/tmp/ed-benchmark-XXXXXX";
+    int snapshotFd = mkstemp(snapshotPath);
+    if (snapshotFd >= 0 && writeCSRSnapshot(getCSR(graph), snapshotPath)) {
+        for (int r = 0; r < runs; r++) {
+            double start = nowSeconds();
+            externalBFS(snapshotPath, "/tmp", sources[r], 0, NULL, NULL);
+            samples[r] = nowSeconds() - start;
+        }
+        reportBenchmark(json, "externalBFS", samples, runs, componentEdges / runs, &first);
+    }
+    if (snapshotFd >= 0) {
+        close(snapshotFd);
+        unlink(snapshotPath);
+    }
+
+    // Consultas com poucas origens respondidas pelo cache de árvores de BFS
+    BFSTreeCache* trees = createBFSTreeCache(SERVER_TREE_CACHE_BYTES);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        bfsTreeShortestPath(graph, trees, sources[r % 8], targets[r], result.path, NULL);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "bfsTreeShortestPath", samples, runs, 0, &first);
+    freeBFSTreeCache(trees);
+
+    // Conexões com peso (pesos de 1 a 100): Dijkstra de ponto a ponto e delta-stepping de uma origem para todos
+    generateRandomWeights(graph, 100, options.seed);
+    DijkstraScratch* dijkstra = createDijkstraScratch(n);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        weightedShortestPath(graph, dijkstra, sources[r], targets[r], &result);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "weightedShortestPath", samples, runs, 0, &first);
+    long long* weighted = (long long*)malloc(n * sizeof(long long));
+    if (!weighted) exit(1);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        weightedDistances(graph, sources[r], 0, weighted);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "weightedDistances", samples, runs, componentEdges / runs, &first);
+
+    // Contatos com data (2 por conexão): chegada mais cedo em uma janela de metade do período
+    TemporalEdge* contacts;
+    int numContacts = generateTemporalEdges(graph, 2, 0, 1000000, options.seed, &contacts);
+    for (int r = 0; r < options.generateRuns; r++) {
+        double start = nowSeconds();
+        TemporalCSR* tcsr = buildTemporalCSR(n, contacts, numContacts, false);
+        samples[r] = nowSeconds() - start;
+        freeTemporalCSR(tcsr);
+    }
+    reportBenchmark(json, "buildTemporalCSR", samples, options.generateRuns, 0, &first);
+    TemporalCSR* tcsr = buildTemporalCSR(n, contacts, numContacts, false);
+    for (int r = 0; r < runs; r++) {
+        double start = nowSeconds();
+        earliestArrivalTimes(tcsr, dijkstra, sources[r], 250000, 750000, weighted);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "earliestArrivalTimes", samples, runs, 0, &first);
+    freeTemporalCSR(tcsr);
+    free(contacts);
+    free(weighted);
+    freeDijkstraScratch(dijkstra);
+    freeBFSScratch(scratch);
+    free(result.path);
+    freeGraph(graph);
+
+    // Buscas DFS do caminho mais longo em um grafo pequeno (custo exponencial)
+    BenchmarkOptions small = options;
+    small.numUsers = options.dfsUsers;
+    Graph* dfsGraph = createNumberedGraph(small.numUsers);
+    generateBenchmarkConnections(dfsGraph, &small, options.seed);
+    BFSScratch* dfsScratch = createBFSScratch(small.numUsers);
+    PathResult dfsResult;
+    dfsResult.path = (int*)malloc(small.numUsers * sizeof(int));
+    if (!dfsResult.path) exit(1);
+    dfsResult.capacity = small.numUsers;
+    for (int r = 0; r < options.generateRuns; r++) {
+        double start = nowSeconds();
+        longestPath(dfsGraph, dfsScratch, &dfsResult);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "longestPath", samples, options.generateRuns, 0, &first);
+    for (int r = 0; r < runs; r++) {
+        int source = sources[r] % small.numUsers;
+        int target = targets[r] % small.numUsers;
+        double start = nowSeconds();
+        longestPathBetween(dfsGraph, dfsScratch, source, target, &dfsResult);
+        samples[r] = nowSeconds() - start;
+    }
+    reportBenchmark(json, "longestPathBetween", samples, runs, 0, &first);
+    free(dfsResult.path);
+    freeBFSScratch(dfsScratch);
+    freeGraph(dfsGraph);
+
+    fprintf(json, "\n  ],\n  \"edges\": %lld,\n  \"peak_rss_kb\": %ld\n}\n", numEdges, peakRSS());
+    fclose(json);
+
+    free(samples);
+    free(sources);
+    free(targets);
+    return 0;
+}
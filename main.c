@@ -1,612 +1,296 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-#include <time.h>
-
-#define MAX_QUEUE_SIZE 20
-#define MAX_NAME_LENGTH 10
-
 /*
-1-tapa: Estrutura de Dados para o Grafo
+Programa de linha de comando da rede social
 
 Descrição:
-- A rede social é representada por um grafo, onde cada usuário é um nó.
-- As conexões entre os usuários são representadas por arestas.
-- Utiliza-se uma lista de adjacências para representar as conexões entre os usuários.
-- Cada usuário é identificado por um ID único e um nome.
-
-Estruturas:
-- `User`: Representa um usuário com um ID único e um nome.
-- `AdjacencyNode`: Representa um nó na lista de adjacência que aponta para um usuário conectado.
-- `Graph`: Representa o grafo, contendo um array de usuários e um array de listas de adjacência.
-- `Queue`: Representa uma fila usada para algoritmos de busca.
+- Monta o grafo de exemplo, imprime as conexões e sorteia dois usuários para calcular o menor e o maior caminho
+  entre eles. Com `--server`, atende consultas pela entrada padrão ou por um socket Unix (20-etapa).
+- Com `--export arquivo`, grava também o grafo em DOT ou GraphML (22-etapa) com os três caminhos destacados nas
+  cores do README. Uso:
+  ED_Redes_Sociais [--export arquivo] [--format dot|graphml] [--ego usuario saltos] [--sample fracao]
+                   [--min-degree d] [--max-degree d] [--partitions n]
+- Com `--partitions n`, o menor caminho é calculado pela BFS distribuída entre n processos (27-etapa), com a
+  mesma saída da busca local.
+- Os algoritmos ficam na biblioteca `redesocial` (redesocial.h / redesocial.c); este arquivo só cuida dos
+  argumentos e da impressão dos resultados.
+- Toda a saída passa por um `OutputBuffer` (21-etapa): uma chamada `write` por buffer cheio em vez de vários
+  `printf` por conexão.
 
 Funções:
-- `createNode`: Cria um novo nó na lista de adjacências.
-- `createGraph`: Cria um grafo com um número fixo de usuários.
-- `addConnection`: Adiciona uma conexão entre dois usuários no grafo.
+- `bfsFindShortestPath`: Imprime o menor caminho entre dois usuários (3-etapa).
+- `findLongestPath`: Imprime o caminho mais longo do grafo (4-etapa).
+- `findLongestPath_2`: Imprime o caminho mais longo entre dois usuários (5-etapa).
+- `findPathsBetweenUsers`: Sorteia dois usuários e imprime os caminhos entre eles.
+- `printGraph`: Imprime a lista de conexões de cada usuário.
+- `parseArguments`: Lê as opções da linha de comando.
+- `writeExport`: Grava o grafo (ou a vizinhança escolhida) com os caminhos destacados.
+- `serverMain`: Trata os argumentos do modo servidor.
 */
 
-// Estrutura para representar um usuário
-typedef struct User {
-    int id;  // ID único do usuário
-    char nome[MAX_NAME_LENGTH];  // Nome do usuário
-} User;
-
-// Estrutura para representar um nó na lista de adjacência
-typedef struct AdjacencyNode {
-    User* user;  // Ponteiro para o usuário conectado
-    struct AdjacencyNode* next;  // Ponteiro para o próximo nó adjacente
-} AdjacencyNode;
-
-// Estrutura para representar o grafo
-typedef struct Graph {
-    User** users;  // Array de ponteiros para os usuários
-    AdjacencyNode** adjList;  // Array de listas de adjacências
-    int numUsers;  // Número de usuários (nós)
-    int* visited;  // Array para rastrear os usuários visitados
-} Graph;
-
-// Estrutura para representar uma fila
-typedef struct Queue {
-    int items[MAX_QUEUE_SIZE];  // Array de itens da fila
-    int front;  // Índice do primeiro item
-    int rear;  // Índice do último item
-} Queue;
-
-// Função para criar um novo nó na lista de adjacências
-// user: Ponteiro para o usuário que será adicionado ao nó
-AdjacencyNode* createNode(User* user) {
-    AdjacencyNode* newNode = (AdjacencyNode*) malloc(sizeof(AdjacencyNode));
-    if (!newNode) exit(1);  // Verificação de alocação de memória
-    newNode->user = user;
-    newNode->next = NULL;
-    return newNode;
-
-}
-
-// Função para criar um grafo com um número fixo de usuários
-// numUsers: Número total de usuários (nós)
-// names: Array de nomes dos usuários
-Graph* createGraph(int numUsers, char* names[]) {
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    if (!graph) exit(1);  // Verificação de alocação de memória
-    graph->numUsers = numUsers;
-
-    graph->users = (User**)malloc(numUsers * sizeof(User*));
-    for (int i = 0; i < numUsers; i++) {
-        graph->users[i] = (User*)malloc(sizeof(User));
-        graph->users[i]->id = i;
-        strncpy(graph->users[i]->nome, names[i], MAX_NAME_LENGTH);
-    }
-
-    graph->adjList = (AdjacencyNode**)malloc(numUsers * sizeof(AdjacencyNode*));
-    graph->visited = (int*)malloc(numUsers * sizeof(int));
-
-    for (int i = 0; i < numUsers; i++) {
-        graph->adjList[i] = NULL;
-        graph->visited[i] = 0;
-    }
-
-    return graph;
-}
+#include "redesocial.h"
 
-// Função para adicionar uma conexão (aresta) entre dois usuários
-// graph: Ponteiro para o grafo
-// src: ID do usuário de origem
-// dest: ID do usuário de destino
-void addConnection(Graph* graph, int src, int dest) {
-    // Adiciona uma conexão de src para dest
-    AdjacencyNode* newNode = createNode(graph->users[dest]);
-    newNode->next = graph->adjList[src];
-    graph->adjList[src] = newNode;
-
-    // Como o grafo é não direcionado, adiciona também a conexão de dest para src
-    newNode = createNode(graph->users[src]);
-    newNode->next = graph->adjList[dest];
-    graph->adjList[dest] = newNode;
-}
-
-/*
-2-etapa: Gerar Conexões Aleatórias
-
-Descrição:
-- Conectar aleatoriamente os usuários para simular as interações em uma rede social.
-- Cada conexão entre dois usuários é representada por uma aresta no grafo.
-- A geração das conexões será feita de forma aleatória, respeitando as restrições de não haver auto-conexões e não duplicar conexões.
-
-Funções:
-- `connectionExists`: Verifica se uma conexão entre dois usuários já existe.
-- `generateRandomConnections`: Gera e adiciona conexões aleatórias entre os usuários no grafo.
-- `countConnections`: Conta o número total de conexões (arestas) presentes no grafo.
-*/
-
-// Função para verificar se uma conexão entre dois usuários já existe
-// graph: Ponteiro para o grafo
-// src: ID do usuário de origem
-// dest: ID do usuário de destino
-// Retorna true se a conexão já existir, caso contrário, retorna false
-bool connectionExists(Graph* graph, int src, int dest) {
-    AdjacencyNode* temp = graph->adjList[src];
-    while (temp) {
-        if (temp->user->id == dest) {
-            return true;  // A conexão já existe
-        }
-        temp = temp->next;
-    }
-    return false;  // A conexão não existe
-}
-
-// Função para gerar conexões aleatórias entre os usuários
-// graph: Ponteiro para o grafo
-// numConnections: Número desejado de conexões a serem adicionadas
-void generateRandomConnections(Graph* graph, int numConnections) {
-    // Verifica se o número solicitado de conexões excede o número máximo possível
-    if (numConnections > graph->numUsers * (graph->numUsers - 1) / 2) {
-        printf("Numero de conexoes solicitado e maior do que o maximo possivel.\n");
-        return;  // Se o número solicitado for maior, exibe uma mensagem de erro e retorna
-    }
-
-    srand(time(0));  // Inicializa o gerador de números aleatórios com a semente baseada no tempo atual
-
-    int connectionsAdded = 0;  // Contador para acompanhar o número de conexões adicionadas
-
-    // Continua tentando adicionar conexões até que o número desejado de conexões seja alcançado
-    while (connectionsAdded < numConnections) {
-        int src = rand() % graph->numUsers;  // Seleciona aleatoriamente um usuário de origem
-        int dest = rand() % graph->numUsers;  // Seleciona aleatoriamente um usuário de destino
-
-        // Verifica se a conexão não é uma auto-conexão e se a conexão ainda não existe
-        if (src != dest && !connectionExists(graph, src, dest)) {
-            addConnection(graph, src, dest);  // Adiciona a conexão ao grafo
-            connectionsAdded++;  // Incrementa o contador de conexões adicionadas
-        }
-    }
-}
-
-// Função para contar o número total de conexões (arestas) no grafo
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Estrutura para representar as opções da linha de comando
+typedef struct CommandArguments {
+    const char* path;  // Arquivo de exportação (NULL se não há exportação)
+    ExportOptions options;  // Formato e filtros da exportação
+    int egoUser;  // Usuário central da vizinhança exportada (-1 para o grafo inteiro)
+    int egoHops;  // Saltos da vizinhança
+    int partitions;  // Processos da BFS distribuída (0 para a busca local)
+} CommandArguments;
+
+// Função para encontrar e imprimir o menor caminho entre dois usuários usando BFS
+// out: Saída com buffer
 // graph: Ponteiro para o grafo
-int countConnections(Graph* graph) {
-    int count = 0;  // Inicializa o contador de conexões
-
-    // Itera sobre todos os usuários no grafo
-    for (int i = 0; i < graph->numUsers; i++) {
-        AdjacencyNode* temp = graph->adjList[i];  // Pega a lista de adjacências para o usuário i
-
-        // Itera sobre todos os nós adjacentes ao usuário i
-        while (temp) {
-            count++;  // Incrementa o contador de conexões para cada nó adjacente
-            temp = temp->next;  // Move para o próximo nó na lista de adjacências
-        }
-    }
-
-    // Como cada conexão é contada duas vezes (uma para cada direção em um grafo não direcionado),
-    // dividimos o total de contagens por 2 para obter o número real de conexões
-    return count / 2;
-}
-
-/*
-3-tapa: Implementar a Busca em Largura (BFS) para encontrar o menor caminho
-
-Descrição:
-- A função `bfsFindShortestPath` utiliza a BFS para explorar o grafo, partindo de um usuário inicial (startVertex) e procurando o caminho mais curto até o usuário final (finalVertex).
-- Durante o processo, a BFS mantém rastros de predecessores e distâncias para reconstruir o caminho ao encontrar o destino.
-- O uso de uma fila (queue) é essencial para gerenciar a exploração em camadas de proximidade.
-
-Funções de Suporte:
-- `createQueue`: Inicializa e retorna uma nova fila.
-- `isEmpty`: Verifica se a fila está vazia.
-- `enqueue`: Adiciona um elemento na fila.
-- `dequeue`: Remove e retorna um elemento da fila.
-- `freeQueue`: Libera a memória alocada para a fila.
-
-Função Principal:
-- `bfsFindShortestPath`: Executa a BFS para encontrar e exibir o menor caminho entre dois usuários.
-*/
-
-// Função para inicializar a fila
-Queue* createQueue() {
-    Queue* queue = (Queue*) malloc(sizeof(Queue));
-    queue->front = -1;
-    queue->rear = -1;
-    return queue;
-}
-
-// Verifica se a fila está vazia
-int isEmpty(Queue* queue) {
-    if (queue->rear == -1)
-        return 1;
-    return 0;
-}
-
-// Função para adicionar um elemento na fila
-int enqueue(Queue* queue, int value) {
-    if (queue->rear == MAX_QUEUE_SIZE - 1) {
-        // Fila cheia
-        return 0;  // Retorna 0 para indicar falha
+// scratch: Estado de BFS reutilizável
+// partitioned: Grafo particionado que responde a busca (NULL para a busca local)
+// result: Resultado com buffer para numUsers IDs
+// startVertex: ID do usuário de origem
+// finalVertex: ID do usuário de destino
+void bfsFindShortestPath(OutputBuffer* out, Graph* graph, BFSScratch* scratch, PartitionedGraph* partitioned, PathResult* result, int startVertex, int finalVertex) {
+    bool found = partitioned ? partitionedShortestPath(partitioned, startVertex, finalVertex, result)
+                             : shortestPath(graph, scratch, startVertex, finalVertex, result);
+    if (found) {
+        outputString(out, "\nCaminho mais curto: ");
+        outputPath(out, graph, result);
+        outputString(out, "\nDistancia: ");
+        outputInt(out, result->distance);
+        outputChar(out, '\n');
     } else {
-        if (queue->front == -1) {
-            queue->front = 0;
-        }
-        queue->rear++;
-        queue->items[queue->rear] = value;
-        return 1;  // Retorna 1 para indicar sucesso
+        outputString(out, "\nCaminho nao encontrado entre ");
+        outputString(out, graph->users[startVertex]->nome);
+        outputString(out, " e ");
+        outputString(out, graph->users[finalVertex]->nome);
+        outputString(out, ".\n");
     }
 }
 
-// Função para remover um elemento da fila
-int dequeue(Queue* queue) {
-    if (isEmpty(queue)) {
-        // Fila vazia
-        return -1;  // Retorna um valor especial para indicar que a fila está vazia
+// Função para encontrar e imprimir o caminho mais longo usando DFS
+// out: Saída com buffer
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável
+// result: Resultado com buffer para numUsers IDs
+void findLongestPath(OutputBuffer* out, Graph* graph, BFSScratch* scratch, PathResult* result) {
+    if (longestPath(graph, scratch, result)) {
+        outputString(out, "\nCaminho mais longo do grafo:\n");
+        outputPath(out, graph, result);
+        outputString(out, "\nDistancia: ");
+        outputInt(out, result->distance);
+        outputChar(out, '\n');
     } else {
-        int item = queue->items[queue->front];
-        queue->front++;
-        if (queue->front > queue->rear) {
-            // Reinicializa a fila quando todos os elementos são removidos
-            queue->front = -1;
-            queue->rear = -1;
-        }
-        return item;
-    }
-}
-
-// Função para liberar a memória alocada para a fila
-void freeQueue(Queue* queue) {
-    if (queue != NULL) {
-        free(queue);  // Libera a memória alocada para a estrutura Queue
-        queue = NULL; // Define o ponteiro como NULL para evitar referências pendentes
+        outputString(out, "\nNao ha caminhos no grafo.\n");
     }
 }
 
-// Função para encontrar o menor caminho entre dois usuários usando BFS
+// Função para encontrar e imprimir o caminho mais longo entre dois usuários usando DFS
+// out: Saída com buffer
 // graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável
+// result: Resultado com buffer para numUsers IDs
 // startVertex: ID do usuário de origem
 // finalVertex: ID do usuário de destino
-void bfsFindShortestPath(Graph* graph, int startVertex, int finalVertex) {
-    Queue* q = createQueue();
-    int* predecessor = malloc(graph->numUsers * sizeof(int));  // Array para armazenar predecessores
-    int* distance = malloc(graph->numUsers * sizeof(int));    // Array para armazenar as distâncias
-
-    // Inicializa todos os vértices como não visitados, sem predecessores e com distância infinita
-    for (int i = 0; i < graph->numUsers; i++) {
-        graph->visited[i] = 0;
-        predecessor[i] = -1;
-        distance[i] = -1;
-    }
-
-    // Configura o vértice inicial
-    graph->visited[startVertex] = 1;
-    distance[startVertex] = 0;
-    enqueue(q, startVertex);
-
-    while (!isEmpty(q)) {
-        int currentVertex = dequeue(q);
-        AdjacencyNode* temp = graph->adjList[currentVertex];
-
-        while (temp != NULL) {
-            int adjVertex = temp->user->id;
-
-            if (graph->visited[adjVertex] == 0) {
-                graph->visited[adjVertex] = 1;
-                distance[adjVertex] = distance[currentVertex] + 1;
-                predecessor[adjVertex] = currentVertex;
-                enqueue(q, adjVertex);
-
-                if (adjVertex == finalVertex) {
-                    // Reconstruir o caminho usando uma pilha
-                    int path[graph->numUsers];
-                    int top = -1;
-                    int crawl = finalVertex;
-
-                    while (crawl != -1) {
-                        path[++top] = crawl;
-                        crawl = predecessor[crawl];
-                    }
-
-                    printf("\nCaminho mais curto: ");
-                    while (top >= 0) {
-                        printf("%s", graph->users[path[top--]]->nome);
-                        if (top >= 0) {
-                            printf(" -> ");
-                        }
-                    }
-                    printf("\nDistancia: %d\n", distance[finalVertex]);
-
-                    free(predecessor);
-                    free(distance);
-                    freeQueue(q);
-                    return;
-                }
-            }
-            temp = temp->next;
-        }
+void findLongestPath_2(OutputBuffer* out, Graph* graph, BFSScratch* scratch, PathResult* result, int startVertex, int finalVertex) {
+    if (longestPathBetween(graph, scratch, startVertex, finalVertex, result)) {
+        outputString(out, "\nCaminho mais longo :\n");
+        outputPath(out, graph, result);
+        outputString(out, "\nDistancia: ");
+        outputInt(out, result->distance);
+        outputChar(out, '\n');
+    } else {
+        outputString(out, "\nNao ha caminhos no grafo.\n");
     }
-
-    // Se a BFS terminar e o finalVertex não foi alcançado
-    printf("\nCaminho nao encontrado entre %s e %s.\n", graph->users[startVertex]->nome, graph->users[finalVertex]->nome);
-
-    free(predecessor);
-    free(distance);
-    freeQueue(q);
 }
 
-/*
-4ª Etapa: Encontrar o Maior Caminho go grafo
+// Função que sorteia dois usuários e calcula o menor e o maior caminho entre eles
+// out: Saída com buffer
+// graph: Ponteiro para o grafo
+// partitioned: Grafo particionado que responde o menor caminho (NULL para a busca local)
+// paths: Resultados com buffer para numUsers IDs: menor caminho, maior caminho entre os dois e maior do grafo
+void findPathsBetweenUsers(OutputBuffer* out, Graph* graph, PartitionedGraph* partitioned, PathResult paths[3]) {
+    srand(time(NULL));  // Inicializa a semente para números aleatórios
 
-Descrição:
-- Implementação de funções que utilizam DFS (Busca em Profundidade) para encontrar o maior caminho possível  do grafo.
-- As funções fornecem a capacidade de explorar o grafo para encontrar caminhos e avaliar a conectividade entre usuários.
+    int startVertex = rand() % graph->numUsers;  // Sorteia o vértice inicial
+    int finalVertex;
+    do {
+        finalVertex = rand() % graph->numUsers;  // Sorteia o vértice final diferente do inicial
+    } while (finalVertex == startVertex);
 
-Funções:
+    outputString(out, "\nUsuario inicial: ");
+    outputString(out, graph->users[startVertex]->nome);
+    outputString(out, "\nUsuario final: ");
+    outputString(out, graph->users[finalVertex]->nome);
+    outputChar(out, '\n');
 
-1. `dfsFindLongestPath`
-   - Objetivo: Encontrar o caminho mais longo possível no grafo a partir de um vértice inicial.
-   - Parâmetros:
-     - `graph`: Ponteiro para o grafo.
-     - `currentVertex`: Vértice atual sendo explorado.
-     - `visited`: Array para marcar os vértices já visitados.
-     - `currentPath`: Array que armazena o caminho atual.
-     - `pathIndex`: Índice atual do caminho.
-     - `maxPathLength`: Comprimento máximo do caminho encontrado até agora.
-     - `endVertex`: Vértice final do caminho mais longo encontrado.
-     - `bestPath`: Array que armazena o melhor caminho (o mais longo) encontrado.
-   - Descrição: Explora todos os vértices adjacentes, atualiza o caminho mais longo encontrado e permite a reconstrução do caminho mais longo possível.
-
-2. `findLongestPath`
-   - Objetivo: Encontrar e imprimir o caminho mais longo
-   - Descrição: Itera sobre todos os vértices do grafo, utilizando a função `dfsFindLongestPath` para encontrar o caminho mais longo a partir de cada vértice. Imprime o caminho mais longo encontrado, se existir.
-
-3. `findPathsBetweenUsers`
-   - Objetivo: Sorteia dois usuários e calcula o menor e o maior caminho entre eles.
-   - Descrição: Sorteia dois usuários diferentes, calcula o menor caminho usando BFS e o maior caminho possível no grafo usando DFS. Imprime os resultados.
+    // Um único estado de busca atende as três consultas
+    BFSScratch* scratch = createBFSScratch(graph->numUsers);
 
-*/
+    // Calcula e imprime o menor caminho entre os usuários sorteados
+    bfsFindShortestPath(out, graph, scratch, partitioned, &paths[0], startVertex, finalVertex);
 
-// Função auxiliar para DFS que encontra o caminho mais longo
-void dfsFindLongestPath(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* endVertex, int* bestPath) {
-    visited[currentVertex] = 1;  // Marca o vértice atual como visitado
-    currentPath[pathIndex] = currentVertex;  // Adiciona o vértice ao caminho atual
-    pathIndex++;
-
-    AdjacencyNode* temp = graph->adjList[currentVertex];
-    int hasNeighbor = 0;
-
-    // Explora todos os vértices adjacentes
-    while (temp != NULL) {
-        int adjVertex = temp->user->id;
-        if (!visited[adjVertex]) {
-            hasNeighbor = 1;
-            dfsFindLongestPath(graph, adjVertex, visited, currentPath, pathIndex, maxPathLength, endVertex, bestPath);
-        }
-        temp = temp->next;
-    }
+    findLongestPath_2(out, graph, scratch, &paths[1], startVertex, finalVertex);
 
-    // Se não houver mais vizinhos para explorar
-    if (!hasNeighbor) {
-        // Se o caminho atual for o mais longo encontrado, atualiza o melhor caminho
-        if (pathIndex > *maxPathLength) {
-            *maxPathLength = pathIndex;
-            *endVertex = currentVertex;
-            for (int i = 0; i < pathIndex; i++) {
-                bestPath[i] = currentPath[i];
-            }
-        }
-    }
+    // Calcula e imprime o maior caminho encontrado no grafo
+    findLongestPath(out, graph, scratch, &paths[2]);
 
-    pathIndex--;
-    visited[currentVertex] = 0;  // Desmarca o vértice atual para futuras explorações
+    freeBFSScratch(scratch);
 }
 
-// Função para encontrar e imprimir o caminho mais longo usando DFS
-void findLongestPath(Graph* graph) {
-    int* visited = malloc(graph->numUsers * sizeof(int));      // Array de visitados
-    int* currentPath = malloc(graph->numUsers * sizeof(int));  // Array para o caminho atual
-    int* bestPath = malloc(graph->numUsers * sizeof(int));     // Array para armazenar o melhor caminho
-    int maxPathLength = 0;                                     // Comprimento máximo do caminho encontrado
-    int endVertex = -1;                                        // Vértice final do caminho mais longo
-
-    // Inicializa o array de visitados
-    for (int i = 0; i < graph->numUsers; i++) {
-        visited[i] = 0;
-    }
-
-    // Chama DFS para encontrar o caminho mais longo a partir de cada vértice
-    for (int i = 0; i < graph->numUsers; i++) {
-        if (!visited[i]) {
-            dfsFindLongestPath(graph, i, visited, currentPath, 0, &maxPathLength, &endVertex, bestPath);
-        }
-    }
-
-    // Imprime o caminho mais longo encontrado, se existir
-    if (endVertex != -1) {
-        printf("\nCaminho mais longo do grafo:\n");
-        for (int i = 0; i < maxPathLength; i++) {
-            printf("%s", graph->users[bestPath[i]]->nome);
-            if (i < maxPathLength - 1) {
-                printf(" -> ");
-            }
-        }
-        printf("\nDistancia: %d\n", maxPathLength - 1);
-    } else {
-        printf("\nNao ha caminhos no grafo.\n");
-    }
-
-    // Libera a memória alocada
-    free(visited);
-    free(currentPath);
-    free(bestPath);
+// Função para imprimir o grafo
+// out: Saída com buffer
+// graph: Ponteiro para o grafo
+void printGraph(OutputBuffer* out, Graph* graph) {
+    outputGraph(out, graph);
 }
 
-/*
-5-etapa : Implementa DFS para descobrir o caminho mais longo entre dois pontos.
-
-(Correção das funcionalidades...)
-
-Descrição: as demais funcões da 4-etapa implementam a busca do maior caminho do grafo, uma vez que o requisito era:
-"Encontrar o caminho mais longo entre dois pontos". Diante disso foi necessario uma pequena modificação na função:
-´findLongestPath´, adicionando novos parametros para a a funcao modificada ´findLongestPath_2´, assim sendo possivel
-encontrar o maior caminho entre os dois pontos.
-
-*/
-
-void dfsFindLongestPath_2(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* bestPath, int finalVertex) {
-    visited[currentVertex] = 1;  // Marca o vértice atual como visitado
-    currentPath[pathIndex] = currentVertex;  // Adiciona o vértice ao caminho atual
-    pathIndex++;
-
-    // Se o vértice final for alcançado, verifica se o caminho atual é o mais longo
-    if (currentVertex == finalVertex) {
-        if (pathIndex > *maxPathLength) {
-            *maxPathLength = pathIndex;
-            for (int i = 0; i < pathIndex; i++) {
-                bestPath[i] = currentPath[i];
-            }
-        }
-    } else {
-        // Explora todos os vértices adjacentes
-        AdjacencyNode* temp = graph->adjList[currentVertex];
-        while (temp != NULL) {
-            int adjVertex = temp->user->id;
-            if (!visited[adjVertex]) {
-                dfsFindLongestPath_2(graph, adjVertex, visited, currentPath, pathIndex, maxPathLength, bestPath, finalVertex);
+// Função para ler as opções da linha de comando
+// args: Saída com as opções (args->path fica NULL sem --export)
+// numUsers: Número de usuários do grafo
+// Retorna false se alguma opção for inválida
+bool parseArguments(int argc, char* argv[], CommandArguments* args, int numUsers) {
+    args->path = NULL;
+    initExportOptions(&args->options);
+    args->egoUser = -1;
+    args->egoHops = 0;
+    args->partitions = 0;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--export") == 0) {
+            args->path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--format") == 0) {
+            i++;
+            if (strcmp(argv[i], "dot") == 0) {
+                args->options.format = EXPORT_DOT;
+            } else if (strcmp(argv[i], "graphml") == 0) {
+                args->options.format = EXPORT_GRAPHML;
+            } else {
+                return false;
             }
-            temp = temp->next;
+        } else if (i + 2 < argc && strcmp(argv[i], "--ego") == 0) {
+            args->egoUser = atoi(argv[++i]);
+            args->egoHops = atoi(argv[++i]);
+            if (args->egoUser < 0 || args->egoUser >= numUsers || args->egoHops < 0) return false;
+        } else if (i + 1 < argc && strcmp(argv[i], "--sample") == 0) {
+            args->options.sampleRate = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--min-degree") == 0) {
+            args->options.minDegree = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--max-degree") == 0) {
+            args->options.maxDegree = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--partitions") == 0) {
+            args->partitions = atoi(argv[++i]);
+            if (args->partitions < 1 || args->partitions > numUsers) return false;
+        } else {
+            return false;
         }
     }
-
-    visited[currentVertex] = 0;  // Desmarca o vértice atual para futuras explorações
-    pathIndex--;
+    return true;
 }
 
-void findLongestPath_2(Graph* graph, int startVertex, int finalVertex) {
-    int* visited = malloc(graph->numUsers * sizeof(int));      // Array de visitados
-    int* currentPath = malloc(graph->numUsers * sizeof(int));  // Array para o caminho atual
-    int* bestPath = malloc(graph->numUsers * sizeof(int));     // Array para armazenar o melhor caminho
-    int maxPathLength = 0;                                     // Comprimento máximo do caminho encontrado
-
-    // Inicializa o array de visitados
-    for (int i = 0; i < graph->numUsers; i++) {
-        visited[i] = 0;
+// Função para gravar o grafo com os caminhos destacados
+// graph: Ponteiro para o grafo
+// paths: Caminhos calculados por findPathsBetweenUsers
+// args: Opções de exportação
+// Retorna false se o arquivo não pôde ser gravado
+bool writeExport(Graph* graph, PathResult paths[3], CommandArguments* args) {
+    int fd = open(args->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
     }
 
-    // Chama DFS para encontrar o caminho mais longo entre os dois vértices
-    dfsFindLongestPath_2(graph, startVertex, visited, currentPath, 0, &maxPathLength, bestPath, finalVertex);
-
-    // Imprime o caminho mais longo encontrado
-    if (maxPathLength > 0) {
-        printf("\nCaminho mais longo :\n");
-        for (int i = 0; i < maxPathLength; i++) {
-            printf("%s", graph->users[bestPath[i]]->nome);
-            if (i < maxPathLength - 1) {
-                printf(" -> ");
-            }
-        }
-        printf("\nDistancia: %d\n", maxPathLength - 1);
-    } else {
-        printf("\nNao ha caminhos no grafo.\n");
+    // Cores do README: menor caminho em azul, maior entre os dois usuários em verde, maior do grafo em vermelho
+    ExportHighlight highlights[3] = {
+        {&paths[0], "blue", "o caminho mais curto"},
+        {&paths[1], "green", "o caminho mais longo entre dois pontos"},
+        {&paths[2], "red", "o caminho mais longo do grafo"}
+    };
+    args->options.highlights = highlights;
+    args->options.numHighlights = 3;
+
+    // Vizinhança de k saltos (9-etapa) no lugar do grafo inteiro
+    KHopResult ego;
+    bool hasEgo = args->egoUser >= 0;
+    if (hasEgo) {
+        BFSScratch* scratch = createBFSScratch(graph->numUsers);
+        kHopNeighborhood(graph, scratch, args->egoUser, args->egoHops, graph->numUsers, false, &ego);
+        freeBFSScratch(scratch);
+        args->options.members = ego.members;
+        args->options.numMembers = ego.count;
     }
 
-    // Libera a memória alocada
-    free(visited);
-    free(currentPath);
-    free(bestPath);
-}
+    OutputBuffer* file = createOutputBuffer(fd, OUTPUT_BUFFER_SIZE);
+    exportGraph(file, graph, &args->options);
+    bool ok = freeOutputBuffer(file);
+    ok = close(fd) == 0 && ok;
 
-// Função que sorteia dois usuários e calcula o menor e o maior caminho entre eles
-void findPathsBetweenUsers(Graph* graph) {
-    srand(time(NULL));  // Inicializa a semente para números aleatórios
-
-    int startVertex = rand() % graph->numUsers;  // Sorteia o vértice inicial
-    int finalVertex;
-    do {
-        finalVertex = rand() % graph->numUsers;  // Sorteia o vértice final diferente do inicial
-    } while (finalVertex == startVertex);
-
-    printf("\nUsuario inicial: %s\n", graph->users[startVertex]->nome);
-    printf("Usuario final: %s\n", graph->users[finalVertex]->nome);
-
-    // Calcula e imprime o menor caminho entre os usuários sorteados
-    bfsFindShortestPath(graph, startVertex, finalVertex);
-
-    findLongestPath_2(graph, startVertex, finalVertex);
-
-    // Calcula e imprime o maior caminho encontrado no grafo
-    findLongestPath(graph);
+    if (hasEgo) {
+        freeKHopResult(&ego);
+    }
+    return ok;
 }
 
-/*
-Funcoes Auxiliares:
-
-1. `printGraph`
-    - Objetivo:
-      - Imprimir a representação do grafo na tela.
-    - Descrição:
-      - Esta função itera sobre todos os vértices do grafo e imprime o nome e o ID de cada usuário.
-        Para cada usuário, a função também imprime as conexões (arestas) com outros usuários.
-        Se um usuário não tiver conexões, a função imprime "(nenhuma conexão)".
-        A função usa uma flag (`firstConnection`) para adicionar vírgulas entre as conexões, exceto antes da primeira conexão.
-
-2. `freeGraph`
-    - Objetivo:
-      - Liberar toda a memória alocada para o grafo.
-    - Descrição:
-      - Esta função percorre a lista de adjacências de cada usuário e libera a memória associada a essas listas.
-        Depois, libera a memória da lista de adjacências e dos próprios usuários.
-        Por fim, a função libera a memória alocada para a estrutura do grafo em si.
-        A função é importante para evitar vazamentos de memória ao desalocar todos os recursos utilizados pelo grafo.
-*/
-
-
-// Função para imprimir o grafo
-// graph: Ponteiro para o grafo
-void printGraph(Graph* graph) {
-    for (int i = 0; i < graph->numUsers; i++) {
-        printf("%s (%d): ", graph->users[i]->nome, graph->users[i]->id);
-        AdjacencyNode* temp = graph->adjList[i];
-
-        // Se a lista de adjacências estiver vazia, apenas imprima "(nenhuma conexão)"
-        if (temp == NULL) {
-            printf("(nenhuma conexao)");
+// Função para tratar os argumentos do modo servidor
+// Uso: --server [--socket caminho] [--snapshot arquivo] [--log arquivo] [--threads n]
+// names, numUsers: Usuários do grafo de exemplo, usado quando nenhum snapshot é informado
+// Retorna o código de saída do programa
+int serverMain(int argc, char* argv[], char* names[], int numUsers) {
+    const char* socketPath = NULL;
+    const char* snapshotPath = NULL;
+    const char* logPath = NULL;
+    int numWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--socket") == 0) {
+            socketPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--snapshot") == 0) {
+            snapshotPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--log") == 0) {
+            logPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            numWorkers = atoi(argv[++i]);
         } else {
-            int firstConnection = 1;  // Flag para a primeira conexão
-            while (temp) {
-                if (!firstConnection) {
-                    printf(", ");  // Adiciona uma vírgula entre as conexões
-                }
-                printf("%s", temp->user->nome);
-                firstConnection = 0;
-                temp = temp->next;
-            }
+            fprintf(stderr, "Uso: %s --server [--socket caminho] [--snapshot arquivo] [--log arquivo] [--threads n]\n", argv[0]);
+            return 1;
         }
-        printf("\n");
     }
-}
 
-// Função para liberar a memória alocada para o grafo
-// graph: Ponteiro para o grafo
-void freeGraph(Graph* graph) {
-    for (int i = 0; i < graph->numUsers; i++) {
-        AdjacencyNode* temp = graph->adjList[i];
-        while (temp) {
-            AdjacencyNode* toDelete = temp;
-            temp = temp->next;
-            free(toDelete);
+    Graph* graph;
+    if (snapshotPath || logPath) {
+        CSRGraph* csr = recoverCSR(snapshotPath ? snapshotPath : "", logPath ? logPath : "", 0);
+        if (!csr || csr->numUsers == 0) {
+            fprintf(stderr, "Nao foi possivel carregar o grafo\n");
+            freeCSR(csr);
+            return 1;
         }
+        graph = createGraphFromCSR(csr);
+    } else {
+        graph = createGraph(numUsers, names);
+        generateRandomConnections(graph, 20);
     }
-    free(graph->adjList);
 
-    // Libera a memória alocada para os usuários
-    for (int i = 0; i < graph->numUsers; i++) {
-        free(graph->users[i]);
+    QueryServer* server = createQueryServer(graph, numWorkers, SERVER_TREE_CACHE_BYTES);
+    int status = 0;
+    if (socketPath) {
+        int listener = listenSocketServer(socketPath);
+        if (listener < 0) {
+            fprintf(stderr, "Nao foi possivel escutar em %s\n", socketPath);
+            status = 1;
+        } else {
+            fprintf(stderr, "Servidor escutando em %s\n", socketPath);
+            runSocketServer(server, listener, socketPath);
+            status = 1;  // O servidor só para em caso de erro
+        }
+    } else {
+        serveConnection(server, STDIN_FILENO, STDOUT_FILENO);
     }
-    free(graph->users);
 
-    free(graph);
+    freeQueryServer(server);
+    freeGraph(graph);
+    return status;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     char* names[] = {
         "Andrew", "Carlos", "Damaira", "David", "Evaldo",
         "Helena", "Hyan", "Jefte", "Jonatan", "Jose",
@@ -616,22 +300,81 @@ int main() {
 
     // numUsers = 160 / 8 = 20
     int numUsers = sizeof(names) / sizeof(names[0]);
+
+#ifdef ED_INSTRUMENTATION
+    atexit(instrumentationReportAtExit);
+#endif
+
+    // Modo servidor: consultas pela entrada padrão ou por um socket Unix (20-etapa)
+    if (argc > 1 && strcmp(argv[1], "--server") == 0) {
+        return serverMain(argc, argv, names, numUsers);
+    }
+
+    CommandArguments args;
+    if (!parseArguments(argc, argv, &args, numUsers)) {
+        fprintf(stderr, "Uso: %s [--export arquivo] [--format dot|graphml] [--ego usuario saltos] [--sample fracao] "
+                        "[--min-degree d] [--max-degree d] [--partitions n]\n", argv[0]);
+        return 1;
+    }
+
+    INSTRUMENT_BEGIN(buildTimer);
     Graph* graph = createGraph(numUsers, names);
 
     // Gerar conexões aleatórias
     generateRandomConnections(graph, 20);
+    INSTRUMENT_END(PHASE_MAIN_BUILD, buildTimer);
+
+    // BFS distribuída: os processos das partições são criados antes de qualquer saída
+    PartitionedGraph* partitioned = NULL;
+    if (args.partitions > 0) {
+        partitioned = createPartitionedGraph(graph, args.partitions, NULL, NULL);
+        if (!partitioned) {
+            fprintf(stderr, "Nao foi possivel criar os processos das particoes\n");
+            freeGraph(graph);
+            return 1;
+        }
+    }
+
+    // Mensagens já impressas com printf saem antes da saída com buffer
+    fflush(stdout);
+    OutputBuffer* out = createOutputBuffer(STDOUT_FILENO, OUTPUT_BUFFER_SIZE);
 
     // Imprime o grafo
-    printGraph(graph);
+    INSTRUMENT_BEGIN(printTimer);
+    printGraph(out, graph);
 
     // Contar e verificar o número de conexões
     int connectionCount = countConnections(graph);
-    printf("\nNumero total de conexoes no grafo: %d\n", connectionCount);
+    outputString(out, "\nNumero total de conexoes no grafo: ");
+    outputInt(out, connectionCount);
+    outputChar(out, '\n');
+    INSTRUMENT_END(PHASE_MAIN_PRINT, printTimer);
 
     // Chama a busca
-    findPathsBetweenUsers(graph);
+    PathResult paths[3];
+    for (int i = 0; i < 3; i++) {
+        paths[i].path = (int*)malloc(numUsers * sizeof(int));
+        if (!paths[i].path) exit(1);  // Verificação de alocação de memória
+        paths[i].capacity = numUsers;
+    }
+    INSTRUMENT_BEGIN(queriesTimer);
+    findPathsBetweenUsers(out, graph, partitioned, paths);
+    outputFlush(out);
+    INSTRUMENT_END(PHASE_MAIN_QUERIES, queriesTimer);
+    freeOutputBuffer(out);
+    freePartitionedGraph(partitioned);
+
+    // Exporta o grafo com os caminhos destacados
+    int status = 0;
+    if (args.path && !writeExport(graph, paths, &args)) {
+        fprintf(stderr, "Nao foi possivel gravar %s\n", args.path);
+        status = 1;
+    }
+    for (int i = 0; i < 3; i++) {
+        free(paths[i].path);
+    }
 
     // Libera a memória alocada para o grafo
     freeGraph(graph);
-    return 0;
+    return status;
 }
@@ -0,0 +1,7966 @@
+#include "redesocial.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <math.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <stdarg.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+Instrumentação (opção de compilação ED_INSTRUMENTATION)
+
+Descrição:
+- Quando uma consulta é lenta, os contadores e cronômetros mostram se o tempo vai para a construção do grafo,
+  a fila, a varredura de vizinhos ou a reconstrução do caminho.
+- Com `-DED_INSTRUMENTATION=ON` no CMake, cada thread tem o seu bloco de contadores (sem disputa entre threads):
+  vértices retirados da fila, arestas varridas, nós expandidos pela DFS e alocações. Cada fase marcada com
+  `INSTRUMENT_BEGIN` / `INSTRUMENT_END` acumula o número de chamadas e o tempo total (relógio monotônico).
+- Os tipos e as macros ficam em `redesocial.h`; sem a opção, as macros não geram código.
+- O resumo é impresso em stderr ao final do programa e pode ser pedido no modo servidor com `STATS`.
+
+Funções:
+- `instrumentationReport`: Escreve a soma de todas as threads em tabela ou JSON.
+*/
+
+#ifdef ED_INSTRUMENTATION
+
+static const char* const counterNames[NUM_COUNTERS] = {
+    "vertices_dequeued", "edges_scanned", "dfs_expanded", "allocations"
+};
+static const char* const phaseNames[NUM_PHASES] = {
+    "main.build", "main.print", "main.queries", "bfs.search", "bfs.reconstruct",
+    "dfs.longest", "dfs.longest_2", "server.batch"
+};
+
+// Estrutura para representar os contadores de uma thread
+// Só a thread dona escreve; os campos são atômicos para que o relatório possa lê-los a qualquer momento.
+typedef struct ThreadInstruments {
+    atomic_ullong counters[NUM_COUNTERS];  // Contadores de eventos
+    atomic_ullong phaseCalls[NUM_PHASES];  // Chamadas de cada fase
+    atomic_ullong phaseNanos[NUM_PHASES];  // Tempo total de cada fase em nanossegundos
+    struct ThreadInstruments* next;  // Próximo bloco registrado
+} ThreadInstruments;
+
+static _Thread_local ThreadInstruments* threadInstruments = NULL;
+static ThreadInstruments* instrumentsList = NULL;  // Blocos de todas as threads (nunca liberados)
+static pthread_mutex_t instrumentsLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Retorna o bloco da thread atual, criando e registrando na primeira chamada
+static ThreadInstruments* instrumentsForThread() {
+    if (!threadInstruments) {
+        ThreadInstruments* block = (ThreadInstruments*)calloc(1, sizeof(ThreadInstruments));
+        if (!block) exit(1);  // Verificação de alocação de memória
+        pthread_mutex_lock(&instrumentsLock);
+        block->next = instrumentsList;
+        instrumentsList = block;
+        pthread_mutex_unlock(&instrumentsLock);
+        threadInstruments = block;
+    }
+    return threadInstruments;
+}
+
+// Soma sem instrução atômica de leitura-modificação-escrita (só a thread dona escreve)
+static inline void instrumentAdd(atomic_ullong* field, unsigned long long amount) {
+    atomic_store_explicit(field, atomic_load_explicit(field, memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+unsigned long long instrumentNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec;
+}
+
+void instrumentCount(InstrumentCounter counter, unsigned long long amount) {
+    instrumentAdd(&instrumentsForThread()->counters[counter], amount);
+}
+
+void instrumentPhase(InstrumentPhase phase, unsigned long long start) {
+    ThreadInstruments* block = instrumentsForThread();
+    instrumentAdd(&block->phaseCalls[phase], 1);
+    instrumentAdd(&block->phaseNanos[phase], instrumentNow() - start);
+}
+
+// Função para escrever o resumo da instrumentação (soma de todas as threads)
+// out: Arquivo de saída
+// json: true para uma linha JSON, false para uma tabela
+void instrumentationReport(FILE* out, bool json) {
+    unsigned long long counters[NUM_COUNTERS] = {0};
+    unsigned long long calls[NUM_PHASES] = {0};
+    unsigned long long nanos[NUM_PHASES] = {0};
+    int threads = 0;
+
+    pthread_mutex_lock(&instrumentsLock);
+    for (ThreadInstruments* block = instrumentsList; block; block = block->next) {
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            counters[c] += atomic_load_explicit(&block->counters[c], memory_order_relaxed);
+        }
+        for (int p = 0; p < NUM_PHASES; p++) {
+            calls[p] += atomic_load_explicit(&block->phaseCalls[p], memory_order_relaxed);
+            nanos[p] += atomic_load_explicit(&block->phaseNanos[p], memory_order_relaxed);
+        }
+        threads++;
+    }
+    pthread_mutex_unlock(&instrumentsLock);
+
+    if (json) {
+        fprintf(out, "{\"threads\": %d, \"counters\": {", threads);
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            fprintf(out, "%s\"%s\": %llu", c ? ", " : "", counterNames[c], counters[c]);
+        }
+        fprintf(out, "}, \"phases\": {");
+        for (int p = 0; p < NUM_PHASES; p++) {
+            fprintf(out, "%s\"%s\": {\"calls\": %llu, \"total_ms\": %.3f}", p ? ", " : "", phaseNames[p],
+                    calls[p], nanos[p] / 1e6);
+        }
+        fprintf(out, "}}");
+    } else {
+        fprintf(out, "\nInstrumentacao (%d threads)\n", threads);
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            fprintf(out, "  %-20s %15llu\n", counterNames[c], counters[c]);
+        }
+        fprintf(out, "  %-20s %15s %15s %15s\n", "fase", "chamadas", "total (ms)", "media (us)");
+        for (int p = 0; p < NUM_PHASES; p++) {
+            if (calls[p] > 0) {
+                fprintf(out, "  %-20s %15llu %15.3f %15.3f\n", phaseNames[p], calls[p], nanos[p] / 1e6,
+                        nanos[p] / 1e3 / calls[p]);
+            }
+        }
+    }
+}
+
+// Imprime a tabela em stderr ao final do programa (registrada com atexit)
+void instrumentationReportAtExit() {
+    instrumentationReport(stderr, false);
+}
+
+#endif
+
+/*
+1-tapa: Estrutura de Dados para o Grafo
+
+Descrição:
+- A rede social é representada por um grafo, onde cada usuário é um nó.
+- As conexões entre os usuários são representadas por arestas.
+- Utiliza-se uma lista de adjacências para representar as conexões entre os usuários.
+- Cada usuário é identificado por um ID único e um nome.
+
+Estruturas:
+- `User`: Representa um usuário com um ID único e um nome.
+- `AdjacencyNode`: Representa um nó na lista de adjacência que aponta para um usuário conectado.
+- `Graph`: Representa o grafo, contendo um array de usuários e um array de listas de adjacência.
+- `Queue`: Representa uma fila usada para algoritmos de busca.
+- `CSRGraph`: Cópia compacta das listas de adjacência, com os vizinhos ordenados em um único array.
+
+Funções:
+- `createNode`: Cria um novo nó na lista de adjacências.
+- `createGraph`: Cria um grafo com um número fixo de usuários.
+- `createNumberedGraph`: Cria um grafo com usuários nomeados pelo ID (grafos grandes e benchmarks).
+- `addConnection`: Adiciona uma conexão entre dois usuários no grafo.
+*/
+
+// Função para criar um novo nó na lista de adjacências
+// user: Ponteiro para o usuário que será adicionado ao nó
+AdjacencyNode* createNode(User* user) {
+    AdjacencyNode* newNode = (AdjacencyNode*) malloc(sizeof(AdjacencyNode));
+    if (!newNode) exit(1);  // Verificação de alocação de memória
+    INSTRUMENT_COUNT(COUNTER_ALLOCATIONS, 1);
+    newNode->user = user;
+    newNode->weight = 1;
+    newNode->next = NULL;
+    return newNode;
+
+}
+
+void graphChanged(Graph* graph, int src, int dest, bool added);
+static void bfsScratchReset(BFSScratch* scratch);
+
+// Função para criar um grafo com um número fixo de usuários
+// numUsers: Número total de usuários (nós)
+// names: Array de nomes dos usuários
+Graph* createGraph(int numUsers, char* names[]) {
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    if (!graph) exit(1);  // Verificação de alocação de memória
+    graph->numUsers = numUsers;
+
+    graph->users = (User**)malloc(numUsers * sizeof(User*));
+    for (int i = 0; i < numUsers; i++) {
+        graph->users[i] = (User*)malloc(sizeof(User));
+        graph->users[i]->id = i;
+        strncpy(graph->users[i]->nome, names[i], MAX_NAME_LENGTH);
+    }
+
+    graph->adjList = (AdjacencyNode**)malloc(numUsers * sizeof(AdjacencyNode*));
+    graph->visited = (int*)malloc(numUsers * sizeof(int));
+    graph->degree = (int*)malloc(numUsers * sizeof(int));
+
+    for (int i = 0; i < numUsers; i++) {
+        graph->adjList[i] = NULL;
+        graph->visited[i] = 0;
+        graph->degree[i] = 0;
+    }
+    graph->csr = NULL;
+    graph->directed = false;
+    graph->inList = NULL;
+    graph->inDegree = NULL;
+    graph->reverseCSR = NULL;
+    graph->undirectedCSR = NULL;
+    graph->slack = NULL;
+    graph->pathCache = NULL;
+    graph->edgeLog = NULL;
+    graph->version = 0;
+    graph->weighted = false;
+
+    return graph;
+}
+
+// Função para criar um grafo sem conexões com usuários nomeados "U0", "U1", ...
+// numUsers: Número total de usuários (nós)
+Graph* createNumberedGraph(int numUsers) {
+    char** names = (char**)malloc((numUsers + 1) * sizeof(char*));
+    char* storage = (char*)malloc((size_t)(numUsers + 1) * 16);
+    if (!names || !storage) exit(1);  // Verificação de alocação de memória
+    for (int v = 0; v < numUsers; v++) {
+        names[v] = storage + (size_t)v * 16;
+        snprintf(names[v], 16, "U%d", v);  // createGraph copia até MAX_NAME_LENGTH caracteres
+    }
+    Graph* graph = createGraph(numUsers, names);
+    free(names);
+    free(storage);
+    return graph;
+}
+
+// Função para adicionar uma conexão (aresta) entre dois usuários
+// graph: Ponteiro para o grafo
+// src: ID do usuário de origem
+// dest: ID do usuário de destino
+void addConnection(Graph* graph, int src, int dest) {
+    if (graph->directed) {
+        // No modo de seguidores, uma conexão é um par de seguidas mútuas
+        addFollow(graph, src, dest);
+        addFollow(graph, dest, src);
+        return;
+    }
+
+    // Adiciona uma conexão de src para dest
+    AdjacencyNode* newNode = createNode(graph->users[dest]);
+    newNode->next = graph->adjList[src];
+    graph->adjList[src] = newNode;
+
+    // Como o grafo é não direcionado, adiciona também a conexão de dest para src
+    newNode = createNode(graph->users[src]);
+    newNode->next = graph->adjList[dest];
+    graph->adjList[dest] = newNode;
+
+    graph->degree[src]++;
+    graph->degree[dest]++;
+
+    // Atualiza as estruturas derivadas (CSR, CSR com folga e cache de caminhos)
+    graphChanged(graph, src, dest, true);
+}
+
+/*
+2-etapa: Gerar Conexões Aleatórias
+
+Descrição:
+- Conectar aleatoriamente os usuários para simular as interações em uma rede social.
+- Cada conexão entre dois usuários é representada por uma aresta no grafo.
+- A geração das conexões será feita de forma aleatória, respeitando as restrições de não haver auto-conexões e não duplicar conexões.
+
+Funções:
+- `connectionExists`: Verifica se uma conexão entre dois usuários já existe.
+- `generateRandomConnections`: Gera e adiciona conexões aleatórias entre os usuários no grafo.
+- `generateUniformConnections`: Igual à anterior, mas com semente fixa (resultados reproduzíveis).
+- `generatePreferentialConnections`: Gera conexões por ligação preferencial (modelo de Barabási-Albert), com
+  poucos usuários muito conectados, como em redes sociais reais.
+- `countConnections`: Conta o número total de conexões (arestas) presentes no grafo.
+*/
+
+// Função para verificar se uma conexão entre dois usuários já existe
+// graph: Ponteiro para o grafo
+// src: ID do usuário de origem
+// dest: ID do usuário de destino
+// Retorna true se a conexão já existir, caso contrário, retorna false
+bool connectionExists(Graph* graph, int src, int dest) {
+    AdjacencyNode* temp = graph->adjList[src];
+    while (temp) {
+        if (temp->user->id == dest) {
+            return true;  // A conexão já existe
+        }
+        temp = temp->next;
+    }
+    return false;  // A conexão não existe
+}
+
+// Função para gerar conexões aleatórias entre os usuários
+// graph: Ponteiro para o grafo
+// numConnections: Número desejado de conexões a serem adicionadas
+void generateRandomConnections(Graph* graph, int numConnections) {
+    // Inicializa o gerador de números aleatórios com a semente baseada no tempo atual
+    generateUniformConnections(graph, numConnections, (unsigned int)time(0));
+}
+
+// Função para gerar conexões aleatórias com uma semente fixa
+// graph: Ponteiro para o grafo
+// numConnections: Número desejado de conexões a serem adicionadas
+// seed: Semente do gerador de números aleatórios
+void generateUniformConnections(Graph* graph, int numConnections, unsigned int seed) {
+    // Verifica se o número solicitado de conexões excede o número máximo possível
+    if (numConnections > (long long)graph->numUsers * (graph->numUsers - 1) / 2) {
+        printf("Numero de conexoes solicitado e maior do que o maximo possivel.\n");
+        return;  // Se o número solicitado for maior, exibe uma mensagem de erro e retorna
+    }
+
+    srand(seed);
+
+    int connectionsAdded = 0;  // Contador para acompanhar o número de conexões adicionadas
+
+    // Continua tentando adicionar conexões até que o número desejado de conexões seja alcançado
+    while (connectionsAdded < numConnections) {
+        int src = rand() % graph->numUsers;  // Seleciona aleatoriamente um usuário de origem
+        int dest = rand() % graph->numUsers;  // Seleciona aleatoriamente um usuário de destino
+
+        // Verifica se a conexão não é uma auto-conexão e se a conexão ainda não existe
+        if (src != dest && !connectionExists(graph, src, dest)) {
+            addConnection(graph, src, dest);  // Adiciona a conexão ao grafo
+            connectionsAdded++;  // Incrementa o contador de conexões adicionadas
+        }
+    }
+}
+
+// Função para gerar conexões por ligação preferencial (Barabási-Albert)
+// graph: Ponteiro para o grafo
+// connectionsPerUser: Conexões criadas por cada usuário novo (os primeiros formam um grupo completo)
+// seed: Semente do gerador de números aleatórios
+void generatePreferentialConnections(Graph* graph, int connectionsPerUser, unsigned int seed) {
+    int n = graph->numUsers;
+    int m = connectionsPerUser < n - 1 ? connectionsPerUser : n - 1;
+    if (m < 1) {
+        return;
+    }
+
+    // Cada conexão coloca as duas pontas em endpoints; sortear uma posição escolhe um usuário
+    // com probabilidade proporcional ao seu grau
+    long long capacity = 2 * ((long long)m * (m + 1) / 2 + (long long)(n - m - 1) * m);
+    int* endpoints = (int*)malloc((capacity + 1) * sizeof(int));
+    if (!endpoints) exit(1);  // Verificação de alocação de memória
+    long long count = 0;
+
+    // Grupo inicial completo com m + 1 usuários
+    for (int v = 0; v <= m; v++) {
+        for (int u = 0; u < v; u++) {
+            addConnection(graph, v, u);
+            endpoints[count++] = v;
+            endpoints[count++] = u;
+        }
+    }
+
+    srand(seed);
+    for (int v = m + 1; v < n; v++) {
+        long long available = count;  // Só os usuários anteriores podem ser sorteados
+        int added = 0;
+        while (added < m) {
+            long long r = ((long long)rand() * ((long long)RAND_MAX + 1) + rand()) % available;
+            int u = endpoints[r];
+            if (!connectionExists(graph, v, u)) {
+                addConnection(graph, v, u);
+                endpoints[count++] = v;
+                endpoints[count++] = u;
+                added++;
+            }
+        }
+    }
+
+    free(endpoints);
+}
+
+// Função para contar o número total de conexões (arestas) no grafo
+// graph: Ponteiro para o grafo
+int countConnections(Graph* graph) {
+    int count = 0;  // Inicializa o contador de conexões
+
+    // Itera sobre todos os usuários no grafo
+    for (int i = 0; i < graph->numUsers; i++) {
+        AdjacencyNode* temp = graph->adjList[i];  // Pega a lista de adjacências para o usuário i
+
+        // Itera sobre todos os nós adjacentes ao usuário i
+        while (temp) {
+            count++;  // Incrementa o contador de conexões para cada nó adjacente
+            temp = temp->next;  // Move para o próximo nó na lista de adjacências
+        }
+    }
+
+    // Como cada conexão é contada duas vezes (uma para cada direção em um grafo não direcionado),
+    // dividimos o total de contagens por 2 para obter o número real de conexões
+    // (em um grafo direcionado, cada seguida aparece só na lista de quem segue)
+    return graph->directed ? count : count / 2;
+}
+
+/*
+3-tapa: Implementar a Busca em Largura (BFS) para encontrar o menor caminho
+
+Descrição:
+- A função `shortestPath` utiliza a BFS para explorar o grafo, partindo de um usuário inicial (startVertex) e procurando o caminho mais curto até o usuário final (finalVertex).
+- Durante o processo, a BFS mantém rastros de predecessores e distâncias para reconstruir o caminho ao encontrar o destino.
+- O uso de uma fila (queue) é essencial para gerenciar a exploração em camadas de proximidade.
+
+Funções de Suporte:
+- `createQueue`: Inicializa e retorna uma nova fila.
+- `isEmpty`: Verifica se a fila está vazia.
+- `enqueue`: Adiciona um elemento na fila.
+- `dequeue`: Remove e retorna um elemento da fila.
+- `freeQueue`: Libera a memória alocada para a fila.
+
+Função Principal:
+- `shortestPath`: Executa a BFS e preenche um `PathResult` com o menor caminho entre dois usuários, sem
+  imprimir e sem alocar memória (a fila e os predecessores ficam em um `BFSScratch` reutilizável).
+- `bfsFindShortestPath` (main.c): Versão da linha de comando, que imprime o caminho.
+*/
+
+// Função para inicializar a fila
+// capacity: Número máximo de itens (na BFS cada usuário entra na fila uma vez só)
+Queue* createQueue(int capacity) {
+    Queue* queue = (Queue*) malloc(sizeof(Queue));
+    if (!queue) exit(1);  // Verificação de alocação de memória
+    queue->items = (int*) malloc(capacity * sizeof(int));
+    if (!queue->items) exit(1);
+    INSTRUMENT_COUNT(COUNTER_ALLOCATIONS, 2);
+    queue->capacity = capacity;
+    queue->front = -1;
+    queue->rear = -1;
+    return queue;
+}
+
+// Verifica se a fila está vazia
+int isEmpty(Queue* queue) {
+    if (queue->rear == -1)
+        return 1;
+    return 0;
+}
+
+// Função para adicionar um elemento na fila
+int enqueue(Queue* queue, int value) {
+    if (queue->rear == queue->capacity - 1) {
+        // Fila cheia
+        return 0;  // Retorna 0 para indicar falha
+    } else {
+        if (queue->front == -1) {
+            queue->front = 0;
+        }
+        queue->rear++;
+        queue->items[queue->rear] = value;
+        return 1;  // Retorna 1 para indicar sucesso
+    }
+}
+
+// Função para remover um elemento da fila
+int dequeue(Queue* queue) {
+    if (isEmpty(queue)) {
+        // Fila vazia
+        return -1;  // Retorna um valor especial para indicar que a fila está vazia
+    } else {
+        int item = queue->items[queue->front];
+        queue->front++;
+        if (queue->front > queue->rear) {
+            // Reinicializa a fila quando todos os elementos são removidos
+            queue->front = -1;
+            queue->rear = -1;
+        }
+        return item;
+    }
+}
+
+// Função para liberar a memória alocada para a fila
+void freeQueue(Queue* queue) {
+    if (queue != NULL) {
+        free(queue->items);  // Libera o array de itens
+        free(queue);  // Libera a memória alocada para a estrutura Queue
+        queue = NULL; // Define o ponteiro como NULL para evitar referências pendentes
+    }
+}
+
+
+// Função para encontrar o menor caminho entre dois usuários usando BFS
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável
+// startVertex: ID do usuário de origem
+// finalVertex: ID do usuário de destino
+// result: Resultado; path é o buffer do chamador com capacity posições
+// Retorna true se o caminho existe e coube em result->path (result->distance é -1 se não há caminho)
+bool shortestPath(Graph* graph, BFSScratch* scratch, int startVertex, int finalVertex, PathResult* result) {
+    INSTRUMENT_BEGIN(searchTimer);
+    bfsScratchReset(scratch);
+    int visitedStamp = scratch->currentStamp;
+    scratch->stamp[startVertex] = visitedStamp;
+    scratch->distance[startVertex] = 0;
+    scratch->predecessor[startVertex] = -1;
+    scratch->queue[0] = startVertex;
+    int head = 0;
+    int tail = 1;
+    int found = startVertex == finalVertex ? 0 : -1;
+
+    // Percorre as listas de adjacências na mesma ordem da versão original
+    while (head < tail && found == -1) {
+        int currentVertex = scratch->queue[head++];
+        INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, 1);
+
+        for (AdjacencyNode* temp = graph->adjList[currentVertex]; temp != NULL; temp = temp->next) {
+            int adjVertex = temp->user->id;
+            INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, 1);
+
+            if (scratch->stamp[adjVertex] != visitedStamp) {
+                scratch->stamp[adjVertex] = visitedStamp;
+                scratch->distance[adjVertex] = scratch->distance[currentVertex] + 1;
+                scratch->predecessor[adjVertex] = currentVertex;
+                scratch->queue[tail++] = adjVertex;
+                if (adjVertex == finalVertex) {
+                    found = scratch->distance[adjVertex];
+                    break;
+                }
+            }
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+
+    result->distance = found;
+    result->length = found + 1;
+    if (found < 0 || result->length > result->capacity) {
+        return false;
+    }
+
+    // Reconstrói o caminho a partir dos predecessores
+    INSTRUMENT_BEGIN(reconstructTimer);
+    int crawl = finalVertex;
+    for (int i = found; i >= 0; i--) {
+        result->path[i] = crawl;
+        crawl = scratch->predecessor[crawl];
+    }
+    INSTRUMENT_END(PHASE_BFS_RECONSTRUCT, reconstructTimer);
+    return true;
+}
+
+/*
+4ª Etapa: Encontrar o Maior Caminho go grafo
+
+Descrição:
+- Implementação de funções que utilizam DFS (Busca em Profundidade) para encontrar o maior caminho possível  do grafo.
+- As funções fornecem a capacidade de explorar o grafo para encontrar caminhos e avaliar a conectividade entre usuários.
+
+Funções:
+
+1. `dfsFindLongestPath`
+   - Objetivo: Encontrar o caminho mais longo possível no grafo a partir de um vértice inicial.
+   - Parâmetros:
+     - `graph`: Ponteiro para o grafo.
+     - `currentVertex`: Vértice atual sendo explorado.
+     - `visited`: Array para marcar os vértices já visitados.
+     - `currentPath`: Array que armazena o caminho atual.
+     - `pathIndex`: Índice atual do caminho.
+     - `maxPathLength`: Comprimento máximo do caminho encontrado até agora.
+     - `endVertex`: Vértice final do caminho mais longo encontrado.
+     - `bestPath`: Array que armazena o melhor caminho (o mais longo) encontrado.
+   - Descrição: Explora todos os vértices adjacentes, atualiza o caminho mais longo encontrado e permite a reconstrução do caminho mais longo possível.
+
+2. `longestPath`
+   - Objetivo: Encontrar o caminho mais longo do grafo e preenchê-lo em um `PathResult`, sem imprimir.
+   - Descrição: Itera sobre todos os vértices do grafo, utilizando a função `dfsFindLongestPath` para encontrar o caminho mais longo a partir de cada vértice.
+     As marcações e o caminho atual usam os arrays de um `BFSScratch`, sem alocar memória.
+
+3. `findLongestPath` e `findPathsBetweenUsers` (main.c)
+   - Objetivo: Versões da linha de comando, que imprimem o caminho mais longo e sorteiam dois usuários para calcular o menor e o maior caminho entre eles.
+
+*/
+
+// Função auxiliar para DFS que encontra o caminho mais longo
+void dfsFindLongestPath(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* endVertex, int* bestPath) {
+    INSTRUMENT_COUNT(COUNTER_DFS_EXPANDED, 1);
+    visited[currentVertex] = 1;  // Marca o vértice atual como visitado
+    currentPath[pathIndex] = currentVertex;  // Adiciona o vértice ao caminho atual
+    pathIndex++;
+
+    AdjacencyNode* temp = graph->adjList[currentVertex];
+    int hasNeighbor = 0;
+
+    // Explora todos os vértices adjacentes
+    while (temp != NULL) {
+        int adjVertex = temp->user->id;
+        if (!visited[adjVertex]) {
+            hasNeighbor = 1;
+            dfsFindLongestPath(graph, adjVertex, visited, currentPath, pathIndex, maxPathLength, endVertex, bestPath);
+        }
+        temp = temp->next;
+    }
+
+    // Se não houver mais vizinhos para explorar
+    if (!hasNeighbor) {
+        // Se o caminho atual for o mais longo encontrado, atualiza o melhor caminho
+        if (pathIndex > *maxPathLength) {
+            *maxPathLength = pathIndex;
+            *endVertex = currentVertex;
+            for (int i = 0; i < pathIndex; i++) {
+                bestPath[i] = currentPath[i];
+            }
+        }
+    }
+
+    pathIndex--;
+    visited[currentVertex] = 0;  // Desmarca o vértice atual para futuras explorações
+}
+
+
+// Função para encontrar o caminho mais longo do grafo usando DFS
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável (os arrays predecessor e queue servem de área de trabalho da DFS)
+// result: Resultado; path é o buffer do chamador e precisa de capacity >= numUsers
+// Retorna true se algum caminho foi encontrado
+bool longestPath(Graph* graph, BFSScratch* scratch, PathResult* result) {
+    INSTRUMENT_BEGIN(dfsTimer);
+    int* visited = scratch->predecessor;  // Array de visitados
+    int* currentPath = scratch->queue;  // Array para o caminho atual
+    int maxPathLength = 0;  // Comprimento máximo do caminho encontrado
+    int endVertex = -1;  // Vértice final do caminho mais longo
+    result->distance = -1;
+    result->length = 0;
+    if (result->capacity < graph->numUsers) {
+        return false;  // O tamanho do melhor caminho só é conhecido no final
+    }
+
+    // Inicializa o array de visitados
+    for (int i = 0; i < graph->numUsers; i++) {
+        visited[i] = 0;
+    }
+
+    // Chama DFS para encontrar o caminho mais longo a partir de cada vértice
+    for (int i = 0; i < graph->numUsers; i++) {
+        if (!visited[i]) {
+            dfsFindLongestPath(graph, i, visited, currentPath, 0, &maxPathLength, &endVertex, result->path);
+        }
+    }
+    INSTRUMENT_END(PHASE_DFS_LONGEST, dfsTimer);
+
+    if (endVertex == -1) {
+        return false;
+    }
+    result->length = maxPathLength;
+    result->distance = maxPathLength - 1;
+    return true;
+}
+
+/*
+5-etapa : Implementa DFS para descobrir o caminho mais longo entre dois pontos.
+
+(Correção das funcionalidades...)
+
+Descrição: as demais funcões da 4-etapa implementam a busca do maior caminho do grafo, uma vez que o requisito era:
+"Encontrar o caminho mais longo entre dois pontos". Diante disso foi necessario uma pequena modificação na função:
+´findLongestPath´, adicionando novos parametros para a a funcao modificada ´findLongestPath_2´, assim sendo possivel
+encontrar o maior caminho entre os dois pontos.
+
+`longestPathBetween` preenche o caminho em um `PathResult`, sem imprimir; `findLongestPath_2` (main.c) imprime o resultado.
+
+*/
+
+void dfsFindLongestPath_2(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* bestPath, int finalVertex) {
+    INSTRUMENT_COUNT(COUNTER_DFS_EXPANDED, 1);
+    visited[currentVertex] = 1;  // Marca o vértice atual como visitado
+    currentPath[pathIndex] = currentVertex;  // Adiciona o vértice ao caminho atual
+    pathIndex++;
+
+    // Se o vértice final for alcançado, verifica se o caminho atual é o mais longo
+    if (currentVertex == finalVertex) {
+        if (pathIndex > *maxPathLength) {
+            *maxPathLength = pathIndex;
+            for (int i = 0; i < pathIndex; i++) {
+                bestPath[i] = currentPath[i];
+            }
+        }
+    } else {
+        // Explora todos os vértices adjacentes
+        AdjacencyNode* temp = graph->adjList[currentVertex];
+        while (temp != NULL) {
+            int adjVertex = temp->user->id;
+            if (!visited[adjVertex]) {
+                dfsFindLongestPath_2(graph, adjVertex, visited, currentPath, pathIndex, maxPathLength, bestPath, finalVertex);
+            }
+            temp = temp->next;
+        }
+    }
+
+    visited[currentVertex] = 0;  // Desmarca o vértice atual para futuras explorações
+    pathIndex--;
+}
+
+// Função para encontrar o caminho mais longo entre dois usuários usando DFS
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável (os arrays predecessor e queue servem de área de trabalho da DFS)
+// startVertex: ID do usuário de origem
+// finalVertex: ID do usuário de destino
+// result: Resultado; path é o buffer do chamador e precisa de capacity >= numUsers
+// Retorna true se existe caminho entre os dois usuários
+bool longestPathBetween(Graph* graph, BFSScratch* scratch, int startVertex, int finalVertex, PathResult* result) {
+    INSTRUMENT_BEGIN(dfsTimer);
+    int* visited = scratch->predecessor;  // Array de visitados
+    int* currentPath = scratch->queue;  // Array para o caminho atual
+    int maxPathLength = 0;  // Comprimento máximo do caminho encontrado
+    result->distance = -1;
+    result->length = 0;
+    if (result->capacity < graph->numUsers) {
+        return false;  // O tamanho do melhor caminho só é conhecido no final
+    }
+
+    // Inicializa o array de visitados
+    for (int i = 0; i < graph->numUsers; i++) {
+        visited[i] = 0;
+    }
+
+    // Chama DFS para encontrar o caminho mais longo entre os dois vértices
+    dfsFindLongestPath_2(graph, startVertex, visited, currentPath, 0, &maxPathLength, result->path, finalVertex);
+    INSTRUMENT_END(PHASE_DFS_LONGEST_2, dfsTimer);
+
+    if (maxPathLength == 0) {
+        return false;
+    }
+    result->length = maxPathLength;
+    result->distance = maxPathLength - 1;
+    return true;
+}
+
+/*
+6-etapa: Amigos em comum
+
+Descrição:
+- Consulta dos amigos em comum entre dois usuários, a chamada mais frequente depois do menor caminho.
+- As listas encadeadas são copiadas para o formato CSR, com os vizinhos de cada usuário ordenados por ID.
+  O grafo guarda esse CSR em cache e o descarta quando uma conexão é adicionada ou removida.
+- A interseção das duas listas ordenadas é adaptativa:
+  - Listas de tamanhos parecidos usam merge. Com SSE2 disponível, o merge compara blocos 4x4 de uma vez.
+  - Listas muito desbalanceadas (ex.: um usuário "celebridade" com milhões de vizinhos) usam busca
+    galopante: cada vizinho da lista menor é procurado na maior com passos exponenciais e busca binária,
+    com custo O(m log(n/m)) em vez de O(m + n).
+
+Funções:
+- `buildCSR`: Constrói o CSR a partir das listas de adjacência.
+- `getCSR`: Retorna o CSR em cache do grafo, construindo-o se necessário.
+- `freeCSR`: Libera a memória do CSR.
+- `intersectSorted`: Interseção adaptativa de duas listas ordenadas.
+- `mutualFriends`: Preenche os IDs dos amigos em comum entre dois usuários.
+- `countMutualFriends`: Conta os amigos em comum sem gerar a lista.
+*/
+
+// Razão entre os tamanhos das listas a partir da qual a busca galopante supera o merge
+#define GALLOPING_RATIO 32
+
+// Função de comparação de inteiros para o qsort
+static int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Função de comparação de long long para o qsort
+static int compareLongLongs(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Copia as listas com os pesos: cada posição é ordenada como (vizinho << 32 | peso) e depois separada
+static void buildCSRWeights(AdjacencyNode** lists, CSRGraph* csr) {
+    csr->weights = (int*)malloc((csr->offsets[csr->numUsers] + 1) * sizeof(int));
+    long long* pairs = (long long*)malloc((csr->offsets[csr->numUsers] + 1) * sizeof(long long));
+    if (!csr->weights || !pairs) exit(1);  // Verificação de alocação de memória
+    for (int i = 0; i < csr->numUsers; i++) {
+        int begin = csr->offsets[i];
+        int pos = begin;
+        for (AdjacencyNode* temp = lists[i]; temp; temp = temp->next) {
+            pairs[pos++] = ((long long)temp->user->id << 32) | (unsigned int)temp->weight;
+        }
+        qsort(pairs + begin, pos - begin, sizeof(long long), compareLongLongs);
+        for (int e = begin; e < pos; e++) {
+            csr->neighbors[e] = (int)(pairs[e] >> 32);
+            csr->weights[e] = (int)(pairs[e] & 0xffffffffll);
+        }
+    }
+    free(pairs);
+}
+
+// Copia listas de adjacência (de saída ou de entrada) para um CSR com os vizinhos ordenados
+static CSRGraph* buildCSRFromLists(int numUsers, AdjacencyNode** lists, const int* degree, bool weighted) {
+    CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+    if (!csr) exit(1);  // Verificação de alocação de memória
+    csr->numUsers = numUsers;
+    csr->offsets = (int*)malloc((numUsers + 1) * sizeof(int));
+    if (!csr->offsets) exit(1);
+
+    // Calcula o início de cada lista a partir dos graus
+    csr->offsets[0] = 0;
+    for (int i = 0; i < numUsers; i++) {
+        csr->offsets[i + 1] = csr->offsets[i] + degree[i];
+    }
+
+    // Copia e ordena cada lista
+    csr->neighbors = (int*)malloc((csr->offsets[numUsers] + 1) * sizeof(int));
+    if (!csr->neighbors) exit(1);
+    csr->weights = NULL;
+    if (weighted) {
+        buildCSRWeights(lists, csr);
+        return csr;
+    }
+    for (int i = 0; i < numUsers; i++) {
+        int pos = csr->offsets[i];
+        for (AdjacencyNode* temp = lists[i]; temp; temp = temp->next) {
+            csr->neighbors[pos++] = temp->user->id;
+        }
+        qsort(csr->neighbors + csr->offsets[i], csr->offsets[i + 1] - csr->offsets[i], sizeof(int), compareInts);
+    }
+
+    return csr;
+}
+
+// Função para construir o CSR com as listas de vizinhos ordenadas
+// Em um grafo direcionado, o CSR tem as conexões de saída (quem cada usuário segue).
+// graph: Ponteiro para o grafo
+CSRGraph* buildCSR(Graph* graph) {
+    return buildCSRFromLists(graph->numUsers, graph->adjList, graph->degree, graph->weighted);
+}
+
+// Função que retorna o CSR do grafo, reconstruindo-o se alguma conexão mudou
+// graph: Ponteiro para o grafo
+CSRGraph* getCSR(Graph* graph) {
+    if (!graph->csr) {
+        // O CSR com folga não guarda pesos: grafos com pesos são copiados das listas
+        graph->csr = graph->slack && !graph->weighted ? buildCSRFromSlack(graph->slack) : buildCSR(graph);
+    }
+    return graph->csr;
+}
+
+// Função para liberar a memória alocada para o CSR
+void freeCSR(CSRGraph* csr) {
+    if (csr != NULL) {
+        free(csr->offsets);
+        free(csr->neighbors);
+        free(csr->weights);
+        free(csr);
+    }
+}
+
+// Merge escalar de duas listas ordenadas
+// out: Array de saída (NULL para apenas contar)
+// Retorna o número de elementos em comum
+static int intersectMerge(const int* a, int na, const int* b, int nb, int* out) {
+    int i = 0, j = 0, count = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (a[i] > b[j]) {
+            j++;
+        } else {
+            if (out) out[count] = a[i];
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+
+#if defined(__SSE2__)
+// Merge vetorizado: compara um bloco de 4 elementos de `a` com as 4 rotações de um bloco de `b`
+// e avança o bloco cujo maior elemento é menor. O restante é resolvido pelo merge escalar.
+static int intersectMergeSSE(const int* a, int na, const int* b, int nb, int* out) {
+    int i = 0, j = 0, count = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i eq0 = _mm_cmpeq_epi32(va, vb);
+        __m128i eq1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+        __m128i eq2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+        __m128i eq3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(eq0, eq1), _mm_or_si128(eq2, eq3))));
+
+        // Cada bit da máscara indica um elemento do bloco de `a` presente no bloco de `b`
+        while (mask) {
+            int k = __builtin_ctz(mask);
+            if (out) out[count] = a[i + k];
+            count++;
+            mask &= mask - 1;
+        }
+
+        int maxA = a[i + 3];
+        int maxB = b[j + 3];
+        if (maxA <= maxB) i += 4;
+        if (maxB <= maxA) j += 4;
+    }
+    return count + intersectMerge(a + i, na - i, b + j, nb - j, out ? out + count : NULL);
+}
+#endif
+
+// Busca galopante: procura cada elemento da lista menor na lista maior
+// Como as duas listas são ordenadas, cada busca começa onde a anterior terminou.
+static int intersectGalloping(const int* small, int ns, const int* large, int nl, int* out) {
+    int count = 0;
+    int lo = 0;
+    for (int i = 0; i < ns && lo < nl; i++) {
+        int x = small[i];
+
+        // Dobra o passo até passar de x: large[lo - 1] < x <= large[hi]
+        int hi = lo;
+        int step = 1;
+        while (hi < nl && large[hi] < x) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        if (hi > nl) hi = nl;
+
+        // Busca binária do primeiro elemento >= x no intervalo [lo, hi]
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (large[mid] < x) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (lo < nl && large[lo] == x) {
+            if (out) out[count] = x;
+            count++;
+            lo++;
+        }
+    }
+    return count;
+}
+
+// Função para calcular a interseção de duas listas ordenadas, escolhendo o algoritmo
+// de acordo com a diferença de tamanho entre elas
+// out: Array de saída com capacidade para min(na, nb) elementos (NULL para apenas contar)
+// Retorna o número de elementos em comum
+int intersectSorted(const int* a, int na, const int* b, int nb, int* out) {
+    // Garante que `a` é a lista menor
+    if (na > nb) {
+        const int* tmp = a;
+        a = b;
+        b = tmp;
+        int n = na;
+        na = nb;
+        nb = n;
+    }
+    if (na == 0) {
+        return 0;
+    }
+    if ((long long)na * GALLOPING_RATIO < nb) {
+        return intersectGalloping(a, na, b, nb, out);
+    }
+#if defined(__SSE2__)
+    return intersectMergeSSE(a, na, b, nb, out);
+#else
+    return intersectMerge(a, na, b, nb, out);
+#endif
+}
+
+// Função para encontrar os amigos em comum entre dois usuários
+// graph: Ponteiro para o grafo
+// a, b: IDs dos usuários
+// result: Array de saída com capacidade para o menor dos dois graus
+// Retorna o número de amigos em comum (os IDs ficam em ordem crescente em result)
+int mutualFriends(Graph* graph, int a, int b, int* result) {
+    CSRGraph* csr = getCSR(graph);
+    return intersectSorted(csr->neighbors + csr->offsets[a], csr->offsets[a + 1] - csr->offsets[a],
+                           csr->neighbors + csr->offsets[b], csr->offsets[b + 1] - csr->offsets[b],
+                           result);
+}
+
+// Função para contar os amigos em comum entre dois usuários
+// graph: Ponteiro para o grafo
+// a, b: IDs dos usuários
+int countMutualFriends(Graph* graph, int a, int b) {
+    return mutualFriends(graph, a, b, NULL);
+}
+
+/*
+7-etapa: Sugestão de amizades ("pessoas que você talvez conheça")
+
+Descrição:
+- Os candidatos são os usuários a distância 2: amigos dos amigos que ainda não são amigos do usuário.
+- A expansão de 2 saltos acumula a pontuação de cada candidato em um contador denso (um `double` por
+  usuário) que pertence ao `Recommender` e é reaproveitado entre chamadas. Só os candidatos tocados são
+  zerados no final, então o custo de cada chamada não depende do número total de usuários.
+- As conexões existentes são descartadas com um array de marcas preenchido a partir das adjacências do usuário.
+- Métricas disponíveis:
+  - `SCORE_COMMON_NEIGHBORS`: número de amigos em comum.
+  - `SCORE_ADAMIC_ADAR`: soma de 1 / log(grau) dos amigos em comum (amigos pouco conectados pesam mais).
+  - `SCORE_JACCARD`: amigos em comum / união dos amigos dos dois usuários.
+- Os k melhores candidatos são selecionados com um min-heap de tamanho k.
+- Para limitar o custo, um amigo com mais de `maxNeighborSample` vizinhos (um "hub") tem apenas uma amostra
+  desse tamanho percorrida, e sua contribuição é multiplicada por grau / amostra.
+- O modo em lote calcula as sugestões de vários usuários em paralelo (OpenMP), com um `Recommender` por thread.
+- Em um grafo direcionado (24-etapa) as sugestões seguem as conexões de saída: os candidatos são os seguidos de
+  quem o usuário segue, e o Adamic-Adar usa o grau total (seguidos + seguidores) do intermediário.
+
+Funções:
+- `createRecommender`: Aloca o estado reutilizável das sugestões.
+- `freeRecommender`: Libera o estado das sugestões.
+- `recommendFriends`: Calcula as k melhores sugestões para um usuário.
+- `recommendFriendsBatch`: Calcula as sugestões de vários usuários em paralelo.
+*/
+
+// Estrutura com o estado reutilizável entre chamadas de `recommendFriends`
+typedef struct Recommender {
+    int numUsers;  // Número de usuários do grafo
+    double* weight;  // Contador denso com a pontuação acumulada de cada candidato
+    int* touched;  // Candidatos tocados na chamada atual
+    int numTouched;  // Número de candidatos tocados
+    int* mark;  // mark[v] == stamp quando v é o próprio usuário ou já é amigo dele
+    int stamp;  // Marca da chamada atual
+    int maxNeighborSample;  // Máximo de vizinhos percorridos por amigo (0 = sem limite)
+} Recommender;
+
+// Função para criar o estado das sugestões
+// numUsers: Número de usuários do grafo
+// maxNeighborSample: Máximo de vizinhos percorridos por amigo (0 = sem limite)
+Recommender* createRecommender(int numUsers, int maxNeighborSample) {
+    Recommender* rec = (Recommender*)malloc(sizeof(Recommender));
+    if (!rec) exit(1);  // Verificação de alocação de memória
+    rec->numUsers = numUsers;
+    rec->weight = (double*)calloc(numUsers, sizeof(double));
+    rec->touched = (int*)malloc(numUsers * sizeof(int));
+    rec->mark = (int*)calloc(numUsers, sizeof(int));
+    if (!rec->weight || !rec->touched || !rec->mark) exit(1);
+    rec->numTouched = 0;
+    rec->stamp = 0;
+    rec->maxNeighborSample = maxNeighborSample;
+    return rec;
+}
+
+// Função para liberar o estado das sugestões
+void freeRecommender(Recommender* rec) {
+    if (rec != NULL) {
+        free(rec->weight);
+        free(rec->touched);
+        free(rec->mark);
+        free(rec);
+    }
+}
+
+// Retorna true se a sugestão a é pior que b (menor pontuação; no empate, maior ID)
+static bool recommendationWorse(const Recommendation* a, const Recommendation* b) {
+    if (a->score != b->score) {
+        return a->score < b->score;
+    }
+    return a->userId > b->userId;
+}
+
+// Reorganiza o min-heap a partir da posição i (a pior sugestão fica na raiz)
+static void recommendationSiftDown(Recommendation* heap, int size, int i) {
+    while (true) {
+        int worst = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < size && recommendationWorse(&heap[left], &heap[worst])) worst = left;
+        if (right < size && recommendationWorse(&heap[right], &heap[worst])) worst = right;
+        if (worst == i) {
+            return;
+        }
+        Recommendation tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+// Insere uma sugestão no min-heap de tamanho máximo k
+static void recommendationPush(Recommendation* heap, int* size, int k, Recommendation item) {
+    if (*size < k) {
+        // Sobe o novo item até a posição correta
+        int i = (*size)++;
+        heap[i] = item;
+        while (i > 0 && recommendationWorse(&heap[i], &heap[(i - 1) / 2])) {
+            Recommendation tmp = heap[i];
+            heap[i] = heap[(i - 1) / 2];
+            heap[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (recommendationWorse(&heap[0], &item)) {
+        // Substitui a pior sugestão atual
+        heap[0] = item;
+        recommendationSiftDown(heap, *size, 0);
+    }
+}
+
+// Extrai as sugestões do min-heap, deixando o array em ordem decrescente de pontuação
+static void recommendationSortHeap(Recommendation* heap, int size) {
+    for (int last = size - 1; last > 0; last--) {
+        Recommendation tmp = heap[0];
+        heap[0] = heap[last];
+        heap[last] = tmp;
+        recommendationSiftDown(heap, last, 0);
+    }
+}
+
+// Função para calcular as k melhores sugestões de amizade para um usuário
+// graph: Ponteiro para o grafo
+// rec: Estado reutilizável (criado com o mesmo número de usuários do grafo)
+// user: ID do usuário
+// k: Número máximo de sugestões
+// metric: Métrica de pontuação
+// result: Array de saída com capacidade para k sugestões, em ordem decrescente de pontuação
+// Retorna o número de sugestões encontradas
+int recommendFriends(Graph* graph, Recommender* rec, int user, int k, RecommendationScore metric, Recommendation* result) {
+    CSRGraph* csr = getCSR(graph);
+    const int* offsets = csr->offsets;
+    const int* neighbors = csr->neighbors;
+    int userDegree = offsets[user + 1] - offsets[user];
+
+    // Marca o próprio usuário e seus amigos para não sugeri-los
+    rec->stamp++;
+    rec->mark[user] = rec->stamp;
+    for (int e = offsets[user]; e < offsets[user + 1]; e++) {
+        rec->mark[neighbors[e]] = rec->stamp;
+    }
+
+    // Expansão de 2 saltos: cada amigo w contribui para os seus vizinhos
+    rec->numTouched = 0;
+    for (int e = offsets[user]; e < offsets[user + 1]; e++) {
+        int friendId = neighbors[e];
+        int friendDegree = offsets[friendId + 1] - offsets[friendId];
+        double contribution = 1.0;
+        if (metric == SCORE_ADAMIC_ADAR) {
+            // friendDegree >= 2 quando há candidato; em um grafo direcionado, friendId segue o candidato e é
+            // seguido pelo usuário, então o grau total (saída + entrada) é >= 2
+            int hubDegree = graph->directed ? friendDegree + graph->inDegree[friendId] : friendDegree;
+            contribution = 1.0 / log((double)hubDegree);
+        }
+
+        // Hubs: percorre uma amostra de tamanho fixo com passo constante a partir de uma posição pseudoaleatória
+        int sampleSize = friendDegree;
+        int start = 0;
+        double step = 1.0;
+        if (rec->maxNeighborSample > 0 && friendDegree > rec->maxNeighborSample) {
+            sampleSize = rec->maxNeighborSample;
+            step = (double)friendDegree / sampleSize;
+            start = (int)(((unsigned int)user * 2654435761u ^ (unsigned int)friendId) % (unsigned int)friendDegree);
+            contribution *= step;
+        }
+
+        for (int s = 0; s < sampleSize; s++) {
+            int pos = start + (int)(s * step);
+            if (pos >= friendDegree) pos -= friendDegree;
+            int candidate = neighbors[offsets[friendId] + pos];
+            if (rec->mark[candidate] == rec->stamp) {
+                continue;  // Usuário ou conexão existente
+            }
+            if (rec->weight[candidate] == 0.0) {
+                rec->touched[rec->numTouched++] = candidate;
+            }
+            rec->weight[candidate] += contribution;
+        }
+    }
+
+    // Calcula a pontuação final e mantém os k melhores no heap
+    int size = 0;
+    for (int i = 0; i < rec->numTouched; i++) {
+        int candidate = rec->touched[i];
+        double score = rec->weight[candidate];
+        if (metric == SCORE_JACCARD) {
+            int candidateDegree = offsets[candidate + 1] - offsets[candidate];
+            double common = score;
+            double limit = userDegree < candidateDegree ? userDegree : candidateDegree;
+            if (common > limit) common = limit;  // A amostragem pode superestimar
+            score = common / (userDegree + candidateDegree - common);
+        }
+        rec->weight[candidate] = 0.0;  // Deixa o contador pronto para a próxima chamada
+
+        if (k > 0) {
+            Recommendation item = { candidate, score };
+            recommendationPush(result, &size, k, item);
+        }
+    }
+    rec->numTouched = 0;
+
+    recommendationSortHeap(result, size);
+    return size;
+}
+
+// Função para calcular as sugestões de vários usuários em paralelo
+// graph: Ponteiro para o grafo
+// users: IDs dos usuários
+// count: Número de usuários em `users`
+// k: Número máximo de sugestões por usuário
+// metric: Métrica de pontuação
+// maxNeighborSample: Máximo de vizinhos percorridos por amigo (0 = sem limite)
+// results: Array de saída com count * k posições (as sugestões de users[i] começam em results[i * k])
+// resultCounts: Array de saída com o número de sugestões de cada usuário
+void recommendFriendsBatch(Graph* graph, const int* users, int count, int k, RecommendationScore metric,
+                           int maxNeighborSample, Recommendation* results, int* resultCounts) {
+    getCSR(graph);  // Constrói o CSR antes da região paralela
+
+    #pragma omp parallel
+    {
+        Recommender* rec = createRecommender(graph->numUsers, maxNeighborSample);
+
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < count; i++) {
+            resultCounts[i] = recommendFriends(graph, rec, users[i], k, metric, results + (size_t)i * k);
+        }
+
+        freeRecommender(rec);
+    }
+}
+
+/*
+8-etapa: Contagem de triângulos e coeficiente de agrupamento
+
+Descrição:
+- Um triângulo é um trio de usuários conectados dois a dois. O coeficiente de agrupamento local de um
+  usuário é a fração de pares dos seus amigos que também são amigos entre si.
+- Contagem exata (algoritmo "forward"):
+  - Os usuários são ordenados pelo grau (empates pelo ID) e cada aresta é orientada do usuário de menor
+    posição para o de maior posição. Assim cada lista orientada tem no máximo O(sqrt(E)) vizinhos,
+    mesmo para hubs.
+  - Cada triângulo é encontrado uma única vez, pela interseção das listas orientadas das duas pontas de
+    uma aresta, usando a interseção adaptativa (SSE2 / galopante) da 6-etapa.
+  - Os usuários são divididos entre as threads com escalonamento dinâmico, porque o custo varia muito
+    de um usuário para outro.
+- Contagem aproximada (amostragem de cunhas):
+  - Uma cunha é um caminho de 2 arestas centrado em um usuário. Sorteia-se cunhas uniformemente e
+    verifica-se se estão fechadas (se as pontas são amigas).
+  - A fração de cunhas fechadas estima o coeficiente de agrupamento global, e triângulos ≈ fração * cunhas / 3.
+
+Funções:
+- `countTriangles`: Conta os triângulos do grafo (e, opcionalmente, os triângulos de cada usuário).
+- `localClusteringCoefficients`: Calcula o coeficiente de agrupamento local de cada usuário.
+- `approximateTriangles`: Estima o número de triângulos por amostragem de cunhas.
+*/
+
+// Gerador pseudoaleatório SplitMix64 (estado próprio, seguro para uso em paralelo)
+static unsigned long long splitMix64(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Retorna true se u vem antes de v na ordem por grau (empates pelo ID)
+static bool rankedBefore(const int* offsets, int u, int v) {
+    int du = offsets[u + 1] - offsets[u];
+    int dv = offsets[v + 1] - offsets[v];
+    return du < dv || (du == dv && u < v);
+}
+
+// Função para contar os triângulos do grafo
+// graph: Ponteiro para o grafo
+// perUser: Array de saída com os triângulos de cada usuário (NULL se não for necessário)
+// Retorna o número total de triângulos
+long long countTriangles(Graph* graph, long long* perUser) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = csr->numUsers;
+
+    // Monta as listas orientadas: apenas os vizinhos que vêm depois na ordem por grau
+    // (a filtragem preserva a ordenação por ID)
+    int* forwardOffsets = (int*)malloc((n + 1) * sizeof(int));
+    if (!forwardOffsets) exit(1);
+    forwardOffsets[0] = 0;
+    int maxForwardDegree = 0;
+    for (int u = 0; u < n; u++) {
+        int degree = 0;
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            if (rankedBefore(csr->offsets, u, csr->neighbors[e])) degree++;
+        }
+        forwardOffsets[u + 1] = forwardOffsets[u] + degree;
+        if (degree > maxForwardDegree) maxForwardDegree = degree;
+    }
+    int* forward = (int*)malloc((forwardOffsets[n] + 1) * sizeof(int));
+    if (!forward) exit(1);
+    for (int u = 0; u < n; u++) {
+        int pos = forwardOffsets[u];
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            if (rankedBefore(csr->offsets, u, csr->neighbors[e])) forward[pos++] = csr->neighbors[e];
+        }
+    }
+
+    if (perUser) {
+        memset(perUser, 0, n * sizeof(long long));
+    }
+
+    long long total = 0;
+    #pragma omp parallel reduction(+:total)
+    {
+        int* common = perUser ? (int*)malloc((maxForwardDegree + 1) * sizeof(int)) : NULL;
+
+        #pragma omp for schedule(dynamic, 64)
+        for (int u = 0; u < n; u++) {
+            for (int e = forwardOffsets[u]; e < forwardOffsets[u + 1]; e++) {
+                int v = forward[e];
+                int found = intersectSorted(forward + forwardOffsets[u], forwardOffsets[u + 1] - forwardOffsets[u],
+                                            forward + forwardOffsets[v], forwardOffsets[v + 1] - forwardOffsets[v],
+                                            common);
+                total += found;
+
+                if (perUser && found > 0) {
+                    // Cada triângulo (u, v, w) conta para os três usuários
+                    #pragma omp atomic
+                    perUser[u] += found;
+                    #pragma omp atomic
+                    perUser[v] += found;
+                    for (int i = 0; i < found; i++) {
+                        #pragma omp atomic
+                        perUser[common[i]]++;
+                    }
+                }
+            }
+        }
+
+        free(common);
+    }
+
+    free(forwardOffsets);
+    free(forward);
+    return total;
+}
+
+// Função para calcular o coeficiente de agrupamento local de cada usuário
+// graph: Ponteiro para o grafo
+// coefficient: Array de saída com o coeficiente de cada usuário (0 para usuários com menos de 2 amigos)
+// Retorna a média dos coeficientes
+double localClusteringCoefficients(Graph* graph, double* coefficient) {
+    int n = graph->numUsers;
+    long long* triangles = (long long*)malloc((n + 1) * sizeof(long long));
+    if (!triangles) exit(1);
+    countTriangles(graph, triangles);
+
+    CSRGraph* csr = getUndirectedCSR(graph);
+    double sum = 0.0;
+    for (int v = 0; v < n; v++) {
+        long long degree = csr->offsets[v + 1] - csr->offsets[v];
+        coefficient[v] = degree < 2 ? 0.0 : 2.0 * triangles[v] / (double)(degree * (degree - 1));
+        sum += coefficient[v];
+    }
+
+    free(triangles);
+    return n > 0 ? sum / n : 0.0;
+}
+
+// Função para estimar o número de triângulos por amostragem de cunhas
+// graph: Ponteiro para o grafo
+// numSamples: Número de cunhas sorteadas
+// seed: Semente do gerador pseudoaleatório (o resultado não depende do número de threads)
+// globalClustering: Saída com a estimativa do coeficiente de agrupamento global (pode ser NULL)
+// Retorna a estimativa do número de triângulos
+long long approximateTriangles(Graph* graph, int numSamples, unsigned long long seed, double* globalClustering) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = csr->numUsers;
+
+    // Soma acumulada do número de cunhas centradas em cada usuário
+    double* cumulativeWedges = (double*)malloc((n + 1) * sizeof(double));
+    if (!cumulativeWedges) exit(1);
+    cumulativeWedges[0] = 0.0;
+    for (int v = 0; v < n; v++) {
+        double degree = csr->offsets[v + 1] - csr->offsets[v];
+        cumulativeWedges[v + 1] = cumulativeWedges[v] + degree * (degree - 1) / 2.0;
+    }
+    double totalWedges = cumulativeWedges[n];
+
+    if (totalWedges == 0.0 || numSamples <= 0) {
+        free(cumulativeWedges);
+        if (globalClustering) *globalClustering = 0.0;
+        return 0;
+    }
+
+    long long closed = 0;
+    #pragma omp parallel for schedule(static) reduction(+:closed)
+    for (int s = 0; s < numSamples; s++) {
+        unsigned long long state = seed + (unsigned long long)s * 0x2545F4914F6CDD1DULL;
+
+        // Sorteia o centro com probabilidade proporcional ao número de cunhas
+        double r = (splitMix64(&state) >> 11) * (1.0 / 9007199254740992.0) * totalWedges;
+        int lo = 0, hi = n - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (cumulativeWedges[mid + 1] <= r) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        int center = lo;
+        int degree = csr->offsets[center + 1] - csr->offsets[center];
+        if (degree < 2) continue;  // Arredondamento no limite do intervalo
+
+        // Sorteia dois vizinhos distintos do centro
+        int i = (int)(splitMix64(&state) % (unsigned long long)degree);
+        int j = (int)(splitMix64(&state) % (unsigned long long)(degree - 1));
+        if (j >= i) j++;
+        int a = csr->neighbors[csr->offsets[center] + i];
+        int b = csr->neighbors[csr->offsets[center] + j];
+
+        // A cunha está fechada se b aparece na lista ordenada de a
+        if (bsearch(&b, csr->neighbors + csr->offsets[a], csr->offsets[a + 1] - csr->offsets[a], sizeof(int), compareInts)) {
+            closed++;
+        }
+    }
+
+    double fraction = (double)closed / numSamples;
+    if (globalClustering) *globalClustering = fraction;
+    free(cumulativeWedges);
+    return (long long)(fraction * totalWedges / 3.0 + 0.5);
+}
+
+/*
+9-etapa: Vizinhança de k saltos (rede ego)
+
+Descrição:
+- Retorna todos os usuários a até k saltos de um usuário, agrupados por distância, e opcionalmente o
+  subgrafo induzido por eles em formato CSR (ex.: para desenhar a vizinhança no Graphviz).
+- A busca usa um `BFSScratch`: estado de BFS alocado uma vez e reaproveitado entre chamadas. Diferente do
+  array `visited` do grafo, cada chamada usa o seu próprio scratch, então várias buscas podem rodar ao mesmo
+  tempo. Os visitados são marcados com um carimbo (stamp) que muda a cada busca, então não é preciso
+  limpar o array.
+- A BFS para assim que atinge `maxResults` membros, para que contas "celebridade" não estourem a latência.
+  Nesse caso o resultado é marcado como truncado e a última camada fica incompleta.
+
+Funções:
+- `createBFSScratch`: Aloca o estado reutilizável de BFS.
+- `freeBFSScratch`: Libera o estado de BFS.
+- `kHopNeighborhood`: Executa a BFS limitada e preenche um `KHopResult`.
+- `extractInducedSubgraph`: Constrói o CSR induzido por um conjunto de usuários.
+- `freeKHopResult`: Libera a memória de um `KHopResult`.
+*/
+
+// Função para criar o estado de BFS
+// numUsers: Número de usuários do grafo
+BFSScratch* createBFSScratch(int numUsers) {
+    BFSScratch* scratch = (BFSScratch*)malloc(sizeof(BFSScratch));
+    if (!scratch) exit(1);  // Verificação de alocação de memória
+    scratch->numUsers = numUsers;
+    scratch->stamp = (int*)calloc(numUsers, sizeof(int));
+    scratch->queue = (int*)malloc(numUsers * sizeof(int));
+    scratch->distance = (int*)malloc(numUsers * sizeof(int));
+    scratch->predecessor = (int*)malloc(numUsers * sizeof(int));
+    scratch->localIndex = (int*)malloc(numUsers * sizeof(int));
+    if (!scratch->stamp || !scratch->queue || !scratch->distance || !scratch->predecessor || !scratch->localIndex) exit(1);
+    scratch->currentStamp = 0;
+    return scratch;
+}
+
+// Função para liberar o estado de BFS
+void freeBFSScratch(BFSScratch* scratch) {
+    if (scratch != NULL) {
+        free(scratch->stamp);
+        free(scratch->queue);
+        free(scratch->distance);
+        free(scratch->predecessor);
+        free(scratch->localIndex);
+        free(scratch);
+    }
+}
+
+// Inicia uma nova busca: troca o carimbo (limpa o array só quando o contador dá a volta)
+static void bfsScratchReset(BFSScratch* scratch) {
+    if (scratch->currentStamp == INT_MAX) {
+        memset(scratch->stamp, 0, scratch->numUsers * sizeof(int));
+        scratch->currentStamp = 0;
+    }
+    scratch->currentStamp++;
+}
+
+// Função para construir o subgrafo induzido por um conjunto de usuários
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS (o carimbo atual é substituído)
+// members: IDs dos usuários do subgrafo (o vértice local i corresponde a members[i])
+// count: Número de usuários em `members`
+CSRGraph* extractInducedSubgraph(Graph* graph, BFSScratch* scratch, const int* members, int count) {
+    CSRGraph* csr = getCSR(graph);
+
+    // Marca os membros e guarda o índice local de cada um
+    bfsScratchReset(scratch);
+    for (int i = 0; i < count; i++) {
+        scratch->stamp[members[i]] = scratch->currentStamp;
+        scratch->localIndex[members[i]] = i;
+    }
+
+    CSRGraph* sub = (CSRGraph*)malloc(sizeof(CSRGraph));
+    if (!sub) exit(1);
+    sub->numUsers = count;
+    sub->offsets = (int*)malloc((count + 1) * sizeof(int));
+    if (!sub->offsets) exit(1);
+
+    // Conta as arestas internas de cada membro
+    sub->offsets[0] = 0;
+    for (int i = 0; i < count; i++) {
+        int u = members[i];
+        int degree = 0;
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            if (scratch->stamp[csr->neighbors[e]] == scratch->currentStamp) degree++;
+        }
+        sub->offsets[i + 1] = sub->offsets[i] + degree;
+    }
+
+    // Preenche as listas com índices locais, ordenadas como no CSR original
+    sub->neighbors = (int*)malloc((sub->offsets[count] + 1) * sizeof(int));
+    sub->weights = NULL;
+    if (!sub->neighbors) exit(1);
+    for (int i = 0; i < count; i++) {
+        int u = members[i];
+        int pos = sub->offsets[i];
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            int v = csr->neighbors[e];
+            if (scratch->stamp[v] == scratch->currentStamp) sub->neighbors[pos++] = scratch->localIndex[v];
+        }
+        qsort(sub->neighbors + sub->offsets[i], pos - sub->offsets[i], sizeof(int), compareInts);
+    }
+
+    return sub;
+}
+
+// Função para encontrar os usuários a até maxHops saltos de um usuário
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS reutilizável
+// user: ID do usuário central
+// maxHops: Distância máxima
+// maxResults: Número máximo de membros, incluindo o usuário central (0 = sem limite)
+// buildSubgraph: Se true, também constrói o subgrafo induzido pelos membros
+// result: Estrutura de saída (liberar com freeKHopResult)
+// Retorna o número de membros encontrados
+int kHopNeighborhood(Graph* graph, BFSScratch* scratch, int user, int maxHops, int maxResults, bool buildSubgraph, KHopResult* result) {
+    CSRGraph* csr = getCSR(graph);
+    int capacity = (maxResults > 0 && maxResults < csr->numUsers) ? maxResults : csr->numUsers;
+    if (maxHops < 0) maxHops = 0;
+    if (maxHops > csr->numUsers) maxHops = csr->numUsers;  // Mais saltos não alcançam ninguém novo (e evitam overflow)
+
+    result->members = (int*)malloc(capacity * sizeof(int));
+    result->levelStart = (int*)malloc((maxHops + 2) * sizeof(int));
+    if (!result->members || !result->levelStart) exit(1);
+    result->truncated = false;
+    result->subgraph = NULL;
+
+    // Os membros são a própria fila da BFS, já agrupados por distância
+    bfsScratchReset(scratch);
+    int* members = result->members;
+    members[0] = user;
+    scratch->stamp[user] = scratch->currentStamp;
+    scratch->distance[user] = 0;
+    int count = 1;
+    int numLevels = 1;
+    result->levelStart[0] = 0;
+
+    for (int depth = 0; depth < maxHops && !result->truncated; depth++) {
+        int levelBegin = result->levelStart[depth];
+        int levelEnd = count;
+        result->levelStart[depth + 1] = count;
+
+        for (int i = levelBegin; i < levelEnd && !result->truncated; i++) {
+            int u = members[i];
+            for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+                int v = csr->neighbors[e];
+                if (scratch->stamp[v] == scratch->currentStamp) {
+                    continue;
+                }
+                if (count == capacity) {
+                    result->truncated = true;  // Limite atingido: interrompe a busca
+                    break;
+                }
+                scratch->stamp[v] = scratch->currentStamp;
+                scratch->distance[v] = depth + 1;
+                members[count++] = v;
+            }
+        }
+
+        if (count == levelEnd) {
+            break;  // Nenhum usuário novo nesta distância
+        }
+        numLevels = depth + 2;
+    }
+
+    result->levelStart[numLevels] = count;
+    result->numLevels = numLevels;
+    result->count = count;
+
+    if (buildSubgraph) {
+        result->subgraph = extractInducedSubgraph(graph, scratch, members, count);
+    }
+    return count;
+}
+
+// Função para liberar a memória de um KHopResult
+void freeKHopResult(KHopResult* result) {
+    free(result->members);
+    free(result->levelStart);
+    freeCSR(result->subgraph);
+    result->members = NULL;
+    result->levelStart = NULL;
+    result->subgraph = NULL;
+}
+
+/*
+10-etapa: Função de vizinhança aproximada e histograma de graus de separação (HyperANF)
+
+Descrição:
+- A função de vizinhança N(t) é o número de pares de usuários (u, v) com distância <= t. A partir dela
+  saem o histograma de distâncias, a distância média ("graus de separação") e o diâmetro efetivo.
+- Calcular N(t) exatamente exigiria uma BFS por usuário. Aqui cada usuário tem um contador HyperLogLog
+  (2^b registradores de 1 byte) que estima quantos usuários estão a até t saltos dele:
+  - Em t = 0 cada contador contém apenas o próprio usuário.
+  - A cada passo o contador de v recebe a união (máximo registrador a registrador) dos contadores dos vizinhos.
+  - O processo termina quando nenhum contador muda, após um número de passos próximo do diâmetro.
+- Cada passo é uma varredura linear das arestas, paralela entre usuários (OpenMP), e a união dos registradores
+  usa SSE2 (16 registradores por instrução).
+
+Funções:
+- `computeNeighborhoodFunction`: Calcula N(t), o histograma de distâncias, a distância média e o diâmetro efetivo.
+- `freeNeighborhoodFunction`: Libera a memória do resultado.
+*/
+
+// Estima a cardinalidade de um contador HyperLogLog com m registradores
+static double hyperLogLogEstimate(const unsigned char* registers, int m) {
+    double sum = 0.0;
+    int zeros = 0;
+    for (int j = 0; j < m; j++) {
+        sum += ldexp(1.0, -registers[j]);
+        if (registers[j] == 0) zeros++;
+    }
+
+    double alpha;
+    if (m == 16) {
+        alpha = 0.673;
+    } else if (m == 32) {
+        alpha = 0.697;
+    } else if (m == 64) {
+        alpha = 0.709;
+    } else {
+        alpha = 0.7213 / (1.0 + 1.079 / m);
+    }
+    double estimate = alpha * m * m / sum;
+
+    // Correção para cardinalidades pequenas (contagem linear)
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log((double)m / zeros);
+    }
+    return estimate;
+}
+
+// Une o contador src ao contador dst (máximo registrador a registrador)
+static void hyperLogLogUnion(unsigned char* dst, const unsigned char* src, int m) {
+    int j = 0;
+#if defined(__SSE2__)
+    for (; j + 16 <= m; j += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + j));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + j));
+        _mm_storeu_si128((__m128i*)(dst + j), _mm_max_epu8(a, b));
+    }
+#endif
+    for (; j < m; j++) {
+        if (src[j] > dst[j]) dst[j] = src[j];
+    }
+}
+
+// Função para calcular a função de vizinhança aproximada do grafo
+// graph: Ponteiro para o grafo
+// log2Registers: Logaritmo do número de registradores por usuário (4 a 16; erro relativo ~1.04 / sqrt(2^b))
+// maxSteps: Número máximo de passos (distância máxima considerada)
+// result: Estrutura de saída (liberar com freeNeighborhoodFunction)
+void computeNeighborhoodFunction(Graph* graph, int log2Registers, int maxSteps, NeighborhoodFunction* result) {
+    CSRGraph* csr = getCSR(graph);
+    int n = csr->numUsers;
+    if (log2Registers < 4) log2Registers = 4;
+    if (log2Registers > 16) log2Registers = 16;
+    if (maxSteps < 1) maxSteps = 1;
+    int m = 1 << log2Registers;
+
+    unsigned char* current = (unsigned char*)calloc((size_t)n * m, 1);
+    unsigned char* next = (unsigned char*)malloc((size_t)n * m + 1);
+    result->values = (double*)malloc((maxSteps + 1) * sizeof(double));
+    result->histogram = (double*)malloc((maxSteps + 1) * sizeof(double));
+    if (!current || !next || !result->values || !result->histogram) exit(1);
+
+    // t = 0: cada contador contém apenas o próprio usuário
+    double total = 0.0;
+    for (int v = 0; v < n; v++) {
+        unsigned long long state = (unsigned long long)v;
+        unsigned long long hash = splitMix64(&state);
+        int index = (int)(hash >> (64 - log2Registers));
+        unsigned long long rest = hash << log2Registers;
+        int rank = rest ? __builtin_clzll(rest) + 1 : 64 - log2Registers + 1;
+        current[(size_t)v * m + index] = (unsigned char)rank;
+        total += hyperLogLogEstimate(current + (size_t)v * m, m);
+    }
+    result->values[0] = total;
+    int steps = 1;
+
+    // t >= 1: cada contador recebe a união dos contadores dos vizinhos
+    while (steps <= maxSteps) {
+        int changed = 0;
+        total = 0.0;
+
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:total, changed)
+        for (int v = 0; v < n; v++) {
+            unsigned char* counter = next + (size_t)v * m;
+            memcpy(counter, current + (size_t)v * m, m);
+            for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                hyperLogLogUnion(counter, current + (size_t)csr->neighbors[e] * m, m);
+            }
+            if (memcmp(counter, current + (size_t)v * m, m) != 0) {
+                changed++;
+            }
+            total += hyperLogLogEstimate(counter, m);
+        }
+
+        if (changed == 0) {
+            break;  // Todos os contadores estabilizaram
+        }
+        result->values[steps++] = total;
+
+        unsigned char* tmp = current;
+        current = next;
+        next = tmp;
+    }
+    result->numSteps = steps;
+
+    // Histograma de distâncias e distância média
+    result->histogram[0] = result->values[0];
+    double reachablePairs = 0.0;
+    double distanceSum = 0.0;
+    for (int t = 1; t < steps; t++) {
+        double pairs = result->values[t] - result->values[t - 1];
+        if (pairs < 0.0) pairs = 0.0;  // Ruído da estimativa
+        result->histogram[t] = pairs;
+        reachablePairs += pairs;
+        distanceSum += t * pairs;
+    }
+    result->averageDistance = reachablePairs > 0.0 ? distanceSum / reachablePairs : 0.0;
+
+    // Diâmetro efetivo: interpolação linear no ponto em que 90% dos pares alcançáveis foram cobertos
+    result->effectiveDiameter = 0.0;
+    double threshold = 0.9 * reachablePairs;
+    double covered = 0.0;
+    for (int t = 1; t < steps; t++) {
+        if (covered + result->histogram[t] >= threshold && result->histogram[t] > 0.0) {
+            result->effectiveDiameter = (t - 1) + (threshold - covered) / result->histogram[t];
+            break;
+        }
+        covered += result->histogram[t];
+    }
+
+    free(current);
+    free(next);
+}
+
+// Função para liberar a memória de uma NeighborhoodFunction
+void freeNeighborhoodFunction(NeighborhoodFunction* result) {
+    free(result->values);
+    free(result->histogram);
+    result->values = NULL;
+    result->histogram = NULL;
+}
+
+/*
+11-etapa: Centralidade de intermediação (betweenness) pelo algoritmo de Brandes
+
+Descrição:
+- A intermediação de um usuário v é a soma, sobre todos os pares (s, t), da fração dos menores caminhos
+  entre s e t que passam por v. Usuários com intermediação alta são "pontes" entre grupos.
+- Algoritmo de Brandes, para cada origem s:
+  - Uma BFS (com o `BFSScratch` da 9-etapa) conta sigma[v], o número de menores caminhos de s até v,
+    e guarda a ordem de visita.
+  - Percorrendo a ordem de visita ao contrário, acumula as dependências
+    delta[v] = soma sobre os sucessores w de sigma[v] / sigma[w] * (1 + delta[w]).
+    Os predecessores de w são lidos do CSR de entrada (24-etapa), que em grafos não direcionados é o próprio CSR.
+  - delta[v] é somado à centralidade de v.
+  - Em um grafo não direcionado cada par é visto das duas pontas, e o resultado é dividido por 2. Em um grafo
+    direcionado cada par ordenado (s, t) conta separadamente.
+- As origens são divididas entre as threads. Cada thread tem seu próprio scratch e seu próprio acumulador,
+  somados ao resultado no final, sem sincronização durante as buscas.
+- O modo aproximado processa apenas k origens sorteadas e multiplica o resultado por n / k. Pela
+  desigualdade de Hoeffding (com união sobre os n usuários), com probabilidade de pelo menos 90% o erro
+  absoluto de todas as estimativas fica abaixo do limite retornado.
+
+Funções:
+- `computeBetweenness`: Calcula a intermediação exata de todos os usuários.
+- `approximateBetweenness`: Estima a intermediação a partir de k origens sorteadas.
+*/
+
+// Probabilidade de falha usada no limite de erro do modo aproximado
+#define BETWEENNESS_FAILURE_PROBABILITY 0.1
+
+// Acumula em centrality as dependências de todos os usuários em relação à origem source
+// incoming: CSR das conexões de entrada, usado para achar os predecessores na volta
+static void brandesAccumulate(CSRGraph* csr, CSRGraph* incoming, BFSScratch* scratch, double* sigma, double* delta, int source, double* centrality) {
+    const int* offsets = csr->offsets;
+    const int* neighbors = csr->neighbors;
+    const int* inOffsets = incoming->offsets;
+    const int* inNeighbors = incoming->neighbors;
+    int* queue = scratch->queue;
+    int* distance = scratch->distance;
+    int* stamp = scratch->stamp;
+
+    // BFS contando os menores caminhos
+    bfsScratchReset(scratch);
+    int visitedStamp = scratch->currentStamp;
+    stamp[source] = visitedStamp;
+    distance[source] = 0;
+    sigma[source] = 1.0;
+    delta[source] = 0.0;
+    queue[0] = source;
+    int head = 0;
+    int tail = 1;
+
+    while (head < tail) {
+        int u = queue[head++];
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = neighbors[e];
+            if (stamp[v] != visitedStamp) {
+                stamp[v] = visitedStamp;
+                distance[v] = distance[u] + 1;
+                sigma[v] = 0.0;
+                delta[v] = 0.0;
+                queue[tail++] = v;
+            }
+            if (distance[v] == distance[u] + 1) {
+                sigma[v] += sigma[u];
+            }
+        }
+    }
+
+    // Acumula as dependências em ordem decrescente de distância
+    for (int i = tail - 1; i > 0; i--) {
+        int w = queue[i];
+        double coefficient = (1.0 + delta[w]) / sigma[w];
+        for (int e = inOffsets[w]; e < inOffsets[w + 1]; e++) {
+            int v = inNeighbors[e];
+            if (stamp[v] == visitedStamp && distance[v] == distance[w] - 1) {
+                delta[v] += sigma[v] * coefficient;
+            }
+        }
+        centrality[w] += delta[w];
+    }
+}
+
+// Executa Brandes para a lista de origens, em paralelo, somando em centrality
+static void brandesFromSources(Graph* graph, const int* sources, int numSources, double* centrality) {
+    CSRGraph* csr = getCSR(graph);
+    CSRGraph* incoming = getReverseCSR(graph);  // O mesmo CSR em grafos não direcionados
+    int n = csr->numUsers;
+    memset(centrality, 0, n * sizeof(double));
+
+    #pragma omp parallel
+    {
+        BFSScratch* scratch = createBFSScratch(n);
+        double* sigma = (double*)malloc(n * sizeof(double));
+        double* delta = (double*)malloc(n * sizeof(double));
+        double* local = (double*)calloc(n, sizeof(double));
+        if (!sigma || !delta || !local) exit(1);
+
+        #pragma omp for schedule(dynamic, 8)
+        for (int i = 0; i < numSources; i++) {
+            brandesAccumulate(csr, incoming, scratch, sigma, delta, sources[i], local);
+        }
+
+        // Redução dos acumuladores de cada thread
+        #pragma omp critical
+        {
+            for (int v = 0; v < n; v++) {
+                centrality[v] += local[v];
+            }
+        }
+
+        freeBFSScratch(scratch);
+        free(sigma);
+        free(delta);
+        free(local);
+    }
+}
+
+// Função para calcular a intermediação exata de todos os usuários
+// graph: Ponteiro para o grafo
+// centrality: Array de saída com a intermediação de cada usuário (em grafos não direcionados cada par não
+// ordenado conta uma vez; em direcionados cada par ordenado conta)
+void computeBetweenness(Graph* graph, double* centrality) {
+    int n = graph->numUsers;
+    int* sources = (int*)malloc((n + 1) * sizeof(int));
+    if (!sources) exit(1);
+    for (int i = 0; i < n; i++) {
+        sources[i] = i;
+    }
+
+    brandesFromSources(graph, sources, n, centrality);
+
+    // Em um grafo não direcionado cada par é contado nas duas direções
+    if (!graph->directed) {
+        for (int v = 0; v < n; v++) {
+            centrality[v] /= 2.0;
+        }
+    }
+    free(sources);
+}
+
+// Função para estimar a intermediação a partir de origens sorteadas
+// graph: Ponteiro para o grafo
+// numSamples: Número de origens sorteadas (sem repetição)
+// seed: Semente do gerador pseudoaleatório
+// centrality: Array de saída com a estimativa da intermediação de cada usuário
+// Retorna o limite do erro absoluto das estimativas (válido com probabilidade >= 90%)
+double approximateBetweenness(Graph* graph, int numSamples, unsigned long long seed, double* centrality) {
+    int n = graph->numUsers;
+    if (numSamples >= n || numSamples <= 0) {
+        computeBetweenness(graph, centrality);
+        return 0.0;
+    }
+
+    // Sorteia as origens com um Fisher-Yates parcial
+    int* sources = (int*)malloc(n * sizeof(int));
+    if (!sources) exit(1);
+    for (int i = 0; i < n; i++) {
+        sources[i] = i;
+    }
+    unsigned long long state = seed;
+    for (int i = 0; i < numSamples; i++) {
+        int j = i + (int)(splitMix64(&state) % (unsigned long long)(n - i));
+        int tmp = sources[i];
+        sources[i] = sources[j];
+        sources[j] = tmp;
+    }
+
+    brandesFromSources(graph, sources, numSamples, centrality);
+
+    // Cada origem contribui com no máximo n - 2 para um usuário; escala para todas as origens
+    // (em um grafo não direcionado cada par é contado nas duas direções)
+    double pairFactor = graph->directed ? 1.0 : 2.0;
+    double scale = (double)n / numSamples / pairFactor;
+    for (int v = 0; v < n; v++) {
+        centrality[v] *= scale;
+    }
+    free(sources);
+
+    return n / pairFactor * (n - 2) * sqrt(log(2.0 * n / BETWEENNESS_FAILURE_PROBABILITY) / (2.0 * numSamples));
+}
+
+/*
+12-etapa: PageRank e PageRank personalizado
+
+Descrição:
+- PageRank global ("pull"): a cada iteração cada usuário soma as contribuições rank[u] / grau(u) dos
+  vizinhos lidas do CSR, sem escritas concorrentes. As contribuições são calculadas uma vez por iteração
+  em um array separado, para que a soma leia um único valor por vizinho.
+  - Em um grafo direcionado, o rank vem de quem segue o usuário: a soma lê o CSR de entrada (24-etapa) e o
+    grau do denominador é o número de seguidos.
+  - Os usuários são divididos em partições contíguas com aproximadamente o mesmo número de arestas, e as
+    partições são distribuídas entre as threads. Assim os hubs não desequilibram a carga e cada thread
+    percorre uma faixa contígua do CSR.
+  - Usuários sem conexões distribuem o seu rank igualmente entre todos.
+  - A iteração para quando a soma das diferenças absolutas (norma L1) fica abaixo da tolerância.
+- PageRank personalizado aproximado para um único usuário (push de Andersen-Chung-Lang):
+  - Mantém uma estimativa p e um resíduo r, começando com todo o resíduo no usuário.
+  - Enquanto algum usuário u tiver r[u] >= epsilon * grau(u), move alpha * r[u] para p[u] e distribui o
+    restante entre os vizinhos.
+  - O número de pushes é O(1 / (epsilon * alpha)), independente do tamanho do grafo. Os arrays ficam em um
+    `PPRScratch` reutilizável e só as posições tocadas são limpas ao final.
+
+Funções:
+- `computePageRank`: Calcula o PageRank de todos os usuários.
+- `createPPRScratch`: Aloca o estado reutilizável do PageRank personalizado.
+- `freePPRScratch`: Libera o estado do PageRank personalizado.
+- `personalizedPageRank`: Calcula os usuários mais relevantes para um usuário.
+*/
+
+// Número aproximado de arestas por partição no PageRank global
+#define PAGERANK_PARTITION_EDGES 65536
+
+// Estrutura com o estado reutilizável do PageRank personalizado
+typedef struct PPRScratch {
+    int numUsers;  // Número de usuários do grafo
+    double* estimate;  // Estimativa p do PageRank personalizado
+    double* residual;  // Resíduo r ainda não distribuído
+    bool* inQueue;  // Indica se o usuário está na fila de push
+    int* queue;  // Fila circular de usuários com resíduo acima do limite
+    int* touched;  // Usuários com estimativa ou resíduo alterados
+    int numTouched;  // Número de usuários tocados
+} PPRScratch;
+
+// Função para calcular o PageRank de todos os usuários
+// graph: Ponteiro para o grafo
+// damping: Fator de amortecimento (normalmente 0.85)
+// tolerance: Norma L1 da diferença entre iterações abaixo da qual o cálculo para
+// maxIterations: Número máximo de iterações
+// rank: Array de saída com o PageRank de cada usuário (soma 1)
+// Retorna o número de iterações executadas
+int computePageRank(Graph* graph, double damping, double tolerance, int maxIterations, double* rank) {
+    CSRGraph* csr = getCSR(graph);
+    CSRGraph* incoming = getReverseCSR(graph);  // O mesmo CSR em grafos não direcionados
+    int n = csr->numUsers;
+    if (n == 0) {
+        return 0;
+    }
+
+    // Divide os usuários em partições com aproximadamente o mesmo número de arestas
+    int* partitionStart = (int*)malloc((n + 2) * sizeof(int));
+    double* contribution = (double*)malloc(n * sizeof(double));
+    double* next = (double*)malloc(n * sizeof(double));
+    if (!partitionStart || !contribution || !next) exit(1);
+    int numPartitions = 0;
+    partitionStart[0] = 0;
+    for (int v = 0; v < n; v++) {
+        if (incoming->offsets[v + 1] - incoming->offsets[partitionStart[numPartitions]] >= PAGERANK_PARTITION_EDGES) {
+            partitionStart[++numPartitions] = v + 1;
+        }
+    }
+    if (partitionStart[numPartitions] < n) {
+        partitionStart[++numPartitions] = n;
+    }
+
+    for (int v = 0; v < n; v++) {
+        rank[v] = 1.0 / n;
+    }
+
+    int iteration = 0;
+    while (iteration < maxIterations) {
+        iteration++;
+
+        // Contribuição de cada usuário e rank dos usuários sem conexões
+        double danglingRank = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:danglingRank)
+        for (int u = 0; u < n; u++) {
+            int degree = csr->offsets[u + 1] - csr->offsets[u];
+            if (degree > 0) {
+                contribution[u] = rank[u] / degree;
+            } else {
+                contribution[u] = 0.0;
+                danglingRank += rank[u];
+            }
+        }
+
+        double base = (1.0 - damping) / n + damping * danglingRank / n;
+        double difference = 0.0;
+
+        // Pull: cada usuário lê as contribuições de quem aponta para ele (conexões de entrada)
+        #pragma omp parallel for schedule(dynamic, 1) reduction(+:difference)
+        for (int p = 0; p < numPartitions; p++) {
+            for (int v = partitionStart[p]; v < partitionStart[p + 1]; v++) {
+                double sum = 0.0;
+                for (int e = incoming->offsets[v]; e < incoming->offsets[v + 1]; e++) {
+                    sum += contribution[incoming->neighbors[e]];
+                }
+                next[v] = base + damping * sum;
+                difference += fabs(next[v] - rank[v]);
+            }
+        }
+
+        memcpy(rank, next, n * sizeof(double));
+        if (difference < tolerance) {
+            break;  // Convergiu
+        }
+    }
+
+    free(partitionStart);
+    free(contribution);
+    free(next);
+    return iteration;
+}
+
+// Função para criar o estado do PageRank personalizado
+// numUsers: Número de usuários do grafo
+PPRScratch* createPPRScratch(int numUsers) {
+    PPRScratch* scratch = (PPRScratch*)malloc(sizeof(PPRScratch));
+    if (!scratch) exit(1);  // Verificação de alocação de memória
+    scratch->numUsers = numUsers;
+    scratch->estimate = (double*)calloc(numUsers, sizeof(double));
+    scratch->residual = (double*)calloc(numUsers, sizeof(double));
+    scratch->inQueue = (bool*)calloc(numUsers, sizeof(bool));
+    scratch->queue = (int*)malloc(numUsers * sizeof(int));
+    scratch->touched = (int*)malloc(numUsers * sizeof(int));
+    if (!scratch->estimate || !scratch->residual || !scratch->inQueue || !scratch->queue || !scratch->touched) exit(1);
+    scratch->numTouched = 0;
+    return scratch;
+}
+
+// Função para liberar o estado do PageRank personalizado
+void freePPRScratch(PPRScratch* scratch) {
+    if (scratch != NULL) {
+        free(scratch->estimate);
+        free(scratch->residual);
+        free(scratch->inQueue);
+        free(scratch->queue);
+        free(scratch->touched);
+        free(scratch);
+    }
+}
+
+// Marca um usuário como tocado na primeira vez que recebe resíduo
+static void pprTouch(PPRScratch* scratch, int v) {
+    if (scratch->residual[v] == 0.0 && scratch->estimate[v] == 0.0) {
+        scratch->touched[scratch->numTouched++] = v;
+    }
+}
+
+// Função para calcular o PageRank personalizado aproximado de um usuário
+// graph: Ponteiro para o grafo
+// scratch: Estado reutilizável (criado com o mesmo número de usuários do grafo)
+// user: ID do usuário
+// alpha: Probabilidade de teletransporte de volta ao usuário (ex.: 0.15)
+// epsilon: Limite do resíduo por conexão (menor = mais preciso e mais lento)
+// maxResults: Número máximo de usuários retornados
+// result: Array de saída com capacidade para maxResults usuários, em ordem decrescente de pontuação
+// Retorna o número de usuários em result
+int personalizedPageRank(Graph* graph, PPRScratch* scratch, int user, double alpha, double epsilon, int maxResults, Recommendation* result) {
+    CSRGraph* csr = getCSR(graph);
+    int n = csr->numUsers;
+    int head = 0;
+    int size = 0;
+
+    scratch->numTouched = 0;
+    pprTouch(scratch, user);
+    scratch->residual[user] = 1.0;
+    scratch->queue[0] = user;
+    scratch->inQueue[user] = true;
+    size = 1;
+
+    while (size > 0) {
+        int u = scratch->queue[head];
+        head = (head + 1 == n) ? 0 : head + 1;
+        size--;
+        scratch->inQueue[u] = false;
+
+        double r = scratch->residual[u];
+        int degree = csr->offsets[u + 1] - csr->offsets[u];
+        scratch->residual[u] = 0.0;
+        if (degree == 0) {
+            scratch->estimate[u] += r;  // Sem vizinhos: todo o resíduo fica no próprio usuário
+            continue;
+        }
+        scratch->estimate[u] += alpha * r;
+
+        double share = (1.0 - alpha) * r / degree;
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            int v = csr->neighbors[e];
+            pprTouch(scratch, v);
+            scratch->residual[v] += share;
+            int degreeV = csr->offsets[v + 1] - csr->offsets[v];
+            if (!scratch->inQueue[v] && scratch->residual[v] >= epsilon * (degreeV > 0 ? degreeV : 1)) {
+                scratch->queue[(head + size) % n] = v;
+                scratch->inQueue[v] = true;
+                size++;
+            }
+        }
+    }
+
+    // Seleciona os maiores valores e limpa as posições tocadas
+    int count = 0;
+    for (int i = 0; i < scratch->numTouched; i++) {
+        int v = scratch->touched[i];
+        if (scratch->estimate[v] > 0.0 && maxResults > 0) {
+            Recommendation item = { v, scratch->estimate[v] };
+            recommendationPush(result, &count, maxResults, item);
+        }
+        scratch->estimate[v] = 0.0;
+        scratch->residual[v] = 0.0;
+    }
+    scratch->numTouched = 0;
+
+    recommendationSortHeap(result, count);
+    return count;
+}
+
+/*
+13-etapa: Detecção de comunidades (propagação de rótulos e Louvain)
+
+Descrição:
+- Uma comunidade é um grupo de usuários com muitas conexões internas e poucas externas. A qualidade de uma
+  partição é medida pela modularidade Q: a fração de arestas internas menos a fração esperada ao acaso.
+- Propagação de rótulos (rápida):
+  - Cada usuário começa com o próprio rótulo e repetidamente adota o rótulo mais frequente entre os vizinhos.
+  - A versão é assíncrona: as threads atualizam o array de rótulos no lugar, em ordem aleatória, e cada
+    atualização já é vista pelas próximas. Para com uma iteração sem mudanças.
+- Louvain (melhor modularidade):
+  - Fase 1: cada usuário vai para a comunidade vizinha que mais aumenta a modularidade. Os vértices são
+    processados em lotes pequenos: os destinos de um lote são calculados em paralelo e aplicados antes do
+    próximo lote. Para
+    evitar que dois usuários isolados troquem de comunidade indefinidamente, um usuário sozinho só entra em
+    outra comunidade de um usuário só se ela tiver ID menor.
+  - Fase 2: cada comunidade vira um vértice de um grafo ponderado agregado, e o processo se repete
+    enquanto a modularidade melhorar.
+- As duas funções retornam o array de comunidades (IDs de 0 a numCommunities - 1) e a modularidade.
+- A partição também pode ser usada como ordem de vértices: `communityOrdering` coloca os membros de cada
+  comunidade em posições contíguas e `reorderCSR` renumera o CSR nessa ordem, deixando os vizinhos de um
+  usuário próximos na memória.
+
+Funções:
+- `computeModularity`: Calcula a modularidade de uma partição.
+- `labelPropagationCommunities`: Detecta comunidades por propagação de rótulos.
+- `louvainCommunities`: Detecta comunidades pelo método de Louvain.
+- `communityOrdering`: Gera uma ordem de vértices agrupada por comunidade.
+- `reorderCSR`: Cria uma cópia do CSR com os vértices renumerados segundo uma ordem.
+*/
+
+// Ganho mínimo de modularidade para continuar o Louvain
+#define LOUVAIN_MIN_GAIN 1e-7
+// Número máximo de rodadas da fase 1 do Louvain em cada nível
+#define LOUVAIN_MAX_ROUNDS 32
+// Número de vértices cujos destinos são calculados em paralelo antes de serem aplicados
+// (lotes maiores paralelizam melhor, mas decidem com mais informação desatualizada)
+#define LOUVAIN_BATCH_SIZE 64
+
+// Grafo ponderado usado nos níveis do Louvain
+typedef struct LouvainGraph {
+    int numNodes;  // Número de vértices (comunidades do nível anterior)
+    int* offsets;  // Início da lista de cada vértice
+    int* targets;  // Vizinhos (sem laços)
+    double* weights;  // Peso de cada aresta
+    double* selfLoop;  // Peso interno de cada vértice (arestas internas contadas nas duas direções)
+    double* strength;  // Soma dos pesos incidentes (inclui selfLoop)
+    double totalWeight;  // Soma de todas as forças (2m)
+} LouvainGraph;
+
+// Renumera rótulos arbitrários (0 .. n - 1) para IDs consecutivos na ordem de aparição
+// Retorna o número de rótulos distintos
+static int compactLabels(int* labels, int n) {
+    int* map = (int*)malloc((n + 1) * sizeof(int));
+    if (!map) exit(1);
+    for (int i = 0; i < n; i++) {
+        map[i] = -1;
+    }
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (map[labels[i]] == -1) {
+            map[labels[i]] = count++;
+        }
+        labels[i] = map[labels[i]];
+    }
+    free(map);
+    return count;
+}
+
+// Função para calcular a modularidade de uma partição
+// graph: Ponteiro para o grafo
+// community: Comunidade de cada usuário (IDs de 0 a numUsers - 1)
+double computeModularity(Graph* graph, const int* community) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = csr->numUsers;
+    double totalDegree = csr->offsets[n];
+    if (totalDegree == 0.0) {
+        return 0.0;
+    }
+
+    double* communityDegree = (double*)calloc(n, sizeof(double));
+    if (!communityDegree) exit(1);
+    double internal = 0.0;
+    for (int v = 0; v < n; v++) {
+        communityDegree[community[v]] += csr->offsets[v + 1] - csr->offsets[v];
+        for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+            if (community[csr->neighbors[e]] == community[v]) internal += 1.0;
+        }
+    }
+
+    double expected = 0.0;
+    for (int c = 0; c < n; c++) {
+        expected += (communityDegree[c] / totalDegree) * (communityDegree[c] / totalDegree);
+    }
+    free(communityDegree);
+    return internal / totalDegree - expected;
+}
+
+// Função para detectar comunidades por propagação de rótulos assíncrona
+// graph: Ponteiro para o grafo
+// maxIterations: Número máximo de varreduras
+// seed: Semente da ordem aleatória das varreduras
+// community: Array de saída com a comunidade de cada usuário
+// numCommunities: Saída com o número de comunidades
+// Retorna a modularidade da partição
+double labelPropagationCommunities(Graph* graph, int maxIterations, unsigned long long seed, int* community, int* numCommunities) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = csr->numUsers;
+    int* order = (int*)malloc((n + 1) * sizeof(int));
+    if (!order) exit(1);
+    for (int v = 0; v < n; v++) {
+        community[v] = v;
+        order[v] = v;
+    }
+
+    unsigned long long state = seed;
+    for (int iteration = 0; iteration < maxIterations; iteration++) {
+        // Nova ordem aleatória a cada varredura
+        for (int i = n - 1; i > 0; i--) {
+            int j = (int)(splitMix64(&state) % (unsigned long long)(i + 1));
+            int tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+
+        int changed = 0;
+        #pragma omp parallel reduction(+:changed)
+        {
+            // Contador denso de rótulos por thread, limpo apenas nas posições tocadas
+            int* count = (int*)calloc(n, sizeof(int));
+            int* touched = (int*)malloc((n + 1) * sizeof(int));
+            if (!count || !touched) exit(1);
+
+            #pragma omp for schedule(dynamic, 256)
+            for (int i = 0; i < n; i++) {
+                int v = order[i];
+                if (csr->offsets[v] == csr->offsets[v + 1]) {
+                    continue;
+                }
+
+                int numTouched = 0;
+                for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                    int label;
+                    #pragma omp atomic read
+                    label = community[csr->neighbors[e]];
+                    if (count[label] == 0) touched[numTouched++] = label;
+                    count[label]++;
+                }
+
+                // Rótulo mais frequente; no empate mantém o atual ou escolhe o menor
+                int current;
+                #pragma omp atomic read
+                current = community[v];
+                int best = current;
+                int bestCount = count[current];
+                for (int t = 0; t < numTouched; t++) {
+                    int label = touched[t];
+                    if (count[label] > bestCount || (count[label] == bestCount && best != current && label < best)) {
+                        best = label;
+                        bestCount = count[label];
+                    }
+                }
+                for (int t = 0; t < numTouched; t++) {
+                    count[touched[t]] = 0;
+                }
+
+                if (best != current) {
+                    #pragma omp atomic write
+                    community[v] = best;
+                    changed++;
+                }
+            }
+
+            free(count);
+            free(touched);
+        }
+
+        if (changed == 0) {
+            break;
+        }
+    }
+
+    free(order);
+    *numCommunities = compactLabels(community, n);
+    return computeModularity(graph, community);
+}
+
+// Libera um grafo do Louvain
+static void freeLouvainGraph(LouvainGraph* lg) {
+    free(lg->offsets);
+    free(lg->targets);
+    free(lg->weights);
+    free(lg->selfLoop);
+    free(lg->strength);
+    free(lg);
+}
+
+// Cria o grafo do primeiro nível do Louvain (pesos 1) a partir do CSR
+static LouvainGraph* louvainGraphFromCSR(const CSRGraph* csr) {
+    int n = csr->numUsers;
+    int m = csr->offsets[n];
+    LouvainGraph* lg = (LouvainGraph*)malloc(sizeof(LouvainGraph));
+    if (!lg) exit(1);
+    lg->numNodes = n;
+    lg->offsets = (int*)malloc((n + 1) * sizeof(int));
+    lg->targets = (int*)malloc((m + 1) * sizeof(int));
+    lg->weights = (double*)malloc((m + 1) * sizeof(double));
+    lg->selfLoop = (double*)calloc(n + 1, sizeof(double));
+    lg->strength = (double*)malloc((n + 1) * sizeof(double));
+    if (!lg->offsets || !lg->targets || !lg->weights || !lg->selfLoop || !lg->strength) exit(1);
+
+    memcpy(lg->offsets, csr->offsets, (n + 1) * sizeof(int));
+    memcpy(lg->targets, csr->neighbors, m * sizeof(int));
+    for (int e = 0; e < m; e++) {
+        lg->weights[e] = 1.0;
+    }
+    for (int v = 0; v < n; v++) {
+        lg->strength[v] = csr->offsets[v + 1] - csr->offsets[v];
+    }
+    lg->totalWeight = m;
+    return lg;
+}
+
+// Calcula a modularidade de uma partição de um grafo do Louvain
+static double louvainModularity(const LouvainGraph* lg, const int* community, const double* communityTotal) {
+    if (lg->totalWeight == 0.0) {
+        return 0.0;
+    }
+    double internal = 0.0;
+    for (int v = 0; v < lg->numNodes; v++) {
+        internal += lg->selfLoop[v];
+        for (int e = lg->offsets[v]; e < lg->offsets[v + 1]; e++) {
+            if (community[lg->targets[e]] == community[v]) internal += lg->weights[e];
+        }
+    }
+    double expected = 0.0;
+    for (int c = 0; c < lg->numNodes; c++) {
+        double fraction = communityTotal[c] / lg->totalWeight;
+        expected += fraction * fraction;
+    }
+    return internal / lg->totalWeight - expected;
+}
+
+// Fase 1 do Louvain: move vértices entre comunidades enquanto a modularidade melhorar
+// Os vértices são processados em lotes: os destinos de um lote são calculados em paralelo e aplicados
+// antes do próximo lote, o que mantém a qualidade próxima da versão sequencial.
+// community: Saída com a comunidade de cada vértice do nível
+// Retorna a modularidade do nível ao final da fase
+static double louvainLocalMoving(const LouvainGraph* lg, int* community) {
+    int n = lg->numNodes;
+    double m2 = lg->totalWeight;
+    double* communityTotal = (double*)malloc((n + 1) * sizeof(double));
+    int* communitySize = (int*)malloc((n + 1) * sizeof(int));
+    int* target = (int*)malloc((n + 1) * sizeof(int));
+    if (!communityTotal || !communitySize || !target) exit(1);
+    for (int v = 0; v < n; v++) {
+        community[v] = v;
+        communityTotal[v] = lg->strength[v];
+        communitySize[v] = 1;
+    }
+
+    double modularity = louvainModularity(lg, community, communityTotal);
+    for (int round = 0; round < LOUVAIN_MAX_ROUNDS; round++) {
+        int moved = 0;
+
+        #pragma omp parallel
+        {
+            double* linkWeight = (double*)calloc(n, sizeof(double));
+            int* touched = (int*)malloc((n + 1) * sizeof(int));
+            if (!linkWeight || !touched) exit(1);
+
+            for (int batchStart = 0; batchStart < n; batchStart += LOUVAIN_BATCH_SIZE) {
+                int batchEnd = batchStart + LOUVAIN_BATCH_SIZE < n ? batchStart + LOUVAIN_BATCH_SIZE : n;
+
+                // Calcula o melhor destino de cada vértice do lote a partir do estado atual
+                #pragma omp for schedule(dynamic, 4)
+                for (int v = batchStart; v < batchEnd; v++) {
+                    int own = community[v];
+                    int numTouched = 0;
+                    for (int e = lg->offsets[v]; e < lg->offsets[v + 1]; e++) {
+                        int c = community[lg->targets[e]];
+                        if (linkWeight[c] == 0.0) touched[numTouched++] = c;
+                        linkWeight[c] += lg->weights[e];
+                    }
+
+                    // Ganho de inserir v (já removido da própria comunidade) em cada comunidade vizinha
+                    double kv = lg->strength[v];
+                    int best = own;
+                    double bestGain = linkWeight[own] - (communityTotal[own] - kv) * kv / m2;
+                    for (int t = 0; t < numTouched; t++) {
+                        int c = touched[t];
+                        if (c == own) continue;
+                        double gain = linkWeight[c] - communityTotal[c] * kv / m2;
+                        if (gain > bestGain || (gain == bestGain && best != own && c < best)) {
+                            best = c;
+                            bestGain = gain;
+                        }
+                    }
+                    for (int t = 0; t < numTouched; t++) {
+                        linkWeight[touched[t]] = 0.0;
+                    }
+
+                    // Um vértice sozinho só entra em outra comunidade de um vértice só se ela tiver ID menor
+                    if (best != own && communitySize[own] == 1 && communitySize[best] == 1 && best > own) {
+                        best = own;
+                    }
+                    target[v] = best;
+                }
+
+                // Aplica os movimentos do lote (a barreira implícita do `single` sincroniza as threads)
+                #pragma omp single
+                {
+                    for (int v = batchStart; v < batchEnd; v++) {
+                        if (target[v] != community[v]) {
+                            communityTotal[community[v]] -= lg->strength[v];
+                            communitySize[community[v]]--;
+                            communityTotal[target[v]] += lg->strength[v];
+                            communitySize[target[v]]++;
+                            community[v] = target[v];
+                            moved++;
+                        }
+                    }
+                }
+            }
+
+            free(linkWeight);
+            free(touched);
+        }
+
+        double updated = louvainModularity(lg, community, communityTotal);
+        bool converged = moved == 0 || updated - modularity < LOUVAIN_MIN_GAIN;
+        modularity = updated;
+        if (converged) {
+            break;
+        }
+    }
+
+    free(communityTotal);
+    free(communitySize);
+    free(target);
+    return modularity;
+}
+
+// Fase 2 do Louvain: agrega cada comunidade (IDs compactos 0 .. numCommunities - 1) em um vértice
+static LouvainGraph* louvainAggregate(const LouvainGraph* lg, const int* community, int numCommunities) {
+    int n = lg->numNodes;
+
+    // Agrupa os vértices por comunidade (ordenação por contagem)
+    int* memberStart = (int*)calloc(numCommunities + 1, sizeof(int));
+    int* members = (int*)malloc((n + 1) * sizeof(int));
+    int* degree = (int*)calloc(numCommunities + 1, sizeof(int));
+    if (!memberStart || !members || !degree) exit(1);
+    for (int v = 0; v < n; v++) {
+        memberStart[community[v] + 1]++;
+    }
+    for (int c = 0; c < numCommunities; c++) {
+        memberStart[c + 1] += memberStart[c];
+    }
+    int* fill = (int*)malloc((numCommunities + 1) * sizeof(int));
+    if (!fill) exit(1);
+    memcpy(fill, memberStart, numCommunities * sizeof(int));
+    for (int v = 0; v < n; v++) {
+        members[fill[community[v]]++] = v;
+    }
+
+    LouvainGraph* agg = (LouvainGraph*)malloc(sizeof(LouvainGraph));
+    if (!agg) exit(1);
+    agg->numNodes = numCommunities;
+    agg->offsets = (int*)malloc((numCommunities + 1) * sizeof(int));
+    agg->selfLoop = (double*)calloc(numCommunities + 1, sizeof(double));
+    agg->strength = (double*)calloc(numCommunities + 1, sizeof(double));
+    agg->totalWeight = lg->totalWeight;
+    if (!agg->offsets || !agg->selfLoop || !agg->strength) exit(1);
+
+    // Primeira passada: número de comunidades vizinhas distintas de cada comunidade
+    // Segunda passada: preenche as arestas agregadas
+    for (int pass = 0; pass < 2; pass++) {
+        #pragma omp parallel
+        {
+            double* linkWeight = (double*)calloc(numCommunities, sizeof(double));
+            int* touched = (int*)malloc((numCommunities + 1) * sizeof(int));
+            if (!linkWeight || !touched) exit(1);
+
+            #pragma omp for schedule(dynamic, 64)
+            for (int c = 0; c < numCommunities; c++) {
+                int numTouched = 0;
+                double internal = 0.0;
+                double strength = 0.0;
+                for (int i = memberStart[c]; i < memberStart[c + 1]; i++) {
+                    int v = members[i];
+                    internal += lg->selfLoop[v];
+                    strength += lg->strength[v];
+                    for (int e = lg->offsets[v]; e < lg->offsets[v + 1]; e++) {
+                        int d = community[lg->targets[e]];
+                        if (d == c) {
+                            internal += lg->weights[e];
+                            continue;
+                        }
+                        if (linkWeight[d] == 0.0) touched[numTouched++] = d;
+                        linkWeight[d] += lg->weights[e];
+                    }
+                }
+
+                if (pass == 0) {
+                    degree[c] = numTouched;
+                    agg->selfLoop[c] = internal;
+                    agg->strength[c] = strength;
+                } else {
+                    int pos = agg->offsets[c];
+                    for (int t = 0; t < numTouched; t++) {
+                        agg->targets[pos] = touched[t];
+                        agg->weights[pos] = linkWeight[touched[t]];
+                        pos++;
+                    }
+                }
+                for (int t = 0; t < numTouched; t++) {
+                    linkWeight[touched[t]] = 0.0;
+                }
+            }
+
+            free(linkWeight);
+            free(touched);
+        }
+
+        if (pass == 0) {
+            agg->offsets[0] = 0;
+            for (int c = 0; c < numCommunities; c++) {
+                agg->offsets[c + 1] = agg->offsets[c] + degree[c];
+            }
+            agg->targets = (int*)malloc((agg->offsets[numCommunities] + 1) * sizeof(int));
+            agg->weights = (double*)malloc((agg->offsets[numCommunities] + 1) * sizeof(double));
+            if (!agg->targets || !agg->weights) exit(1);
+        }
+    }
+
+    free(memberStart);
+    free(members);
+    free(degree);
+    free(fill);
+    return agg;
+}
+
+// Função para detectar comunidades pelo método de Louvain
+// graph: Ponteiro para o grafo
+// community: Array de saída com a comunidade de cada usuário
+// numCommunities: Saída com o número de comunidades
+// Retorna a modularidade da partição
+double louvainCommunities(Graph* graph, int* community, int* numCommunities) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = csr->numUsers;
+    LouvainGraph* level = louvainGraphFromCSR(csr);
+    int* levelCommunity = (int*)malloc((n + 1) * sizeof(int));
+    if (!levelCommunity) exit(1);
+
+    // community[v] guarda o vértice do nível atual que contém o usuário v
+    for (int v = 0; v < n; v++) {
+        community[v] = v;
+    }
+
+    double modularity = louvainModularity(level, community, level->strength);
+    while (true) {
+        double updated = louvainLocalMoving(level, levelCommunity);
+        int count = compactLabels(levelCommunity, level->numNodes);
+        if (count == level->numNodes || updated - modularity < LOUVAIN_MIN_GAIN) {
+            if (updated > modularity && count < level->numNodes) {
+                for (int v = 0; v < n; v++) {
+                    community[v] = levelCommunity[community[v]];
+                }
+                modularity = updated;
+            }
+            break;  // Nenhuma comunidade foi unida ou o ganho é desprezível
+        }
+
+        for (int v = 0; v < n; v++) {
+            community[v] = levelCommunity[community[v]];
+        }
+        modularity = updated;
+
+        LouvainGraph* next = louvainAggregate(level, levelCommunity, count);
+        freeLouvainGraph(level);
+        level = next;
+    }
+
+    freeLouvainGraph(level);
+    free(levelCommunity);
+    *numCommunities = compactLabels(community, n);
+    return modularity;
+}
+
+// Função para gerar uma ordem de vértices com os membros de cada comunidade em posições contíguas
+// community: Comunidade de cada usuário (IDs de 0 a numCommunities - 1)
+// numUsers: Número de usuários
+// numCommunities: Número de comunidades
+// order: Array de saída; order[i] é o usuário na posição i
+void communityOrdering(const int* community, int numUsers, int numCommunities, int* order) {
+    int* start = (int*)calloc(numCommunities + 1, sizeof(int));
+    if (!start) exit(1);
+    for (int v = 0; v < numUsers; v++) {
+        start[community[v] + 1]++;
+    }
+    for (int c = 0; c < numCommunities; c++) {
+        start[c + 1] += start[c];
+    }
+    for (int v = 0; v < numUsers; v++) {
+        order[start[community[v]]++] = v;
+    }
+    free(start);
+}
+
+// Função para criar uma cópia do CSR com os vértices renumerados
+// csr: CSR original
+// order: order[i] é o vértice original que passa a ter o ID i
+CSRGraph* reorderCSR(const CSRGraph* csr, const int* order) {
+    int n = csr->numUsers;
+    int* position = (int*)malloc((n + 1) * sizeof(int));
+    if (!position) exit(1);
+    for (int i = 0; i < n; i++) {
+        position[order[i]] = i;
+    }
+
+    CSRGraph* reordered = (CSRGraph*)malloc(sizeof(CSRGraph));
+    if (!reordered) exit(1);
+    reordered->numUsers = n;
+    reordered->offsets = (int*)malloc((n + 1) * sizeof(int));
+    reordered->neighbors = (int*)malloc((csr->offsets[n] + 1) * sizeof(int));
+    reordered->weights = NULL;
+    if (!reordered->offsets || !reordered->neighbors) exit(1);
+
+    reordered->offsets[0] = 0;
+    for (int i = 0; i < n; i++) {
+        int v = order[i];
+        int degree = csr->offsets[v + 1] - csr->offsets[v];
+        reordered->offsets[i + 1] = reordered->offsets[i] + degree;
+        for (int e = 0; e < degree; e++) {
+            reordered->neighbors[reordered->offsets[i] + e] = position[csr->neighbors[csr->offsets[v] + e]];
+        }
+        qsort(reordered->neighbors + reordered->offsets[i], degree, sizeof(int), compareInts);
+    }
+
+    free(position);
+    return reordered;
+}
+
+/*
+14-etapa: Decomposição em k-cores
+
+Descrição:
+- O k-core é o maior subgrafo em que todo usuário tem pelo menos k conexões. O número de core de um usuário
+  é o maior k tal que ele pertence ao k-core. Contas de spam costumam ter core baixo, e o core máximo é um
+  bom conjunto de candidatos a landmarks.
+- Os graus iniciais vêm do array `degree` mantido por `addConnection`, sem percorrer as listas de adjacência.
+  No modo de seguidores (24-etapa) os graus vêm dos offsets do CSR simétrico (`getUndirectedCSR`), já que
+  `degree` só conta as conexões de saída.
+- Versão sequencial (Batagelj-Zaversnik, O(E)): os usuários ficam em baldes por grau. O usuário de menor grau
+  é removido e os seus vizinhos descem um balde, com trocas O(1) dentro do array ordenado.
+- Versão paralela (remoção por níveis): para k = 0, 1, 2, ..., remove em paralelo todos os usuários com grau
+  <= k. Os vizinhos têm o grau decrementado atomicamente, e quem cai para k entra na próxima onda do
+  mesmo nível.
+- `extractMaxCore` retorna o subgrafo induzido pelo core máximo (com o `extractInducedSubgraph` da 9-etapa).
+
+Funções:
+- `coreDecomposition`: Calcula o número de core de cada usuário (sequencial).
+- `parallelCoreDecomposition`: Calcula o número de core de cada usuário (paralela).
+- `extractMaxCore`: Constrói o subgrafo induzido pelo core máximo.
+*/
+
+// Função para calcular o número de core de cada usuário (algoritmo de Batagelj-Zaversnik)
+// graph: Ponteiro para o grafo
+// core: Array de saída com o número de core de cada usuário
+// Retorna o maior número de core
+int coreDecomposition(Graph* graph, int* core) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = graph->numUsers;
+    int maxDegree = 0;
+    for (int v = 0; v < n; v++) {
+        core[v] = graph->directed ? csr->offsets[v + 1] - csr->offsets[v] : graph->degree[v];
+        if (core[v] > maxDegree) maxDegree = core[v];
+    }
+
+    // bin[d]: início do balde de grau d no array vert, ordenado por grau
+    int* bin = (int*)calloc(maxDegree + 2, sizeof(int));
+    int* vert = (int*)malloc((n + 1) * sizeof(int));
+    int* pos = (int*)malloc((n + 1) * sizeof(int));
+    if (!bin || !vert || !pos) exit(1);
+    for (int v = 0; v < n; v++) {
+        bin[core[v] + 1]++;
+    }
+    for (int d = 0; d <= maxDegree; d++) {
+        bin[d + 1] += bin[d];
+    }
+    for (int v = 0; v < n; v++) {
+        pos[v] = bin[core[v]]++;
+        vert[pos[v]] = v;
+    }
+    for (int d = maxDegree; d > 0; d--) {
+        bin[d] = bin[d - 1];
+    }
+    bin[0] = 0;
+
+    // Remove os usuários em ordem de grau; cada vizinho com grau maior desce um balde
+    int maxCore = 0;
+    for (int i = 0; i < n; i++) {
+        int v = vert[i];
+        if (core[v] > maxCore) maxCore = core[v];
+        for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+            int u = csr->neighbors[e];
+            if (core[u] > core[v]) {
+                // Troca u com o primeiro usuário do seu balde e encolhe o balde
+                int du = core[u];
+                int pu = pos[u];
+                int pw = bin[du];
+                int w = vert[pw];
+                if (u != w) {
+                    pos[u] = pw;
+                    vert[pu] = w;
+                    pos[w] = pu;
+                    vert[pw] = u;
+                }
+                bin[du]++;
+                core[u]--;
+            }
+        }
+    }
+
+    free(bin);
+    free(vert);
+    free(pos);
+    return maxCore;
+}
+
+// Função para calcular o número de core de cada usuário com remoção paralela por níveis
+// graph: Ponteiro para o grafo
+// core: Array de saída com o número de core de cada usuário
+// Retorna o maior número de core
+int parallelCoreDecomposition(Graph* graph, int* core) {
+    CSRGraph* csr = getUndirectedCSR(graph);
+    int n = graph->numUsers;
+    int* degree = (int*)malloc((n + 1) * sizeof(int));
+    int* alive = (int*)malloc((n + 1) * sizeof(int));
+    int* frontier = (int*)malloc((n + 1) * sizeof(int));
+    int* next = (int*)malloc((n + 1) * sizeof(int));
+    bool* removed = (bool*)calloc(n + 1, sizeof(bool));
+    if (!degree || !alive || !frontier || !next || !removed) exit(1);
+    for (int v = 0; v < n; v++) {
+        degree[v] = graph->directed ? csr->offsets[v + 1] - csr->offsets[v] : graph->degree[v];
+        alive[v] = v;
+    }
+
+    int numAlive = n;
+    int k = 0;
+    int maxCore = 0;
+    while (numAlive > 0) {
+        // Usuários ainda presentes com grau <= k formam a primeira onda do nível
+        int frontierSize = 0;
+        int minDegree = INT_MAX;
+        #pragma omp parallel for schedule(static) reduction(min:minDegree)
+        for (int i = 0; i < numAlive; i++) {
+            int v = alive[i];
+            if (degree[v] <= k) {
+                int slot;
+                #pragma omp atomic capture
+                slot = frontierSize++;
+                frontier[slot] = v;
+                removed[v] = true;
+                core[v] = k;
+            } else if (degree[v] < minDegree) {
+                minDegree = degree[v];
+            }
+        }
+
+        if (frontierSize == 0) {
+            k = minDegree;  // Pula os níveis vazios
+            continue;
+        }
+        maxCore = k;
+
+        // Remove as ondas do nível k até que nenhum vizinho caia para k
+        while (frontierSize > 0) {
+            int nextSize = 0;
+            #pragma omp parallel for schedule(dynamic, 64)
+            for (int i = 0; i < frontierSize; i++) {
+                int v = frontier[i];
+                for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                    int u = csr->neighbors[e];
+                    bool isRemoved;
+                    #pragma omp atomic read
+                    isRemoved = removed[u];
+                    if (isRemoved) {
+                        continue;
+                    }
+                    int previous;
+                    #pragma omp atomic capture
+                    previous = degree[u]--;
+                    if (previous == k + 1) {
+                        // Apenas a thread que levou o grau de k + 1 para k remove o vizinho
+                        int slot;
+                        #pragma omp atomic capture
+                        slot = nextSize++;
+                        next[slot] = u;
+                        #pragma omp atomic write
+                        removed[u] = true;
+                        core[u] = k;
+                    }
+                }
+            }
+
+            int* tmp = frontier;
+            frontier = next;
+            next = tmp;
+            frontierSize = nextSize;
+        }
+
+        // Compacta a lista de usuários ainda presentes
+        int kept = 0;
+        for (int i = 0; i < numAlive; i++) {
+            if (!removed[alive[i]]) alive[kept++] = alive[i];
+        }
+        numAlive = kept;
+        k++;
+    }
+
+    free(degree);
+    free(alive);
+    free(frontier);
+    free(next);
+    free(removed);
+    return maxCore;
+}
+
+// Função para construir o subgrafo induzido pelo core máximo
+// graph: Ponteiro para o grafo
+// scratch: Estado de BFS usado na extração
+// members: Saída com o array (alocado) dos IDs dos usuários do core máximo; o vértice local i é members[i]
+// count: Saída com o número de usuários do core máximo
+CSRGraph* extractMaxCore(Graph* graph, BFSScratch* scratch, int** members, int* count) {
+    int n = graph->numUsers;
+    int* core = (int*)malloc((n + 1) * sizeof(int));
+    int* selected = (int*)malloc((n + 1) * sizeof(int));
+    if (!core || !selected) exit(1);
+
+    int maxCore = coreDecomposition(graph, core);
+    int size = 0;
+    for (int v = 0; v < n; v++) {
+        if (core[v] == maxCore) selected[size++] = v;
+    }
+    free(core);
+
+    *members = selected;
+    *count = size;
+    return extractInducedSubgraph(graph, scratch, selected, size);
+}
+
+/*
+15-etapa: Remoção de conexões, adjacência dinâmica e cache incremental de menores caminhos
+
+Descrição:
+- `removeConnection` desfaz uma conexão nas duas listas de adjacência e atualiza os graus.
+- Toda mudança (inserção ou remoção) passa por `graphChanged`, que:
+  - descarta o CSR em cache;
+  - atualiza o CSR com folga, se estiver habilitado;
+  - invalida apenas as entradas afetadas do cache de menores caminhos, se houver um;
+  - grava a mudança no log de conexões, se houver um (17-etapa).
+- CSR com folga (`SlackCSR`): cada usuário tem um bloco com espaço livre no final, e os vizinhos continuam
+  ordenados dentro do bloco. Inserções e remoções deslocam apenas o bloco do usuário. Quando um bloco
+  enche, ele é movido para o fim do array com o dobro da capacidade. Quando o espaço desperdiçado passa da
+  metade, o array é compactado. Com ele habilitado, `getCSR` monta o CSR copiando os blocos (sem ordenar)
+  e as consultas do cache percorrem os blocos diretamente, sem reconstruir nada.
+- Cache de menores caminhos: tabela de mapeamento direto indexada pelo par (origem, destino). Cada entrada
+  guarda o caminho e o conjunto de usuários a distância <= d - 2 da origem (as camadas da BFS que poderiam
+  ser atalhadas):
+  - Uma nova conexão (u, v) só pode encurtar o caminho se u ou v estiver nesse conjunto, porque o novo
+    caminho teria comprimento dist(origem, u) + 1 + dist(v, destino).
+  - Uma remoção só invalida entradas cujo caminho usa a conexão removida, pois remover não encurta
+    distâncias.
+  - As demais entradas continuam válidas e a consulta repetida custa O(1) mais a cópia do caminho.
+- Índice por usuário: o conjunto de cada entrada não é guardado na entrada, e sim como referências nas listas
+  dos seus usuários (`ballRefs`), assim como os usuários do caminho (`pathRefs`). Uma mudança em (u, v) só
+  percorre as listas de u e de v, sem varrer a tabela. Cada referência leva o carimbo da entrada, incrementado
+  quando ela é invalidada ou substituída; referências com carimbo antigo são descartadas ao serem
+  encontradas, e o índice inteiro é compactado quando elas passam das referências válidas.
+
+Funções:
+- `removeConnection`: Remove uma conexão entre dois usuários.
+- `enableDynamicAdjacency`: Habilita o CSR com folga no grafo.
+- `bfsShortestPathView`: BFS de menor caminho sobre blocos de adjacência ordenados (CSR ou CSR com folga).
+- `createShortestPathCache`: Cria e associa ao grafo um cache de menores caminhos.
+- `cachedShortestPath`: Consulta o menor caminho usando o cache.
+- `freeShortestPathCache`: Desassocia e libera o cache.
+*/
+
+// Tamanho mínimo do bloco de cada usuário no CSR com folga
+#define SLACK_MIN_CAPACITY 4
+// Maior conjunto de usuários guardado por entrada do cache (acima disso qualquer inserção invalida a entrada)
+#define PATH_CACHE_MAX_BALL 4096
+
+// Estrutura para representar a adjacência em CSR com folga
+// Os vizinhos do usuário v ficam em neighbors[start[v]] .. neighbors[end[v] - 1], ordenados por ID,
+// e o bloco tem espaço até neighbors[limit[v] - 1].
+typedef struct SlackCSR {
+    int numUsers;  // Número de usuários (nós)
+    int* start;  // Início do bloco de cada usuário
+    int* end;  // Fim dos vizinhos em uso de cada usuário
+    int* limit;  // Fim do bloco de cada usuário
+    int* neighbors;  // Array com todos os blocos
+    int used;  // Posições ocupadas por blocos (fim do último bloco)
+    int allocated;  // Tamanho do array neighbors
+    int numEntries;  // Total de vizinhos em uso
+} SlackCSR;
+
+// Estrutura para representar uma entrada do cache de menores caminhos
+typedef struct CachedPath {
+    bool valid;  // true se a entrada pode ser usada
+    unsigned int stamp;  // Incrementado quando a entrada é invalidada ou substituída
+    int source;  // ID do usuário de origem
+    int target;  // ID do usuário de destino
+    int distance;  // Distância (-1 se não há caminho)
+    int* path;  // Caminho da origem ao destino (distance + 1 usuários)
+    int ballSize;  // Usuários a distância <= distance - 2 da origem (componente inteiro se não há caminho);
+                   // -1: conjunto grande demais, qualquer inserção invalida
+} CachedPath;
+
+// Estrutura para representar uma referência do índice a uma entrada do cache
+typedef struct PathCacheRef {
+    int slot;  // Posição da entrada na tabela
+    unsigned int stamp;  // Carimbo da entrada quando a referência foi criada (diferente: referência vencida)
+} PathCacheRef;
+
+// Estrutura para representar uma lista de referências do índice
+typedef struct PathCacheRefs {
+    PathCacheRef* items;  // Referências
+    int count;  // Número de referências
+    int capacity;  // Capacidade de items
+} PathCacheRefs;
+
+// Estrutura para representar o cache de menores caminhos
+typedef struct ShortestPathCache {
+    int capacity;  // Número de entradas (potência de 2)
+    CachedPath* entries;  // Tabela de mapeamento direto
+    int numUsers;  // Número de usuários do grafo
+    PathCacheRefs* ballRefs;  // ballRefs[u]: entradas cujo conjunto de camadas contém u
+    PathCacheRefs* pathRefs;  // pathRefs[u]: entradas cujo caminho passa por u
+    PathCacheRefs largeBalls;  // Entradas com conjunto grande demais
+    long long storedRefs;  // Referências guardadas no índice (incluindo as vencidas)
+    long long liveRefs;  // Referências de entradas válidas
+    BFSScratch* scratch;  // Estado de BFS usado nas consultas que não estão no cache
+    long long hits;  // Consultas respondidas pelo cache
+    long long misses;  // Consultas que exigiram uma BFS
+    long long invalidations;  // Entradas invalidadas por mudanças no grafo
+} ShortestPathCache;
+
+// Compacta os blocos no início do array, deixando folga proporcional ao grau de cada usuário
+static void slackCompact(SlackCSR* slack) {
+    int total = 0;
+    for (int v = 0; v < slack->numUsers; v++) {
+        int size = slack->end[v] - slack->start[v];
+        int capacity = size + size / 2;
+        total += capacity > SLACK_MIN_CAPACITY ? capacity : SLACK_MIN_CAPACITY;
+    }
+
+    int* neighbors = (int*)malloc((total + 1) * sizeof(int));
+    if (!neighbors) exit(1);
+    int pos = 0;
+    for (int v = 0; v < slack->numUsers; v++) {
+        int size = slack->end[v] - slack->start[v];
+        int capacity = size + size / 2;
+        if (capacity < SLACK_MIN_CAPACITY) capacity = SLACK_MIN_CAPACITY;
+        memcpy(neighbors + pos, slack->neighbors + slack->start[v], size * sizeof(int));
+        slack->start[v] = pos;
+        slack->end[v] = pos + size;
+        slack->limit[v] = pos + capacity;
+        pos += capacity;
+    }
+
+    free(slack->neighbors);
+    slack->neighbors = neighbors;
+    slack->used = pos;
+    slack->allocated = total + 1;
+}
+
+// Garante espaço para mais um vizinho no bloco de v, movendo o bloco para o fim do array se necessário
+static void slackReserve(SlackCSR* slack, int v) {
+    if (slack->end[v] < slack->limit[v]) {
+        return;
+    }
+
+    // Muito espaço desperdiçado: compactar já cria a folga necessária
+    if (slack->used - slack->numEntries > slack->numEntries + SLACK_MIN_CAPACITY * slack->numUsers) {
+        slackCompact(slack);
+        if (slack->end[v] < slack->limit[v]) {
+            return;
+        }
+    }
+
+    int size = slack->end[v] - slack->start[v];
+    int capacity = 2 * size > SLACK_MIN_CAPACITY ? 2 * size : SLACK_MIN_CAPACITY;
+    if (slack->used + capacity > slack->allocated) {
+        int allocated = 2 * slack->allocated + capacity;
+        int* neighbors = (int*)realloc(slack->neighbors, allocated * sizeof(int));
+        if (!neighbors) exit(1);
+        slack->neighbors = neighbors;
+        slack->allocated = allocated;
+    }
+    memcpy(slack->neighbors + slack->used, slack->neighbors + slack->start[v], size * sizeof(int));
+    slack->start[v] = slack->used;
+    slack->end[v] = slack->used + size;
+    slack->limit[v] = slack->used + capacity;
+    slack->used += capacity;
+}
+
+// Retorna a posição do primeiro vizinho >= u no bloco de v
+static int slackLowerBound(const SlackCSR* slack, int v, int u) {
+    int lo = slack->start[v];
+    int hi = slack->end[v];
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (slack->neighbors[mid] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Insere u na lista ordenada de v
+static void slackInsert(SlackCSR* slack, int v, int u) {
+    slackReserve(slack, v);
+    int pos = slackLowerBound(slack, v, u);
+    memmove(slack->neighbors + pos + 1, slack->neighbors + pos, (slack->end[v] - pos) * sizeof(int));
+    slack->neighbors[pos] = u;
+    slack->end[v]++;
+    slack->numEntries++;
+}
+
+// Remove u da lista ordenada de v
+static void slackRemove(SlackCSR* slack, int v, int u) {
+    int pos = slackLowerBound(slack, v, u);
+    if (pos < slack->end[v] && slack->neighbors[pos] == u) {
+        memmove(slack->neighbors + pos, slack->neighbors + pos + 1, (slack->end[v] - pos - 1) * sizeof(int));
+        slack->end[v]--;
+        slack->numEntries--;
+    }
+}
+
+// Monta um CSR compacto a partir do CSR com folga (os blocos já estão ordenados)
+CSRGraph* buildCSRFromSlack(const SlackCSR* slack) {
+    CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+    if (!csr) exit(1);
+    csr->numUsers = slack->numUsers;
+    csr->offsets = (int*)malloc((slack->numUsers + 1) * sizeof(int));
+    csr->neighbors = (int*)malloc((slack->numEntries + 1) * sizeof(int));
+    csr->weights = NULL;
+    if (!csr->offsets || !csr->neighbors) exit(1);
+
+    csr->offsets[0] = 0;
+    for (int v = 0; v < slack->numUsers; v++) {
+        int size = slack->end[v] - slack->start[v];
+        memcpy(csr->neighbors + csr->offsets[v], slack->neighbors + slack->start[v], size * sizeof(int));
+        csr->offsets[v + 1] = csr->offsets[v] + size;
+    }
+    return csr;
+}
+
+// Libera o CSR com folga
+void freeSlackCSR(SlackCSR* slack) {
+    if (slack != NULL) {
+        free(slack->start);
+        free(slack->end);
+        free(slack->limit);
+        free(slack->neighbors);
+        free(slack);
+    }
+}
+
+// Função para habilitar o CSR com folga no grafo
+// A partir daqui inserções e remoções atualizam os blocos no lugar.
+// graph: Ponteiro para o grafo
+void enableDynamicAdjacency(Graph* graph) {
+    if (graph->slack) {
+        return;
+    }
+    CSRGraph* csr = getCSR(graph);
+    SlackCSR* slack = (SlackCSR*)malloc(sizeof(SlackCSR));
+    if (!slack) exit(1);
+    slack->numUsers = graph->numUsers;
+    slack->start = (int*)malloc((graph->numUsers + 1) * sizeof(int));
+    slack->end = (int*)malloc((graph->numUsers + 1) * sizeof(int));
+    slack->limit = (int*)malloc((graph->numUsers + 1) * sizeof(int));
+    if (!slack->start || !slack->end || !slack->limit) exit(1);
+
+    // Copia as listas do CSR; a compactação cria a folga de cada bloco
+    slack->numEntries = csr->offsets[graph->numUsers];
+    slack->neighbors = (int*)malloc((slack->numEntries + 1) * sizeof(int));
+    if (!slack->neighbors) exit(1);
+    memcpy(slack->neighbors, csr->neighbors, slack->numEntries * sizeof(int));
+    for (int v = 0; v < graph->numUsers; v++) {
+        slack->start[v] = csr->offsets[v];
+        slack->end[v] = csr->offsets[v + 1];
+        slack->limit[v] = csr->offsets[v + 1];
+    }
+    slackCompact(slack);
+
+    graph->slack = slack;
+}
+
+// Função para obter os blocos de adjacência ordenados do grafo
+// Usa o CSR com folga quando habilitado (sem reconstrução) e o CSR em cache caso contrário.
+static void graphAdjacency(Graph* graph, const int** begin, const int** end, const int** neighbors) {
+    if (graph->slack) {
+        *begin = graph->slack->start;
+        *end = graph->slack->end;
+        *neighbors = graph->slack->neighbors;
+    } else {
+        CSRGraph* csr = getCSR(graph);
+        *begin = csr->offsets;
+        *end = csr->offsets + 1;
+        *neighbors = csr->neighbors;
+    }
+}
+
+// Função de BFS de menor caminho sobre blocos de adjacência
+// Os vizinhos de v ficam em neighbors[begin[v]] .. neighbors[end[v] - 1] (para um CSR, end = offsets + 1).
+// scratch: Estado de BFS; ao final, predecessor e distance valem para os usuários com o carimbo atual
+// Retorna a distância até target (-1 se não há caminho); *visitedCount recebe o tamanho da fila
+int bfsShortestPathView(const int* begin, const int* end, const int* neighbors, BFSScratch* scratch,
+                        int source, int target, int* visitedCount) {
+    bfsScratchReset(scratch);
+    int visitedStamp = scratch->currentStamp;
+    scratch->stamp[source] = visitedStamp;
+    scratch->distance[source] = 0;
+    scratch->predecessor[source] = -1;
+    scratch->queue[0] = source;
+    int head = 0;
+    int tail = 1;
+    int found = source == target ? 0 : -1;
+
+    while (head < tail && found == -1) {
+        int u = scratch->queue[head++];
+        INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, end[u] - begin[u]);
+        for (int e = begin[u]; e < end[u]; e++) {
+            int v = neighbors[e];
+            if (scratch->stamp[v] != visitedStamp) {
+                scratch->stamp[v] = visitedStamp;
+                scratch->distance[v] = scratch->distance[u] + 1;
+                scratch->predecessor[v] = u;
+                scratch->queue[tail++] = v;
+                if (v == target) {
+                    found = scratch->distance[v];
+                    break;
+                }
+            }
+        }
+    }
+
+    INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, head);
+    if (visitedCount) *visitedCount = tail;
+    return found;
+}
+
+// Reconstrói em path o caminho até target a partir dos predecessores do scratch
+// Retorna o número de usuários no caminho
+static int bfsReconstructPath(const BFSScratch* scratch, int target, int* path) {
+    int length = scratch->distance[target] + 1;
+    int crawl = target;
+    for (int i = length - 1; i >= 0; i--) {
+        path[i] = crawl;
+        crawl = scratch->predecessor[crawl];
+    }
+    return length;
+}
+
+// Retorna true se o caminho da entrada usa a conexão (u, v) em qualquer sentido
+static bool cachedPathUsesConnection(const CachedPath* entry, int u, int v) {
+    for (int i = 0; i < entry->distance; i++) {
+        int a = entry->path[i];
+        int b = entry->path[i + 1];
+        if ((a == u && b == v) || (a == v && b == u)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Número de referências que uma entrada válida tem no índice
+static long long pathCacheEntryRefs(const CachedPath* entry) {
+    return (entry->ballSize < 0 ? 1 : entry->ballSize) + (entry->distance >= 0 ? entry->distance + 1 : 0);
+}
+
+// Acrescenta ao índice uma referência à entrada slot
+static void pathCacheRefPush(ShortestPathCache* cache, PathCacheRefs* refs, int slot) {
+    if (refs->count == refs->capacity) {
+        refs->capacity = refs->capacity ? 2 * refs->capacity : 4;
+        refs->items = (PathCacheRef*)realloc(refs->items, refs->capacity * sizeof(PathCacheRef));
+        if (!refs->items) exit(1);  // Verificação de alocação de memória
+    }
+    PathCacheRef ref = { slot, cache->entries[slot].stamp };
+    refs->items[refs->count++] = ref;
+    cache->storedRefs++;
+}
+
+// Retorna true se a referência aponta para a entrada válida que a criou
+static bool pathCacheRefLive(const ShortestPathCache* cache, PathCacheRef ref) {
+    const CachedPath* entry = &cache->entries[ref.slot];
+    return entry->valid && entry->stamp == ref.stamp;
+}
+
+// Invalida uma entrada; as suas referências no índice passam a ser vencidas
+static void pathCacheInvalidate(ShortestPathCache* cache, int slot) {
+    CachedPath* entry = &cache->entries[slot];
+    if (entry->valid) {
+        cache->liveRefs -= pathCacheEntryRefs(entry);
+        entry->valid = false;
+    }
+    entry->stamp++;
+}
+
+// Descarta as referências vencidas de uma lista do índice
+static void pathCacheRefsCompact(ShortestPathCache* cache, PathCacheRefs* refs) {
+    int kept = 0;
+    for (int i = 0; i < refs->count; i++) {
+        if (pathCacheRefLive(cache, refs->items[i])) refs->items[kept++] = refs->items[i];
+    }
+    cache->storedRefs -= refs->count - kept;
+    refs->count = kept;
+}
+
+// Compacta o índice inteiro quando as referências vencidas passam das válidas
+static void pathCacheMaybeCompact(ShortestPathCache* cache) {
+    if (cache->storedRefs <= 2 * cache->liveRefs + cache->capacity) {
+        return;
+    }
+    for (int u = 0; u < cache->numUsers; u++) {
+        pathCacheRefsCompact(cache, &cache->ballRefs[u]);
+        pathCacheRefsCompact(cache, &cache->pathRefs[u]);
+    }
+    pathCacheRefsCompact(cache, &cache->largeBalls);
+}
+
+// Invalida as entradas do cache afetadas pela inserção ou remoção da conexão (src, dest)
+// Só percorre as listas do índice de src e dest (e as entradas com conjunto grande demais, nas inserções).
+static void pathCacheConnectionChanged(ShortestPathCache* cache, int src, int dest, bool added) {
+    if (added) {
+        // Toda entrada válida cujo conjunto contém src ou dest é afetada; as listas ficam vazias
+        PathCacheRefs* lists[3] = { &cache->ballRefs[src], &cache->ballRefs[dest], &cache->largeBalls };
+        for (int l = 0; l < 3; l++) {
+            PathCacheRefs* refs = lists[l];
+            for (int i = 0; i < refs->count; i++) {
+                if (pathCacheRefLive(cache, refs->items[i])) {
+                    pathCacheInvalidate(cache, refs->items[i].slot);
+                    cache->invalidations++;
+                }
+            }
+            cache->storedRefs -= refs->count;
+            refs->count = 0;
+        }
+    } else {
+        // O caminho que usa a conexão passa pelos dois usuários: basta a lista menor
+        PathCacheRefs* refs = cache->pathRefs[src].count <= cache->pathRefs[dest].count ? &cache->pathRefs[src]
+                                                                                         : &cache->pathRefs[dest];
+        int kept = 0;
+        for (int i = 0; i < refs->count; i++) {
+            PathCacheRef ref = refs->items[i];
+            if (!pathCacheRefLive(cache, ref)) {
+                continue;
+            }
+            const CachedPath* entry = &cache->entries[ref.slot];
+            if (entry->distance > 0 && cachedPathUsesConnection(entry, src, dest)) {
+                pathCacheInvalidate(cache, ref.slot);
+                cache->invalidations++;
+                continue;
+            }
+            refs->items[kept++] = ref;
+        }
+        cache->storedRefs -= refs->count - kept;
+        refs->count = kept;
+    }
+    pathCacheMaybeCompact(cache);
+}
+
+// Função chamada a cada conexão inserida ou removida no grafo
+// graph: Ponteiro para o grafo
+// src, dest: IDs dos usuários da conexão
+// added: true para inserção, false para remoção
+void graphChanged(Graph* graph, int src, int dest, bool added) {
+    graph->version++;
+
+    // O CSR em cache deixa de refletir o grafo
+    if (graph->csr) {
+        freeCSR(graph->csr);
+        graph->csr = NULL;
+    }
+    if (graph->reverseCSR) {
+        freeCSR(graph->reverseCSR);
+        graph->reverseCSR = NULL;
+    }
+    if (graph->undirectedCSR) {
+        freeCSR(graph->undirectedCSR);
+        graph->undirectedCSR = NULL;
+    }
+
+    // Em um grafo direcionado, cada seguida muda só a lista de saída de src
+    if (graph->slack) {
+        if (added) {
+            slackInsert(graph->slack, src, dest);
+            if (!graph->directed) slackInsert(graph->slack, dest, src);
+        } else {
+            slackRemove(graph->slack, src, dest);
+            if (!graph->directed) slackRemove(graph->slack, dest, src);
+        }
+    }
+
+    if (graph->pathCache) {
+        pathCacheConnectionChanged(graph->pathCache, src, dest, added);
+    }
+
+    if (graph->edgeLog) {
+        edgeLogAppend(graph->edgeLog, src, dest, added);
+    }
+}
+
+// Função para remover uma conexão (aresta) entre dois usuários
+// graph: Ponteiro para o grafo
+// src: ID do usuário de origem
+// dest: ID do usuário de destino
+// Retorna true se a conexão existia e foi removida
+bool removeConnection(Graph* graph, int src, int dest) {
+    if (graph->directed) {
+        bool removed = removeFollow(graph, src, dest);
+        return removeFollow(graph, dest, src) || removed;
+    }
+
+    // Remove dest da lista de src e src da lista de dest
+    int ends[2][2] = { { src, dest }, { dest, src } };
+    bool removed = false;
+    for (int i = 0; i < 2; i++) {
+        AdjacencyNode** link = &graph->adjList[ends[i][0]];
+        while (*link) {
+            if ((*link)->user->id == ends[i][1]) {
+                AdjacencyNode* toDelete = *link;
+                *link = toDelete->next;
+                free(toDelete);
+                removed = true;
+                break;
+            }
+            link = &(*link)->next;
+        }
+    }
+    if (!removed) {
+        return false;
+    }
+
+    graph->degree[src]--;
+    graph->degree[dest]--;
+    graphChanged(graph, src, dest, false);
+    return true;
+}
+
+// Função para criar um cache de menores caminhos associado ao grafo
+// graph: Ponteiro para o grafo
+// capacity: Número de entradas (arredondado para potência de 2)
+ShortestPathCache* createShortestPathCache(Graph* graph, int capacity) {
+    int size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    ShortestPathCache* cache = (ShortestPathCache*)malloc(sizeof(ShortestPathCache));
+    if (!cache) exit(1);  // Verificação de alocação de memória
+    cache->capacity = size;
+    cache->entries = (CachedPath*)calloc(size, sizeof(CachedPath));
+    cache->numUsers = graph->numUsers;
+    cache->ballRefs = (PathCacheRefs*)calloc(graph->numUsers > 0 ? graph->numUsers : 1, sizeof(PathCacheRefs));
+    cache->pathRefs = (PathCacheRefs*)calloc(graph->numUsers > 0 ? graph->numUsers : 1, sizeof(PathCacheRefs));
+    if (!cache->entries || !cache->ballRefs || !cache->pathRefs) exit(1);
+    cache->largeBalls.items = NULL;
+    cache->largeBalls.count = 0;
+    cache->largeBalls.capacity = 0;
+    cache->storedRefs = 0;
+    cache->liveRefs = 0;
+    cache->scratch = createBFSScratch(graph->numUsers);
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->invalidations = 0;
+
+    freeShortestPathCache(graph);
+    graph->pathCache = cache;
+    return cache;
+}
+
+// Função para desassociar e liberar o cache de menores caminhos do grafo
+void freeShortestPathCache(Graph* graph) {
+    ShortestPathCache* cache = graph->pathCache;
+    if (cache != NULL) {
+        for (int i = 0; i < cache->capacity; i++) {
+            free(cache->entries[i].path);
+        }
+        for (int u = 0; u < cache->numUsers; u++) {
+            free(cache->ballRefs[u].items);
+            free(cache->pathRefs[u].items);
+        }
+        free(cache->ballRefs);
+        free(cache->pathRefs);
+        free(cache->largeBalls.items);
+        free(cache->entries);
+        freeBFSScratch(cache->scratch);
+        free(cache);
+        graph->pathCache = NULL;
+    }
+}
+
+// Função para consultar o menor caminho entre dois usuários usando o cache do grafo
+// graph: Ponteiro para o grafo (com cache criado por createShortestPathCache)
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// path: Array de saída com capacidade para numUsers IDs (NULL se só a distância interessa)
+// pathLength: Saída com o número de usuários no caminho (pode ser NULL)
+// Retorna a distância (-1 se não há caminho)
+int cachedShortestPath(Graph* graph, int source, int target, int* path, int* pathLength) {
+    ShortestPathCache* cache = graph->pathCache;
+    unsigned int hash = ((unsigned int)source * 2654435761u) ^ ((unsigned int)target * 40503u);
+    int slot = (int)(hash & (cache->capacity - 1));
+    CachedPath* entry = &cache->entries[slot];
+
+    if (!(entry->valid && entry->source == source && entry->target == target)) {
+        cache->misses++;
+
+        const int* begin;
+        const int* end;
+        const int* neighbors;
+        graphAdjacency(graph, &begin, &end, &neighbors);
+        int visited;
+        int distance = bfsShortestPathView(begin, end, neighbors, cache->scratch, source, target, &visited);
+
+        // Substitui a entrada do slot (as referências da entrada anterior vencem)
+        pathCacheInvalidate(cache, slot);
+        free(entry->path);
+        entry->path = NULL;
+        entry->source = source;
+        entry->target = target;
+        entry->distance = distance;
+        if (distance >= 0) {
+            entry->path = (int*)malloc((distance + 1) * sizeof(int));
+            if (!entry->path) exit(1);
+            bfsReconstructPath(cache->scratch, target, entry->path);
+        }
+
+        // Camadas que uma nova conexão poderia atalhar (a componente inteira se não há caminho)
+        int ballSize = 0;
+        for (int i = 0; i < visited; i++) {
+            if (distance < 0 || cache->scratch->distance[cache->scratch->queue[i]] <= distance - 2) ballSize++;
+        }
+        if (ballSize > PATH_CACHE_MAX_BALL) {
+            entry->ballSize = -1;
+            pathCacheRefPush(cache, &cache->largeBalls, slot);
+        } else {
+            entry->ballSize = ballSize;
+            for (int i = 0; i < visited; i++) {
+                int v = cache->scratch->queue[i];
+                if (distance < 0 || cache->scratch->distance[v] <= distance - 2) {
+                    pathCacheRefPush(cache, &cache->ballRefs[v], slot);
+                }
+            }
+        }
+        for (int i = 0; i <= distance; i++) {
+            pathCacheRefPush(cache, &cache->pathRefs[entry->path[i]], slot);
+        }
+        entry->valid = true;
+        cache->liveRefs += pathCacheEntryRefs(entry);
+        pathCacheMaybeCompact(cache);
+    } else {
+        cache->hits++;
+    }
+
+    if (entry->distance >= 0) {
+        if (path) memcpy(path, entry->path, (entry->distance + 1) * sizeof(int));
+        if (pathLength) *pathLength = entry->distance + 1;
+    } else if (pathLength) {
+        *pathLength = 0;
+    }
+    return entry->distance;
+}
+
+/*
+16-etapa: Leituras concorrentes com snapshots (grafo versionado)
+
+Descrição:
+- O `Graph` não tem sincronização: `addConnection` altera as cabeças das listas que uma busca pode estar
+  lendo. O `VersionedGraph` permite que leitores respondam consultas enquanto uma thread escritora insere e
+  remove conexões.
+- Snapshots imutáveis: cada versão do grafo é um CSR que nunca é alterado depois de publicado.
+  - O escritor acumula as mudanças em um buffer de deltas (protegido por mutex, só entre escritores).
+  - `publishSnapshot` junta o CSR atual com os deltas ordenados em um novo CSR, em uma passada O(V + E), e
+    troca o ponteiro da versão atual com uma única operação atômica.
+  - Os deltas são distribuídos por origem (contagem e prefixo) e cada origem é ordenada e compactada em
+    paralelo; a junção também é paralela por usuário. O replay do log (17-etapa) usa o mesmo caminho, com
+    contagens e números de ordem de 64 bits.
+  - Publicar em lotes amortiza o custo da junção entre muitas mudanças.
+- Leitores sem bloqueio: `readerEnter` anuncia a época global em um slot próprio e lê o ponteiro atual; a
+  partir daí o leitor vê uma versão consistente até chamar `readerExit`, sem locks e sem contadores
+  compartilhados no caminho da consulta.
+- Reclamação por épocas: a versão substituída é aposentada com a época do momento da troca e só é liberada
+  quando todos os leitores ativos tiverem anunciado uma época maior, ou seja, quando nenhum leitor pode
+  mais estar usando-a.
+
+Funções:
+- `createVersionedGraph`: Cria o grafo versionado a partir do estado atual de um `Graph`.
+- `freeVersionedGraph`: Libera o grafo versionado e todas as versões.
+- `registerReader`: Reserva um slot de leitor.
+- `readerEnter` / `readerExit`: Delimitam o uso de um snapshot por um leitor.
+- `versionedAddConnection` / `versionedRemoveConnection`: Registram mudanças pendentes.
+- `publishSnapshot`: Publica uma nova versão com as mudanças pendentes.
+- `mergeCSRWithDeltas`: Cria um novo CSR aplicando mudanças ordenadas a um CSR existente.
+- `snapshotShortestPath`: Menor caminho em um snapshot.
+*/
+
+// Número máximo de leitores registrados ao mesmo tempo
+#define VERSIONED_MAX_READERS 64
+
+// Estrutura para representar o grafo versionado
+typedef struct VersionedGraph {
+    _Atomic(GraphSnapshot*) current;  // Versão atual
+    atomic_ullong globalEpoch;  // Época global, avançada a cada publicação
+    atomic_ullong readerEpoch[VERSIONED_MAX_READERS];  // Época anunciada por cada leitor (0 = fora de leitura)
+    atomic_bool readerSlotUsed[VERSIONED_MAX_READERS];  // Slots reservados
+    pthread_mutex_t writerLock;  // Serializa os escritores
+    EdgeDelta* pending;  // Mudanças ainda não publicadas
+    int numPending;  // Número de mudanças pendentes
+    int pendingCapacity;  // Capacidade do buffer de mudanças
+    GraphSnapshot* retired;  // Versões aposentadas aguardando liberação
+} VersionedGraph;
+
+// Função de comparação de mudanças por (origem, destino, ordem)
+static int compareEdgeDeltas(const void* a, const void* b) {
+    const EdgeDelta* x = (const EdgeDelta*)a;
+    const EdgeDelta* y = (const EdgeDelta*)b;
+    if (x->src != y->src) return (x->src > y->src) - (x->src < y->src);
+    if (x->dest != y->dest) return (x->dest > y->dest) - (x->dest < y->dest);
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+// Ordena as mudanças e mantém apenas a última de cada (origem, destino)
+// Retorna o número de mudanças restantes
+long long normalizeEdgeDeltas(EdgeDelta* deltas, long long count) {
+    if (count <= 0) {
+        return 0;
+    }
+    int maxSrc = 0;
+    #pragma omp parallel for schedule(static) reduction(max:maxSrc)
+    for (long long i = 0; i < count; i++) {
+        if (deltas[i].src > maxSrc) maxSrc = deltas[i].src;
+    }
+    int numSources = maxSrc + 1;
+    long long* start = (long long*)calloc((size_t)numSources + 1, sizeof(long long));
+    long long* fill = (long long*)malloc((size_t)numSources * sizeof(long long));
+    EdgeDelta* sorted = (EdgeDelta*)malloc((size_t)count * sizeof(EdgeDelta));
+    if (!start || !fill || !sorted) exit(1);  // Verificação de alocação de memória
+
+    // Contagem por origem e início de cada origem
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; i++) {
+        #pragma omp atomic
+        start[deltas[i].src + 1]++;
+    }
+    for (int v = 0; v < numSources; v++) {
+        start[v + 1] += start[v];
+    }
+
+    // Distribuição: fill[v] é a próxima posição livre da origem v
+    memcpy(fill, start, (size_t)numSources * sizeof(long long));
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; i++) {
+        long long position;
+        #pragma omp atomic capture
+        position = fill[deltas[i].src]++;
+        sorted[position] = deltas[i];
+    }
+
+    // Cada origem é ordenada por (destino, ordem); fill passa a guardar quantas mudanças a origem mantém
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int v = 0; v < numSources; v++) {
+        long long begin = start[v];
+        long long end = start[v + 1];
+        qsort(sorted + begin, (size_t)(end - begin), sizeof(EdgeDelta), compareEdgeDeltas);
+        long long kept = 0;
+        for (long long i = begin; i < end; i++) {
+            if (i + 1 == end || sorted[i + 1].dest != sorted[i].dest) kept++;
+        }
+        fill[v] = kept;
+    }
+    long long total = 0;
+    for (int v = 0; v < numSources; v++) {
+        long long kept = fill[v];
+        fill[v] = total;
+        total += kept;
+    }
+
+    // Compactação: uma mudança posterior sobre a mesma conexão prevalece
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int v = 0; v < numSources; v++) {
+        long long out = fill[v];
+        for (long long i = start[v]; i < start[v + 1]; i++) {
+            if (i + 1 == start[v + 1] || sorted[i + 1].dest != sorted[i].dest) {
+                deltas[out++] = sorted[i];
+            }
+        }
+    }
+
+    free(start);
+    free(fill);
+    free(sorted);
+    return total;
+}
+
+// Junta a lista de v no CSR base com as mudanças deltas[d .. dEnd - 1] (todas com origem v)
+// out: Destino dos vizinhos resultantes (NULL para só contar)
+// Retorna o número de vizinhos resultantes
+static int mergeCSRRow(const CSRGraph* base, int v, const EdgeDelta* deltas, long long d, long long dEnd, int* out) {
+    int e = base ? base->offsets[v] : 0;
+    int eEnd = base ? base->offsets[v + 1] : 0;
+    int total = 0;
+    while (e < eEnd || d < dEnd) {
+        bool fromBase = e < eEnd && (d >= dEnd || base->neighbors[e] <= deltas[d].dest);
+        bool fromDelta = d < dEnd && (e >= eEnd || deltas[d].dest <= base->neighbors[e]);
+        int u = fromBase ? base->neighbors[e] : deltas[d].dest;
+        bool keep = fromDelta ? deltas[d].added : true;
+        if (keep) {
+            if (out) out[total] = u;
+            total++;
+        }
+        if (fromBase) e++;
+        if (fromDelta) d++;
+    }
+    return total;
+}
+
+// Função para criar um novo CSR aplicando mudanças a um CSR existente
+// base: CSR original (NULL equivale a um grafo sem conexões)
+// numUsers: Número de usuários
+// deltas: Mudanças normalizadas por normalizeEdgeDeltas (uma entrada por direção)
+// count: Número de mudanças
+CSRGraph* mergeCSRWithDeltas(const CSRGraph* base, int numUsers, const EdgeDelta* deltas, long long count) {
+    CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+    long long* deltaStart = (long long*)malloc(((size_t)numUsers + 1) * sizeof(long long));
+    if (!csr || !deltaStart) exit(1);
+    csr->numUsers = numUsers;
+    csr->offsets = (int*)malloc((numUsers + 1) * sizeof(int));
+    if (!csr->offsets) exit(1);
+    csr->weights = NULL;
+
+    // Primeira mudança de cada usuário (busca binária nas mudanças ordenadas por origem)
+    #pragma omp parallel for schedule(static)
+    for (int v = 0; v <= numUsers; v++) {
+        long long low = 0;
+        long long high = count;
+        while (low < high) {
+            long long middle = low + (high - low) / 2;
+            if (deltas[middle].src < v) low = middle + 1; else high = middle;
+        }
+        deltaStart[v] = low;
+    }
+
+    // Primeira passada conta, segunda preenche: junção de cada lista ordenada com as suas mudanças
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < numUsers; v++) {
+        csr->offsets[v + 1] = mergeCSRRow(base, v, deltas, deltaStart[v], deltaStart[v + 1], NULL);
+    }
+    csr->offsets[0] = 0;
+    for (int v = 0; v < numUsers; v++) {
+        csr->offsets[v + 1] += csr->offsets[v];
+    }
+    csr->neighbors = (int*)malloc((csr->offsets[numUsers] + 1) * sizeof(int));
+    if (!csr->neighbors) exit(1);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < numUsers; v++) {
+        mergeCSRRow(base, v, deltas, deltaStart[v], deltaStart[v + 1], csr->neighbors + csr->offsets[v]);
+    }
+
+    free(deltaStart);
+    return csr;
+}
+
+// Copia um CSR
+static CSRGraph* copyCSR(const CSRGraph* csr) {
+    return mergeCSRWithDeltas(csr, csr->numUsers, NULL, 0);
+}
+
+// Função para criar o grafo versionado a partir do estado atual de um grafo
+// graph: Ponteiro para o grafo (não é usado depois da criação)
+// Retorna NULL se o grafo está no modo de seguidores (as mudanças versionadas valem nos dois sentidos)
+VersionedGraph* createVersionedGraph(Graph* graph) {
+    if (graph->directed) {
+        return NULL;
+    }
+    VersionedGraph* vg = (VersionedGraph*)malloc(sizeof(VersionedGraph));
+    GraphSnapshot* snapshot = (GraphSnapshot*)malloc(sizeof(GraphSnapshot));
+    if (!vg || !snapshot) exit(1);  // Verificação de alocação de memória
+
+    snapshot->csr = copyCSR(getCSR(graph));
+    snapshot->version = 1;
+    snapshot->retireEpoch = 0;
+    snapshot->nextRetired = NULL;
+
+    atomic_init(&vg->current, snapshot);
+    atomic_init(&vg->globalEpoch, 1);
+    for (int i = 0; i < VERSIONED_MAX_READERS; i++) {
+        atomic_init(&vg->readerEpoch[i], 0);
+        atomic_init(&vg->readerSlotUsed[i], false);
+    }
+    pthread_mutex_init(&vg->writerLock, NULL);
+    vg->pendingCapacity = 1024;
+    vg->pending = (EdgeDelta*)malloc(vg->pendingCapacity * sizeof(EdgeDelta));
+    if (!vg->pending) exit(1);
+    vg->numPending = 0;
+    vg->retired = NULL;
+    return vg;
+}
+
+// Libera uma versão
+static void freeSnapshot(GraphSnapshot* snapshot) {
+    freeCSR(snapshot->csr);
+    free(snapshot);
+}
+
+// Função para liberar o grafo versionado (nenhum leitor pode estar ativo)
+void freeVersionedGraph(VersionedGraph* vg) {
+    freeSnapshot(atomic_load(&vg->current));
+    while (vg->retired) {
+        GraphSnapshot* next = vg->retired->nextRetired;
+        freeSnapshot(vg->retired);
+        vg->retired = next;
+    }
+    pthread_mutex_destroy(&vg->writerLock);
+    free(vg->pending);
+    free(vg);
+}
+
+// Função para reservar um slot de leitor (cada thread leitora usa o seu)
+// Retorna o slot, ou -1 se todos estiverem ocupados
+int registerReader(VersionedGraph* vg) {
+    for (int i = 0; i < VERSIONED_MAX_READERS; i++) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&vg->readerSlotUsed[i], &expected, true)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Função para liberar um slot de leitor
+void unregisterReader(VersionedGraph* vg, int slot) {
+    atomic_store(&vg->readerEpoch[slot], 0);
+    atomic_store(&vg->readerSlotUsed[slot], false);
+}
+
+// Função para iniciar uma leitura
+// Retorna a versão atual, válida até a chamada de readerExit com o mesmo slot
+const GraphSnapshot* readerEnter(VersionedGraph* vg, int slot) {
+    // Anuncia a época antes de ler o ponteiro: uma versão trocada depois deste ponto não é liberada
+    atomic_store(&vg->readerEpoch[slot], atomic_load(&vg->globalEpoch));
+    return atomic_load(&vg->current);
+}
+
+// Função para terminar uma leitura
+void readerExit(VersionedGraph* vg, int slot) {
+    atomic_store(&vg->readerEpoch[slot], 0);
+}
+
+// Registra uma mudança pendente nas duas direções
+static void versionedRecord(VersionedGraph* vg, int src, int dest, bool added) {
+    pthread_mutex_lock(&vg->writerLock);
+    if (vg->numPending + 2 > vg->pendingCapacity) {
+        vg->pendingCapacity *= 2;
+        vg->pending = (EdgeDelta*)realloc(vg->pending, vg->pendingCapacity * sizeof(EdgeDelta));
+        if (!vg->pending) exit(1);
+    }
+    EdgeDelta forward = { src, dest, vg->numPending, added };
+    EdgeDelta backward = { dest, src, vg->numPending + 1, added };
+    vg->pending[vg->numPending++] = forward;
+    vg->pending[vg->numPending++] = backward;
+    pthread_mutex_unlock(&vg->writerLock);
+}
+
+// Função para registrar a inserção de uma conexão (visível após publishSnapshot)
+void versionedAddConnection(VersionedGraph* vg, int src, int dest) {
+    versionedRecord(vg, src, dest, true);
+}
+
+// Função para registrar a remoção de uma conexão (visível após publishSnapshot)
+void versionedRemoveConnection(VersionedGraph* vg, int src, int dest) {
+    versionedRecord(vg, src, dest, false);
+}
+
+// Função para publicar uma nova versão com as mudanças pendentes
+// Retorna o número da versão atual após a publicação
+unsigned long long publishSnapshot(VersionedGraph* vg) {
+    pthread_mutex_lock(&vg->writerLock);
+    GraphSnapshot* old = atomic_load(&vg->current);
+    if (vg->numPending == 0) {
+        pthread_mutex_unlock(&vg->writerLock);
+        return old->version;
+    }
+
+    // Monta a nova versão fora do caminho dos leitores
+    long long count = normalizeEdgeDeltas(vg->pending, vg->numPending);
+    GraphSnapshot* snapshot = (GraphSnapshot*)malloc(sizeof(GraphSnapshot));
+    if (!snapshot) exit(1);
+    snapshot->csr = mergeCSRWithDeltas(old->csr, old->csr->numUsers, vg->pending, count);
+    snapshot->version = old->version + 1;
+    snapshot->retireEpoch = 0;
+    snapshot->nextRetired = NULL;
+    vg->numPending = 0;
+
+    // Publica e aposenta a versão anterior com a época atual
+    atomic_store(&vg->current, snapshot);
+    old->retireEpoch = atomic_fetch_add(&vg->globalEpoch, 1);
+    old->nextRetired = vg->retired;
+    vg->retired = old;
+
+    // Libera as versões que nenhum leitor ativo pode estar usando
+    unsigned long long minActive = ULLONG_MAX;
+    for (int i = 0; i < VERSIONED_MAX_READERS; i++) {
+        unsigned long long epoch = atomic_load(&vg->readerEpoch[i]);
+        if (epoch != 0 && epoch < minActive) minActive = epoch;
+    }
+    GraphSnapshot** link = &vg->retired;
+    while (*link) {
+        if ((*link)->retireEpoch < minActive) {
+            GraphSnapshot* toFree = *link;
+            *link = toFree->nextRetired;
+            freeSnapshot(toFree);
+        } else {
+            link = &(*link)->nextRetired;
+        }
+    }
+
+    unsigned long long version = snapshot->version;
+    pthread_mutex_unlock(&vg->writerLock);
+    return version;
+}
+
+// Função para encontrar o menor caminho em um snapshot
+// snapshot: Versão obtida com readerEnter
+// scratch: Estado de BFS do leitor
+// path: Array de saída com capacidade para numUsers IDs (NULL se só a distância interessa)
+// pathLength: Saída com o número de usuários no caminho (pode ser NULL)
+// Retorna a distância (-1 se não há caminho)
+int snapshotShortestPath(const GraphSnapshot* snapshot, BFSScratch* scratch, int source, int target, int* path, int* pathLength) {
+    const CSRGraph* csr = snapshot->csr;
+    int distance = bfsShortestPathView(csr->offsets, csr->offsets + 1, csr->neighbors, scratch, source, target, NULL);
+    int length = 0;
+    if (distance >= 0 && path) {
+        length = bfsReconstructPath(scratch, target, path);
+    } else if (distance >= 0) {
+        length = distance + 1;
+    }
+    if (pathLength) *pathLength = length;
+    return distance;
+}
+
+/*
+17-etapa: Log de conexões somente-anexação, replay e compactação
+
+Descrição:
+- Para não regenerar o grafo a cada reinício, cada mudança é gravada em um log binário:
+  - Cabeçalho de 16 bytes ("EDLOG1", número de usuários) seguido de registros de 8 bytes:
+    origem (31 bits, o bit mais alto indica remoção) e destino, na ordem de bytes da máquina.
+  - As gravações passam por um buffer de 1 MB e viram uma única chamada `write` por buffer cheio.
+    `edgeLogFlush(log, true)` também chama `fsync`.
+  - Uma gravação que falha é desfeita (o arquivo volta ao tamanho anterior) e o buffer é mantido para a
+    próxima tentativa. Se o buffer estiver cheio, `edgeLogAppend` recusa a mudança; o erro fica registrado
+    no log e é informado pelo próximo `edgeLogFlush`, mesmo quando a gravação automática (`attachEdgeLog`)
+    não tem como retorná-lo.
+  - Com `attachEdgeLog`, toda chamada de `addConnection` / `removeConnection` é gravada automaticamente.
+    Os registros não têm sentido e o replay gera as duas direções, por isso um grafo de seguidores (24-etapa)
+    não pode ser associado a um log, e `recoverCSR` recusa aplicar mudanças a um snapshot não simétrico.
+  - Ao reabrir, um registro incompleto no final (queda no meio de uma gravação) é descartado.
+  - Um registro com usuário fora do intervalo do cabeçalho só pode vir de um arquivo corrompido: ele marca o
+    fim do log. O replay ignora o que vem depois, e `openEdgeLog` trunca o log nesse ponto antes de anexar.
+- Replay: o log é mapeado em memória e decodificado em paralelo (OpenMP) em mudanças por direção. As
+  mudanças são normalizadas (a última sobre cada conexão prevalece) e aplicadas ao snapshot com o
+  construtor em lote `mergeCSRWithDeltas` da 16-etapa.
+- Compactação: junta snapshot + log em um novo arquivo de snapshot ("EDSNAP1", offsets e vizinhos do CSR),
+  gravado em um arquivo temporário, sincronizado e renomeado sobre o anterior; só então o log é truncado.
+  Se a queda ocorrer entre as duas etapas, o replay repete mudanças já aplicadas, o que não altera o resultado.
+- O snapshot é carregado com `mmap`, sem cópia: o CSR aponta diretamente para o arquivo. Ao mapear, uma
+  passada paralela confere que os offsets são crescentes e que cada lista de vizinhos é ordenada e só tem
+  usuários válidos; um snapshot que falhe é rejeitado, e `recoverCSR` não o substitui pelo log sozinho.
+
+Funções:
+- `openEdgeLog` / `closeEdgeLog`: Abrem e fecham o log.
+- `edgeLogAppend`: Grava uma mudança no buffer (false se o disco falhou e a mudança foi perdida).
+- `edgeLogFlush`: Esvazia o buffer (e opcionalmente sincroniza o disco).
+- `attachEdgeLog`: Grava automaticamente as mudanças de um grafo.
+- `replayEdgeLog`: Lê o log e retorna as mudanças normalizadas.
+- `writeCSRSnapshot`: Grava um CSR em um arquivo de snapshot.
+- `mapCSRSnapshot` / `unmapCSRSnapshot`: Mapeiam e desmapeiam um snapshot.
+- `recoverCSR`: Reconstrói o CSR a partir do snapshot e do log.
+- `compactEdgeLog`: Junta o log ao snapshot e esvazia o log.
+*/
+
+// Tamanho do buffer de gravação do log
+#define EDGE_LOG_BUFFER_SIZE (1 << 20)
+// Tamanho do cabeçalho dos arquivos de log e de snapshot
+#define EDGE_LOG_HEADER_SIZE 16
+#define SNAPSHOT_HEADER_SIZE 24
+// Bit que marca um registro de remoção
+#define EDGE_LOG_REMOVE_FLAG 0x80000000u
+
+static const char EDGE_LOG_MAGIC[8] = "EDLOG1";
+static const char SNAPSHOT_MAGIC[8] = "EDSNAP1";
+
+// Estrutura para representar um log de conexões aberto para gravação
+typedef struct EdgeLog {
+    int fd;  // Descritor do arquivo
+    int numUsers;  // Número de usuários do grafo
+    unsigned char* buffer;  // Buffer de gravação
+    size_t used;  // Bytes ocupados no buffer
+    bool failed;  // Uma gravação falhou desde o último edgeLogFlush
+} EdgeLog;
+
+// Grava todos os bytes, repetindo em caso de gravação parcial
+static bool writeAll(int fd, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+// Retorna o número de registros válidos no início do log (o primeiro registro inválido marca o fim do log)
+// data: Registros (sem o cabeçalho)
+// users: Número de usuários do cabeçalho
+static long long edgeLogValidRecords(const unsigned char* data, long long numRecords, uint32_t users) {
+    long long firstInvalid = numRecords;
+    #pragma omp parallel for schedule(static) reduction(min:firstInvalid)
+    for (long long r = 0; r < numRecords; r++) {
+        uint32_t record[2];
+        memcpy(record, data + r * 8, sizeof(record));
+        if ((record[0] & ~EDGE_LOG_REMOVE_FLAG) >= users || record[1] >= users) {
+            if (r < firstInvalid) firstInvalid = r;
+        }
+    }
+    return firstInvalid;
+}
+
+// Função para abrir (ou criar) um log de conexões para anexação
+// path: Caminho do arquivo
+// numUsers: Número de usuários do grafo (deve coincidir com o do log existente)
+// Retorna o log, ou NULL em caso de erro
+EdgeLog* openEdgeLog(const char* path, int numUsers) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+    unsigned char header[EDGE_LOG_HEADER_SIZE];
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return NULL;
+    }
+    if (info.st_size < EDGE_LOG_HEADER_SIZE) {
+        // Log novo (ou sem cabeçalho completo): grava o cabeçalho
+        memset(header, 0, sizeof(header));
+        memcpy(header, EDGE_LOG_MAGIC, sizeof(EDGE_LOG_MAGIC));
+        uint32_t users = (uint32_t)numUsers;
+        memcpy(header + 8, &users, sizeof(users));
+        if (ftruncate(fd, 0) != 0 || !writeAll(fd, header, sizeof(header))) {
+            close(fd);
+            return NULL;
+        }
+    } else {
+        // Log existente: valida o cabeçalho e descarta um registro incompleto no final
+        uint32_t users;
+        if (pread(fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            memcmp(header, EDGE_LOG_MAGIC, sizeof(EDGE_LOG_MAGIC)) != 0) {
+            close(fd);
+            return NULL;
+        }
+        memcpy(&users, header + 8, sizeof(users));
+        if (users > INT_MAX || (int)users != numUsers) {
+            close(fd);
+            return NULL;
+        }
+        long long numRecords = (long long)(info.st_size - EDGE_LOG_HEADER_SIZE) / 8;
+        if (numRecords > 0) {
+            // Registros depois de um registro corrompido não seriam lidos pelo replay
+            size_t size = (size_t)info.st_size;
+            unsigned char* data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                return NULL;
+            }
+            numRecords = edgeLogValidRecords(data + EDGE_LOG_HEADER_SIZE, numRecords, users);
+            munmap(data, size);
+        }
+        off_t complete = EDGE_LOG_HEADER_SIZE + (off_t)numRecords * 8;
+        if (complete != info.st_size && ftruncate(fd, complete) != 0) {
+            close(fd);
+            return NULL;
+        }
+        if (lseek(fd, 0, SEEK_END) < 0) {
+            close(fd);
+            return NULL;
+        }
+    }
+
+    EdgeLog* log = (EdgeLog*)malloc(sizeof(EdgeLog));
+    if (!log) exit(1);  // Verificação de alocação de memória
+    log->fd = fd;
+    log->numUsers = numUsers;
+    log->buffer = (unsigned char*)malloc(EDGE_LOG_BUFFER_SIZE);
+    if (!log->buffer) exit(1);
+    log->used = 0;
+    log->failed = false;
+    return log;
+}
+
+// Função para esvaziar o buffer do log
+// sync: Se true, também espera os dados chegarem ao disco (fsync)
+// Retorna false em caso de erro de gravação, nesta chamada ou em uma gravação anterior (o erro é informado uma vez)
+bool edgeLogFlush(EdgeLog* log, bool sync) {
+    bool ok = true;
+    if (log->used > 0) {
+        off_t end = lseek(log->fd, 0, SEEK_END);
+        if (end >= 0 && writeAll(log->fd, log->buffer, log->used)) {
+            log->used = 0;
+        } else {
+            // Desfaz uma gravação parcial para não deixar registros cortados no meio do log
+            if (end >= 0 && ftruncate(log->fd, end) == 0) lseek(log->fd, end, SEEK_SET);
+            ok = false;
+        }
+    }
+    if (ok && sync && fsync(log->fd) != 0) {
+        ok = false;
+    }
+    ok = ok && !log->failed;
+    log->failed = false;
+    return ok;
+}
+
+// Função para gravar uma mudança no log
+// src, dest: IDs dos usuários da conexão
+// added: true para inserção, false para remoção
+// Retorna false se o buffer estava cheio e não pôde ser gravado (a mudança não entra no log)
+bool edgeLogAppend(EdgeLog* log, int src, int dest, bool added) {
+    if (log->used + 8 > EDGE_LOG_BUFFER_SIZE && !edgeLogFlush(log, false)) {
+        log->failed = true;  // Informado pelo próximo edgeLogFlush
+        return false;
+    }
+    uint32_t record[2] = { (uint32_t)src | (added ? 0 : EDGE_LOG_REMOVE_FLAG), (uint32_t)dest };
+    memcpy(log->buffer + log->used, record, sizeof(record));
+    log->used += sizeof(record);
+    return true;
+}
+
+// Função para fechar o log, gravando e sincronizando o que estiver no buffer
+void closeEdgeLog(EdgeLog* log) {
+    if (log != NULL) {
+        edgeLogFlush(log, true);
+        close(log->fd);
+        free(log->buffer);
+        free(log);
+    }
+}
+
+// Função para gravar automaticamente no log as mudanças de um grafo
+// graph: Ponteiro para o grafo
+// log: Log aberto (NULL para desassociar); continua pertencendo a quem o abriu
+// Retorna false se o grafo está no modo de seguidores (o log não guarda o sentido das conexões)
+bool attachEdgeLog(Graph* graph, EdgeLog* log) {
+    if (graph->directed && log != NULL) {
+        return false;
+    }
+    graph->edgeLog = log;
+    return true;
+}
+
+// Função para ler o log e retornar as mudanças normalizadas (uma entrada por direção)
+// path: Caminho do arquivo de log
+// numUsers: Saída com o número de usuários gravado no cabeçalho
+// deltas: Saída com o array (alocado) de mudanças
+// Retorna o número de mudanças, ou -1 se o log não puder ser lido
+long long replayEdgeLog(const char* path, int* numUsers, EdgeDelta** deltas) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < EDGE_LOG_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)info.st_size;
+    unsigned char* data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || memcmp(data, EDGE_LOG_MAGIC, sizeof(EDGE_LOG_MAGIC)) != 0) {
+        if (data != MAP_FAILED) munmap(data, size);
+        return -1;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    uint32_t users;
+    memcpy(&users, data + 8, sizeof(users));
+    if (users > INT_MAX) {
+        munmap(data, size);
+        return -1;
+    }
+    *numUsers = (int)users;
+    long long numRecords = edgeLogValidRecords(data + EDGE_LOG_HEADER_SIZE, (long long)(size - EDGE_LOG_HEADER_SIZE) / 8, users);
+
+    // Decodificação paralela: cada registro gera as mudanças das duas direções
+    EdgeDelta* result = (EdgeDelta*)malloc((2 * numRecords + 1) * sizeof(EdgeDelta));
+    if (!result) exit(1);
+    #pragma omp parallel for schedule(static)
+    for (long long r = 0; r < numRecords; r++) {
+        uint32_t record[2];
+        memcpy(record, data + EDGE_LOG_HEADER_SIZE + r * 8, sizeof(record));
+        bool added = (record[0] & EDGE_LOG_REMOVE_FLAG) == 0;
+        int src = (int)(record[0] & ~EDGE_LOG_REMOVE_FLAG);
+        int dest = (int)record[1];
+        EdgeDelta forward = { src, dest, 2 * r, added };
+        EdgeDelta backward = { dest, src, 2 * r + 1, added };
+        result[2 * r] = forward;
+        result[2 * r + 1] = backward;
+    }
+    munmap(data, size);
+
+    *deltas = result;
+    return normalizeEdgeDeltas(result, 2 * numRecords);
+}
+
+// Função para gravar um CSR em um arquivo de snapshot
+// O arquivo é gravado em "<path>.tmp", sincronizado e renomeado, para nunca deixar um snapshot incompleto.
+// Retorna false em caso de erro
+bool writeCSRSnapshot(const CSRGraph* csr, const char* path) {
+    size_t pathLength = strlen(path);
+    char* tmpPath = (char*)malloc(pathLength + 5);
+    if (!tmpPath) exit(1);
+    memcpy(tmpPath, path, pathLength);
+    memcpy(tmpPath + pathLength, ".tmp", 5);
+
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(tmpPath);
+        return false;
+    }
+
+    unsigned char header[SNAPSHOT_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    uint32_t users = (uint32_t)csr->numUsers;
+    uint64_t entries = (uint64_t)csr->offsets[csr->numUsers];
+    memcpy(header + 8, &users, sizeof(users));
+    memcpy(header + 16, &entries, sizeof(entries));
+
+    bool ok = writeAll(fd, header, sizeof(header)) &&
+              writeAll(fd, csr->offsets, (csr->numUsers + 1) * sizeof(int)) &&
+              writeAll(fd, csr->neighbors, entries * sizeof(int)) &&
+              fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    ok = ok && rename(tmpPath, path) == 0;
+    if (!ok) {
+        unlink(tmpPath);
+    }
+    free(tmpPath);
+    return ok;
+}
+
+// Confere a estrutura de um CSR lido de um arquivo: offsets crescentes de 0 a entries e listas de vizinhos
+// estritamente crescentes (mergeCSRWithDeltas depende da ordem) com usuários entre 0 e numUsers - 1
+static bool validSnapshotCSR(const int* offsets, const int* neighbors, int numUsers, long long entries) {
+    if (offsets[0] != 0 || offsets[numUsers] != entries) {
+        return false;
+    }
+    int valid = 1;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(&&:valid)
+    for (int v = 0; v < numUsers; v++) {
+        int begin = offsets[v];
+        int end = offsets[v + 1];
+        if (begin > end || begin < 0 || end > entries) {
+            valid = 0;
+            continue;
+        }
+        for (int e = begin; e < end; e++) {
+            int u = neighbors[e];
+            if (u < 0 || u >= numUsers || (e > begin && u <= neighbors[e - 1])) {
+                valid = 0;
+                break;
+            }
+        }
+    }
+    return valid;
+}
+
+// Confere se um CSR (já validado) é simétrico: cada conexão u -> v tem a volta v -> u
+static bool symmetricCSR(const CSRGraph* csr) {
+    int symmetric = 1;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(&&:symmetric)
+    for (int u = 0; u < csr->numUsers; u++) {
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            int v = csr->neighbors[e];
+            if (!bsearch(&u, csr->neighbors + csr->offsets[v], csr->offsets[v + 1] - csr->offsets[v], sizeof(int), compareInts)) {
+                symmetric = 0;
+                break;
+            }
+        }
+    }
+    return symmetric;
+}
+
+// Função para mapear um snapshot em memória
+// Retorna o snapshot mapeado (liberar com unmapCSRSnapshot), ou NULL se o arquivo não existir ou for inválido
+MappedCSR* mapCSRSnapshot(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < SNAPSHOT_HEADER_SIZE) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)info.st_size;
+    unsigned char* data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    uint32_t users;
+    uint64_t entries;
+    memcpy(&users, data + 8, sizeof(users));
+    memcpy(&entries, data + 16, sizeof(entries));
+    if (memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || users > INT_MAX || entries > INT_MAX ||
+        size != SNAPSHOT_HEADER_SIZE + ((size_t)users + 1 + entries) * sizeof(int)) {
+        munmap(data, size);
+        return NULL;
+    }
+    const int* offsets = (const int*)(data + SNAPSHOT_HEADER_SIZE);
+    if (!validSnapshotCSR(offsets, offsets + users + 1, (int)users, (long long)entries)) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    MappedCSR* mapped = (MappedCSR*)malloc(sizeof(MappedCSR));
+    if (!mapped) exit(1);
+    mapped->mapping = data;
+    mapped->mappingSize = size;
+    mapped->csr.numUsers = (int)users;
+    mapped->csr.offsets = (int*)(data + SNAPSHOT_HEADER_SIZE);
+    mapped->csr.neighbors = mapped->csr.offsets + users + 1;
+    mapped->csr.weights = NULL;
+    return mapped;
+}
+
+// Função para desmapear um snapshot
+void unmapCSRSnapshot(MappedCSR* mapped) {
+    if (mapped != NULL) {
+        munmap(mapped->mapping, mapped->mappingSize);
+        free(mapped);
+    }
+}
+
+// Função para reconstruir o CSR a partir do snapshot e do log
+// snapshotPath: Caminho do snapshot (pode não existir)
+// logPath: Caminho do log (pode não existir)
+// numUsers: Número de usuários quando nenhum dos arquivos existe
+// Retorna o CSR reconstruído (liberar com freeCSR), ou NULL se o snapshot existir mas for inválido, se o
+// log for de um grafo com outro número de usuários ou se houver mudanças a aplicar a um snapshot direcionado
+CSRGraph* recoverCSR(const char* snapshotPath, const char* logPath, int numUsers) {
+    MappedCSR* base = mapCSRSnapshot(snapshotPath);
+    if (!base && access(snapshotPath, F_OK) == 0) {
+        return NULL;
+    }
+    EdgeDelta* deltas = NULL;
+    int logUsers = numUsers;
+    long long count = replayEdgeLog(logPath, &logUsers, &deltas);
+    if (count < 0) {
+        count = 0;
+    }
+    // O log grava as duas direções de cada conexão: aplicá-lo a um grafo de seguidores criaria seguidas mútuas
+    if (base && deltas && (logUsers != base->csr.numUsers || (count > 0 && !symmetricCSR(&base->csr)))) {
+        free(deltas);
+        unmapCSRSnapshot(base);
+        return NULL;
+    }
+    if (base) {
+        numUsers = base->csr.numUsers;
+    } else if (deltas) {
+        numUsers = logUsers;
+    }
+
+    CSRGraph* csr = mergeCSRWithDeltas(base ? &base->csr : NULL, numUsers, deltas, count);
+    free(deltas);
+    unmapCSRSnapshot(base);
+    return csr;
+}
+
+// Função para juntar o log ao snapshot e esvaziar o log
+// log: Log aberto sobre logPath
+// Retorna false em caso de erro ou se o snapshot for de um grafo direcionado (o log e o snapshot anteriores
+// continuam válidos)
+bool compactEdgeLog(EdgeLog* log, const char* snapshotPath, const char* logPath) {
+    if (!edgeLogFlush(log, true)) {
+        return false;
+    }
+
+    CSRGraph* csr = recoverCSR(snapshotPath, logPath, log->numUsers);
+    if (!csr) {
+        return false;  // Snapshot corrompido: não é sobrescrito
+    }
+    bool ok = writeCSRSnapshot(csr, snapshotPath);
+    freeCSR(csr);
+
+    // O log só é esvaziado depois que o novo snapshot está no disco
+    if (ok) {
+        ok = ftruncate(log->fd, EDGE_LOG_HEADER_SIZE) == 0 &&
+             lseek(log->fd, 0, SEEK_END) >= 0 &&
+             fsync(log->fd) == 0;
+    }
+    return ok;
+}
+
+/*
+18-etapa: Cache LRU concorrente de consultas de caminho
+
+Descrição:
+- Poucos usuários "celebridade" aparecem em boa parte das consultas (origem, destino). Este cache guarda
+  a distância e o caminho das consultas recentes na frente da BFS.
+- O cache é dividido em shards, cada um com o seu mutex, tabela hash e lista LRU, para que threads
+  consultando pares diferentes raramente disputem o mesmo lock. O shard é escolhido pelo hash do par
+  ordenado (origem, destino).
+- A BFS de uma consulta que não está no cache roda fora do lock, com o `BFSScratch` da thread.
+- Invalidação por versão: o grafo tem um número de versão incrementado a cada `addConnection` /
+  `removeConnection` (em `graphChanged`). Cada entrada guarda a versão em que foi calculada; uma entrada de
+  versão antiga é descartada quando encontrada, sem varrer o cache a cada mudança.
+- Requisito de concorrência: as consultas podem rodar em paralelo desde que o grafo não seja alterado ao
+  mesmo tempo; depois de uma alteração, chame `getCSR` antes de liberar as threads de consulta.
+
+Funções:
+- `createPathLRUCache`: Cria o cache com uma capacidade total e um número de shards.
+- `freePathLRUCache`: Libera o cache.
+- `lruShortestPath`: Consulta o menor caminho usando o cache.
+- `pathLRUCacheStats`: Retorna os contadores de acertos e faltas.
+*/
+
+// Estrutura para representar uma entrada do cache LRU
+typedef struct LRUEntry {
+    int source;  // ID do usuário de origem
+    int target;  // ID do usuário de destino
+    int distance;  // Distância (-1 se não há caminho)
+    int* path;  // Caminho com distance + 1 usuários (NULL se não há caminho)
+    unsigned long long version;  // Versão do grafo em que a entrada foi calculada
+    int prev;  // Entrada anterior na lista LRU (mais recente)
+    int next;  // Próxima entrada na lista LRU (menos recente) ou na lista de livres
+    int hashNext;  // Próxima entrada no mesmo balde da tabela hash
+} LRUEntry;
+
+// Estrutura para representar um shard do cache
+typedef struct LRUShard {
+    pthread_mutex_t lock;  // Protege todos os campos do shard
+    LRUEntry* entries;  // Entradas do shard
+    int capacity;  // Número de entradas
+    int* buckets;  // Primeira entrada de cada balde (-1 se vazio)
+    int numBuckets;  // Número de baldes (potência de 2)
+    int head;  // Entrada usada mais recentemente
+    int tail;  // Entrada usada menos recentemente
+    int freeList;  // Primeira entrada livre
+    long long hits;  // Consultas respondidas pelo shard
+    long long misses;  // Consultas que exigiram uma BFS
+} LRUShard;
+
+// Estrutura para representar o cache LRU de caminhos
+typedef struct PathLRUCache {
+    int numShards;  // Número de shards
+    LRUShard* shards;  // Shards do cache
+} PathLRUCache;
+
+// Hash do par ordenado (origem, destino)
+static unsigned int pathPairHash(int source, int target) {
+    unsigned long long key = ((unsigned long long)(unsigned int)source << 32) | (unsigned int)target;
+    return (unsigned int)(splitMix64(&key) >> 32);
+}
+
+// Função para criar o cache LRU de caminhos
+// capacity: Número total de entradas
+// numShards: Número de shards (pelo menos 1)
+PathLRUCache* createPathLRUCache(int capacity, int numShards) {
+    if (numShards < 1) numShards = 1;
+    int perShard = (capacity + numShards - 1) / numShards;
+    if (perShard < 1) perShard = 1;
+
+    PathLRUCache* cache = (PathLRUCache*)malloc(sizeof(PathLRUCache));
+    if (!cache) exit(1);  // Verificação de alocação de memória
+    cache->numShards = numShards;
+    cache->shards = (LRUShard*)malloc(numShards * sizeof(LRUShard));
+    if (!cache->shards) exit(1);
+
+    for (int s = 0; s < numShards; s++) {
+        LRUShard* shard = &cache->shards[s];
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->capacity = perShard;
+        shard->entries = (LRUEntry*)malloc(perShard * sizeof(LRUEntry));
+        shard->numBuckets = 1;
+        while (shard->numBuckets < perShard) {
+            shard->numBuckets <<= 1;
+        }
+        shard->buckets = (int*)malloc(shard->numBuckets * sizeof(int));
+        if (!shard->entries || !shard->buckets) exit(1);
+        for (int b = 0; b < shard->numBuckets; b++) {
+            shard->buckets[b] = -1;
+        }
+        // Todas as entradas começam na lista de livres
+        for (int i = 0; i < perShard; i++) {
+            shard->entries[i].path = NULL;
+            shard->entries[i].next = i + 1 < perShard ? i + 1 : -1;
+        }
+        shard->freeList = 0;
+        shard->head = -1;
+        shard->tail = -1;
+        shard->hits = 0;
+        shard->misses = 0;
+    }
+    return cache;
+}
+
+// Função para liberar o cache LRU de caminhos
+void freePathLRUCache(PathLRUCache* cache) {
+    if (cache != NULL) {
+        for (int s = 0; s < cache->numShards; s++) {
+            LRUShard* shard = &cache->shards[s];
+            for (int i = 0; i < shard->capacity; i++) {
+                free(shard->entries[i].path);
+            }
+            free(shard->entries);
+            free(shard->buckets);
+            pthread_mutex_destroy(&shard->lock);
+        }
+        free(cache->shards);
+        free(cache);
+    }
+}
+
+// Retira uma entrada da lista LRU
+static void lruUnlink(LRUShard* shard, int i) {
+    LRUEntry* entry = &shard->entries[i];
+    if (entry->prev != -1) shard->entries[entry->prev].next = entry->next; else shard->head = entry->next;
+    if (entry->next != -1) shard->entries[entry->next].prev = entry->prev; else shard->tail = entry->prev;
+}
+
+// Coloca uma entrada no início da lista LRU (mais recente)
+static void lruPushFront(LRUShard* shard, int i) {
+    LRUEntry* entry = &shard->entries[i];
+    entry->prev = -1;
+    entry->next = shard->head;
+    if (shard->head != -1) shard->entries[shard->head].prev = i;
+    shard->head = i;
+    if (shard->tail == -1) shard->tail = i;
+}
+
+// Remove uma entrada da tabela hash e da lista LRU e a devolve à lista de livres
+static void lruRemove(LRUShard* shard, int i, unsigned int hash) {
+    int* link = &shard->buckets[hash & (shard->numBuckets - 1)];
+    while (*link != i) {
+        link = &shard->entries[*link].hashNext;
+    }
+    *link = shard->entries[i].hashNext;
+    lruUnlink(shard, i);
+    free(shard->entries[i].path);
+    shard->entries[i].path = NULL;
+    shard->entries[i].next = shard->freeList;
+    shard->freeList = i;
+}
+
+// Procura o par no shard; retorna o índice da entrada ou -1
+static int lruFind(LRUShard* shard, int source, int target, unsigned int hash) {
+    int i = shard->buckets[hash & (shard->numBuckets - 1)];
+    while (i != -1 && (shard->entries[i].source != source || shard->entries[i].target != target)) {
+        i = shard->entries[i].hashNext;
+    }
+    return i;
+}
+
+// Função para consultar o menor caminho entre dois usuários usando o cache LRU
+// graph: Ponteiro para o grafo
+// cache: Cache LRU (pode ser compartilhado entre threads)
+// scratch: Estado de BFS da thread que faz a consulta
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// path: Array de saída com capacidade para numUsers IDs (NULL se só a distância interessa)
+// pathLength: Saída com o número de usuários no caminho (pode ser NULL)
+// Retorna a distância (-1 se não há caminho)
+int lruShortestPath(Graph* graph, PathLRUCache* cache, BFSScratch* scratch, int source, int target, int* path, int* pathLength) {
+    unsigned int hash = pathPairHash(source, target);
+    LRUShard* shard = &cache->shards[(hash >> 16) % (unsigned int)cache->numShards];
+    unsigned long long version = graph->version;
+
+    pthread_mutex_lock(&shard->lock);
+    int i = lruFind(shard, source, target, hash);
+    if (i != -1 && shard->entries[i].version != version) {
+        lruRemove(shard, i, hash);  // Calculada em uma versão anterior do grafo
+        i = -1;
+    }
+    if (i != -1) {
+        LRUEntry* entry = &shard->entries[i];
+        lruUnlink(shard, i);
+        lruPushFront(shard, i);
+        shard->hits++;
+        int distance = entry->distance;
+        if (distance >= 0 && path) memcpy(path, entry->path, (distance + 1) * sizeof(int));
+        pthread_mutex_unlock(&shard->lock);
+        if (pathLength) *pathLength = distance + 1;
+        return distance;
+    }
+    shard->misses++;
+    pthread_mutex_unlock(&shard->lock);
+
+    // Falta: BFS fora do lock
+    const int* begin;
+    const int* end;
+    const int* neighbors;
+    graphAdjacency(graph, &begin, &end, &neighbors);
+    int distance = bfsShortestPathView(begin, end, neighbors, scratch, source, target, NULL);
+    int* computed = NULL;
+    if (distance >= 0) {
+        computed = (int*)malloc((distance + 1) * sizeof(int));
+        if (!computed) exit(1);
+        bfsReconstructPath(scratch, target, computed);
+        if (path) memcpy(path, computed, (distance + 1) * sizeof(int));
+    }
+    if (pathLength) *pathLength = distance + 1;
+
+    // Insere o resultado, a menos que outra thread já o tenha feito
+    pthread_mutex_lock(&shard->lock);
+    if (lruFind(shard, source, target, hash) == -1) {
+        if (shard->freeList == -1) {
+            int victim = shard->tail;  // Menos recente
+            lruRemove(shard, victim, pathPairHash(shard->entries[victim].source, shard->entries[victim].target));
+        }
+        i = shard->freeList;
+        shard->freeList = shard->entries[i].next;
+
+        LRUEntry* entry = &shard->entries[i];
+        entry->source = source;
+        entry->target = target;
+        entry->distance = distance;
+        entry->path = computed;
+        entry->version = version;
+        entry->hashNext = shard->buckets[hash & (shard->numBuckets - 1)];
+        shard->buckets[hash & (shard->numBuckets - 1)] = i;
+        lruPushFront(shard, i);
+        computed = NULL;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    free(computed);
+    return distance;
+}
+
+// Função para obter os contadores do cache
+// hits: Saída com o total de acertos
+// misses: Saída com o total de faltas
+void pathLRUCacheStats(PathLRUCache* cache, long long* hits, long long* misses) {
+    *hits = 0;
+    *misses = 0;
+    for (int s = 0; s < cache->numShards; s++) {
+        pthread_mutex_lock(&cache->shards[s].lock);
+        *hits += cache->shards[s].hits;
+        *misses += cache->shards[s].misses;
+        pthread_mutex_unlock(&cache->shards[s].lock);
+    }
+}
+
+/*
+19-etapa: Cache de árvores de BFS por origem
+
+Descrição:
+- Muitas consultas compartilham a origem (um usuário vendo a distância até cada perfil do seu feed), mas
+  `bfsFindShortestPath` refaz a BFS a cada chamada e para no primeiro destino.
+- `buildBFSTree` roda uma BFS completa a partir da origem e guarda os arrays de distância e predecessor como
+  uma "árvore de BFS". Qualquer consulta (origem, *) é respondida por ela em O(tamanho do caminho).
+- As árvores ficam em um cache pequeno limitado por memória (cada árvore ocupa 2 * numUsers ints). Quando o
+  orçamento estoura, a árvore usada há mais tempo é descartada. A chave é a origem mais a versão do grafo
+  (18-etapa): uma árvore de versão antiga é descartada quando encontrada.
+- O cache pode ser usado por várias threads. As árvores têm contagem de referências: uma árvore descartada
+  pelo cache continua válida até que quem a obteve chame `releaseBFSTree`. Vale o mesmo requisito da
+  18-etapa: o grafo não é alterado durante as consultas paralelas.
+
+Funções:
+- `buildBFSTree`: Executa a BFS completa a partir de uma origem.
+- `bfsTreePath`: Reconstrói o caminho até um destino a partir da árvore.
+- `releaseBFSTree`: Libera uma referência à árvore.
+- `createBFSTreeCache`: Cria o cache com um orçamento de memória em bytes.
+- `freeBFSTreeCache`: Libera o cache.
+- `acquireBFSTree`: Obtém a árvore de uma origem, do cache ou construída na hora.
+- `bfsTreeShortestPath`: Consulta o menor caminho usando o cache de árvores.
+*/
+
+// Estrutura para representar o cache de árvores de BFS
+typedef struct BFSTreeCache {
+    pthread_mutex_t lock;  // Protege todos os campos do cache
+    BFSTree** trees;  // Árvores em cache
+    int count;  // Número de árvores em cache
+    int capacity;  // Capacidade do array trees
+    size_t memoryBudget;  // Orçamento de memória em bytes
+    size_t memoryUsed;  // Memória ocupada pelas árvores em cache
+    unsigned long long clock;  // Relógio para a ordem de uso
+    long long hits;  // Consultas respondidas por uma árvore em cache
+    long long misses;  // Consultas que exigiram uma BFS
+} BFSTreeCache;
+
+// Memória ocupada por uma árvore de BFS
+static size_t bfsTreeBytes(int numUsers) {
+    return sizeof(BFSTree) + 2 * (size_t)numUsers * sizeof(int);
+}
+
+// Função para executar a BFS completa a partir de uma origem
+// graph: Ponteiro para o grafo
+// source: ID do usuário de origem
+// Retorna a árvore com uma referência (liberar com releaseBFSTree)
+BFSTree* buildBFSTree(Graph* graph, int source) {
+    int n = graph->numUsers;
+    BFSTree* tree = (BFSTree*)malloc(sizeof(BFSTree));
+    if (!tree) exit(1);  // Verificação de alocação de memória
+    tree->source = source;
+    tree->numUsers = n;
+    tree->version = graph->version;
+    tree->distance = (int*)malloc(n * sizeof(int));
+    tree->predecessor = (int*)malloc(n * sizeof(int));
+    int* queue = (int*)malloc(n * sizeof(int));
+    if (!tree->distance || !tree->predecessor || !queue) exit(1);
+    atomic_init(&tree->references, 1);
+    tree->lastUse = 0;
+
+    const int* begin;
+    const int* end;
+    const int* neighbors;
+    graphAdjacency(graph, &begin, &end, &neighbors);
+    for (int v = 0; v < n; v++) {
+        tree->distance[v] = -1;
+    }
+    tree->distance[source] = 0;
+    tree->predecessor[source] = -1;
+    queue[0] = source;
+    int head = 0;
+    int tail = 1;
+    while (head < tail) {
+        int u = queue[head++];
+        INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, end[u] - begin[u]);
+        for (int e = begin[u]; e < end[u]; e++) {
+            int v = neighbors[e];
+            if (tree->distance[v] == -1) {
+                tree->distance[v] = tree->distance[u] + 1;
+                tree->predecessor[v] = u;
+                queue[tail++] = v;
+            }
+        }
+    }
+
+    INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, head);
+    free(queue);
+    return tree;
+}
+
+// Função para reconstruir o caminho até um destino a partir da árvore
+// tree: Árvore de BFS
+// target: ID do usuário de destino
+// path: Array de saída com capacidade para distance + 1 IDs (NULL se só a distância interessa)
+// Retorna a distância (-1 se não há caminho)
+int bfsTreePath(const BFSTree* tree, int target, int* path) {
+    int distance = tree->distance[target];
+    if (distance >= 0 && path) {
+        int crawl = target;
+        for (int i = distance; i >= 0; i--) {
+            path[i] = crawl;
+            crawl = tree->predecessor[crawl];
+        }
+    }
+    return distance;
+}
+
+// Função para liberar uma referência à árvore (a árvore é liberada com a última referência)
+void releaseBFSTree(BFSTree* tree) {
+    if (tree != NULL && atomic_fetch_sub(&tree->references, 1) == 1) {
+        free(tree->distance);
+        free(tree->predecessor);
+        free(tree);
+    }
+}
+
+// Função para criar o cache de árvores de BFS
+// memoryBudget: Orçamento de memória em bytes para as árvores em cache
+BFSTreeCache* createBFSTreeCache(size_t memoryBudget) {
+    BFSTreeCache* cache = (BFSTreeCache*)malloc(sizeof(BFSTreeCache));
+    if (!cache) exit(1);  // Verificação de alocação de memória
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->trees = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+    cache->memoryBudget = memoryBudget;
+    cache->memoryUsed = 0;
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    return cache;
+}
+
+// Retira do cache a árvore na posição i (a árvore continua viva enquanto houver referências)
+static void bfsTreeCacheDrop(BFSTreeCache* cache, int i) {
+    BFSTree* tree = cache->trees[i];
+    cache->memoryUsed -= bfsTreeBytes(tree->numUsers);
+    cache->trees[i] = cache->trees[--cache->count];
+    releaseBFSTree(tree);
+}
+
+// Função para liberar o cache de árvores de BFS
+void freeBFSTreeCache(BFSTreeCache* cache) {
+    if (cache != NULL) {
+        while (cache->count > 0) {
+            bfsTreeCacheDrop(cache, cache->count - 1);
+        }
+        free(cache->trees);
+        pthread_mutex_destroy(&cache->lock);
+        free(cache);
+    }
+}
+
+// Procura a árvore de uma origem; descarta a árvore se ela for de uma versão antiga do grafo
+// Deve ser chamada com o lock do cache; retorna a árvore com uma referência nova ou NULL
+static BFSTree* bfsTreeCacheLookup(BFSTreeCache* cache, int source, unsigned long long version) {
+    for (int i = 0; i < cache->count; i++) {
+        BFSTree* tree = cache->trees[i];
+        if (tree->source == source) {
+            if (tree->version != version) {
+                bfsTreeCacheDrop(cache, i);
+                return NULL;
+            }
+            tree->lastUse = ++cache->clock;
+            atomic_fetch_add(&tree->references, 1);
+            return tree;
+        }
+    }
+    return NULL;
+}
+
+// Função para obter a árvore de BFS de uma origem
+// graph: Ponteiro para o grafo
+// cache: Cache de árvores (pode ser compartilhado entre threads)
+// source: ID do usuário de origem
+// Retorna a árvore com uma referência para quem chamou (liberar com releaseBFSTree)
+BFSTree* acquireBFSTree(Graph* graph, BFSTreeCache* cache, int source) {
+    unsigned long long version = graph->version;
+    pthread_mutex_lock(&cache->lock);
+    BFSTree* tree = bfsTreeCacheLookup(cache, source, version);
+    if (tree) {
+        cache->hits++;
+        pthread_mutex_unlock(&cache->lock);
+        return tree;
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    // Falta: BFS fora do lock
+    BFSTree* built = buildBFSTree(graph, source);
+    size_t bytes = bfsTreeBytes(built->numUsers);
+    if (bytes > cache->memoryBudget) {
+        return built;  // A árvore não cabe no orçamento e fica só com quem chamou
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    tree = bfsTreeCacheLookup(cache, source, version);  // Outra thread pode ter construído a mesma árvore
+    if (tree) {
+        pthread_mutex_unlock(&cache->lock);
+        releaseBFSTree(built);
+        return tree;
+    }
+
+    // Descarta as árvores usadas há mais tempo até a nova caber no orçamento
+    while (cache->memoryUsed + bytes > cache->memoryBudget) {
+        int oldest = 0;
+        for (int i = 1; i < cache->count; i++) {
+            if (cache->trees[i]->lastUse < cache->trees[oldest]->lastUse) oldest = i;
+        }
+        bfsTreeCacheDrop(cache, oldest);
+    }
+
+    if (cache->count == cache->capacity) {
+        cache->capacity = cache->capacity ? 2 * cache->capacity : 4;
+        cache->trees = (BFSTree**)realloc(cache->trees, cache->capacity * sizeof(BFSTree*));
+        if (!cache->trees) exit(1);
+    }
+    built->lastUse = ++cache->clock;
+    atomic_fetch_add(&built->references, 1);  // Referência do cache
+    cache->trees[cache->count++] = built;
+    cache->memoryUsed += bytes;
+    pthread_mutex_unlock(&cache->lock);
+    return built;
+}
+
+// Função para consultar o menor caminho usando o cache de árvores de BFS
+// graph: Ponteiro para o grafo
+// cache: Cache de árvores
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// path: Array de saída com capacidade para numUsers IDs (NULL se só a distância interessa)
+// pathLength: Saída com o número de usuários no caminho (pode ser NULL)
+// Retorna a distância (-1 se não há caminho)
+int bfsTreeShortestPath(Graph* graph, BFSTreeCache* cache, int source, int target, int* path, int* pathLength) {
+    BFSTree* tree = acquireBFSTree(graph, cache, source);
+    int distance = bfsTreePath(tree, target, path);
+    releaseBFSTree(tree);
+    if (pathLength) *pathLength = distance + 1;
+    return distance;
+}
+
+/*
+20-etapa: Modo servidor de consultas
+
+Descrição:
+- O programa normal monta o grafo, responde uma consulta e termina, pagando toda a inicialização a cada
+  consulta. No modo servidor (`--server`) o grafo é carregado uma vez, a partir do grafo de exemplo ou de um
+  snapshot + log (17-etapa), e as consultas chegam pela entrada padrão ou por um socket Unix (`--socket`).
+- Protocolo de linhas (uma consulta por linha, respostas na mesma ordem):
+  - `PATH origem destino` -> `OK distancia id0 id1 ... idN` ou `NONE`
+  - `DIST origem destino` -> `OK distancia` ou `NONE`
+  - `MUTUAL a b` -> `OK quantidade id...`
+  - `KHOP usuario saltos` -> `OK quantidade id...` (em ordem de distância)
+  - `STATS` -> `OK {json}` com o resumo da instrumentação (compilada com ED_INSTRUMENTATION)
+  - `QUIT` encerra a conexão; uma linha inválida recebe `ERR mensagem`.
+- As consultas podem ser enviadas em sequência sem esperar as respostas. As linhas completas de cada leitura
+  formam um lote da conexão. Os lotes de todas as conexões entram em uma fila comum: enquanto uma rodada está
+  em execução, os lotes que chegam esperam, e a rodada seguinte junta todos eles. A rodada é ordenada por
+  origem, e as consultas PATH/DIST com a mesma origem, de qualquer conexão, viram uma única tarefa respondida
+  por uma árvore de BFS (19-etapa). As tarefas são executadas por um pool de threads.
+- O número de conexões simultâneas do socket é limitado (`SERVER_MAX_CONNECTIONS`); as demais esperam na fila
+  do `listen` até uma conexão terminar.
+- O grafo não é alterado no modo servidor, então as consultas paralelas são seguras.
+
+Funções:
+- `createGraphFromCSR`: Cria o grafo a partir de um CSR (snapshot recuperado).
+- `createQueryServer`: Cria o servidor e o pool de threads.
+- `freeQueryServer`: Encerra o pool e libera o servidor.
+- `serveConnection`: Atende uma conexão (entrada padrão ou socket) até o fim da entrada ou QUIT.
+- `listenSocketServer`: Cria o socket Unix do servidor e começa a escutar.
+- `runSocketServer`: Aceita conexões no socket, cada uma atendida por uma thread (até
+  `SERVER_MAX_CONNECTIONS` ao mesmo tempo).
+- `serverMain` (main.c): Trata os argumentos do modo servidor.
+*/
+
+#define SERVER_READ_SIZE 65536  // Bytes lidos por chamada; as linhas completas de uma leitura formam um lote
+#define SERVER_GROUP_SIZE 64  // Consultas MUTUAL/KHOP por tarefa
+#define SERVER_MAX_KHOP_RESULTS 10000  // Limite de membros em uma resposta KHOP
+#define SERVER_MAX_CONNECTIONS 64  // Conexões do socket atendidas ao mesmo tempo
+
+// Comandos do protocolo (PATH e DIST são respondidos pela mesma árvore de BFS)
+typedef enum ServerCommand {
+    COMMAND_PATH,
+    COMMAND_DIST,
+    COMMAND_MUTUAL,
+    COMMAND_KHOP,
+    COMMAND_STATS,  // Respondido depois que o lote termina
+    COMMAND_INVALID  // Resposta de erro já escrita na leitura
+} ServerCommand;
+
+// Estrutura para representar uma consulta do lote e a sua resposta
+typedef struct ServerRequest {
+    ServerCommand command;  // Comando
+    int a;  // Primeiro argumento (origem / usuário)
+    int b;  // Segundo argumento (destino / usuário / saltos)
+    char* response;  // Resposta formatada (reaproveitada entre lotes)
+    size_t length;  // Bytes da resposta
+    size_t capacity;  // Capacidade de response
+} ServerRequest;
+
+// Estrutura para ordenar as consultas de uma rodada por comando e origem
+typedef struct ServerOrder {
+    int group;  // 0 para PATH/DIST, comando para os demais
+    int a;  // Origem
+    int index;  // Posição da consulta no lote da conexão
+    ServerRequest* request;  // Consulta (no lote da conexão que a enviou)
+} ServerOrder;
+
+// Estrutura para representar um lote de consultas de uma conexão
+typedef struct ServerBatch {
+    ServerRequest* requests;  // Consultas na ordem de chegada
+    int count;  // Número de consultas
+    int capacity;  // Capacidade de requests
+    ServerOrder* order;  // Consultas válidas do lote
+    int numOrdered;  // Número de consultas em order
+    struct ServerBatch* next;  // Próximo lote na fila de espera do servidor
+    bool finished;  // true quando a rodada que incluiu o lote terminou
+} ServerBatch;
+
+// Estrutura para representar uma tarefa do pool: o intervalo order[begin .. end - 1] da rodada
+typedef struct ServerJob {
+    const ServerOrder* order;  // Consultas da rodada
+    int begin;  // Início do intervalo
+    int end;  // Fim do intervalo
+    struct ServerJob* next;  // Próxima tarefa na fila
+} ServerJob;
+
+// Estrutura para representar o servidor de consultas
+typedef struct QueryServer {
+    Graph* graph;  // Grafo consultado (somente leitura)
+    BFSTreeCache* trees;  // Cache de árvores de BFS compartilhado pelas threads
+    pthread_t* workers;  // Threads do pool
+    int numWorkers;  // Número de threads do pool
+    pthread_mutex_t lock;  // Protege a fila de tarefas
+    pthread_cond_t available;  // Sinalizada quando há tarefa ou o servidor está parando
+    ServerJob* head;  // Primeira tarefa da fila
+    ServerJob* tail;  // Última tarefa da fila
+    bool stopping;  // true quando as threads devem terminar
+    int pending;  // Tarefas da rodada ainda em execução (protegido por lock)
+    pthread_cond_t jobsDone;  // Sinalizada quando pending chega a zero
+    pthread_mutex_t batchLock;  // Protege waiting, dispatching e numConnections
+    pthread_cond_t roundDone;  // Sinalizada quando uma rodada termina
+    ServerBatch* waiting;  // Lotes das conexões esperando a próxima rodada
+    bool dispatching;  // true enquanto uma rodada está em execução
+    ServerOrder* round;  // Consultas da rodada (de todas as conexões)
+    int roundCapacity;  // Capacidade de round
+    pthread_cond_t connectionFree;  // Sinalizada quando uma conexão do socket termina
+    int numConnections;  // Conexões do socket em atendimento
+} QueryServer;
+
+// Função para criar o grafo a partir de um CSR
+// csr: CSR simétrico com os vizinhos ordenados (o grafo assume a posse do CSR)
+Graph* createGraphFromCSR(CSRGraph* csr) {
+    int n = csr->numUsers;
+    Graph* graph = createNumberedGraph(n);
+
+    // O CSR já tem as duas direções de cada conexão
+    for (int u = 0; u < n; u++) {
+        for (int e = csr->offsets[u + 1] - 1; e >= csr->offsets[u]; e--) {
+            AdjacencyNode* node = createNode(graph->users[csr->neighbors[e]]);
+            if (csr->weights) node->weight = csr->weights[e];
+            node->next = graph->adjList[u];
+            graph->adjList[u] = node;
+        }
+        graph->degree[u] = csr->offsets[u + 1] - csr->offsets[u];
+    }
+    graph->csr = csr;
+    graph->weighted = csr->weights != NULL;
+    return graph;
+}
+
+// Acrescenta texto formatado à resposta de uma consulta
+static void responsePrintf(ServerRequest* request, const char* format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        size_t room = request->capacity - request->length;
+        int needed = vsnprintf(request->response + request->length, room, format, args);
+        va_end(args);
+        if (needed < 0) exit(1);
+        if ((size_t)needed < room) {
+            request->length += (size_t)needed;
+            return;
+        }
+        request->capacity = 2 * request->capacity + (size_t)needed + 1;
+        request->response = (char*)realloc(request->response, request->capacity);
+        if (!request->response) exit(1);
+    }
+}
+
+// Acrescenta à resposta uma lista de inteiros, cada um precedido por um espaço (formatInt, 21-etapa)
+static void responseInts(ServerRequest* request, const int* values, int count) {
+    size_t needed = request->length + (size_t)count * 12;  // Espaço e até 11 caracteres por int
+    if (needed > request->capacity) {
+        request->capacity = 2 * needed;
+        request->response = (char*)realloc(request->response, request->capacity);
+        if (!request->response) exit(1);
+    }
+    for (int k = 0; k < count; k++) {
+        request->response[request->length++] = ' ';
+        request->length += (size_t)formatInt(values[k], request->response + request->length);
+    }
+}
+
+// Executa uma tarefa do lote
+// buffer: Array de numUsers ints da thread; scratch: Estado de BFS da thread
+static void serverRunJob(QueryServer* server, ServerJob* job, int* buffer, BFSScratch* scratch) {
+    Graph* graph = server->graph;
+    BFSTree* tree = NULL;
+
+    for (int i = job->begin; i < job->end; i++) {
+        ServerRequest* request = job->order[i].request;
+        switch (request->command) {
+            case COMMAND_PATH:
+            case COMMAND_DIST: {
+                // Todas as consultas PATH/DIST da tarefa têm a mesma origem
+                if (!tree) tree = acquireBFSTree(graph, server->trees, request->a);
+                int distance = bfsTreePath(tree, request->b, request->command == COMMAND_PATH ? buffer : NULL);
+                if (distance < 0) {
+                    responsePrintf(request, "NONE\n");
+                    break;
+                }
+                responsePrintf(request, "OK %d", distance);
+                if (request->command == COMMAND_PATH) {
+                    responseInts(request, buffer, distance + 1);
+                }
+                responsePrintf(request, "\n");
+                break;
+            }
+            case COMMAND_MUTUAL: {
+                int count = mutualFriends(graph, request->a, request->b, buffer);
+                responsePrintf(request, "OK %d", count);
+                responseInts(request, buffer, count);
+                responsePrintf(request, "\n");
+                break;
+            }
+            case COMMAND_KHOP: {
+                KHopResult result;
+                int count = kHopNeighborhood(graph, scratch, request->a, request->b, SERVER_MAX_KHOP_RESULTS, false, &result);
+                responsePrintf(request, "OK %d", count);
+                responseInts(request, result.members, count);
+                responsePrintf(request, "\n");
+                freeKHopResult(&result);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    releaseBFSTree(tree);
+}
+
+// Laço das threads do pool
+static void* serverWorker(void* arg) {
+    QueryServer* server = (QueryServer*)arg;
+    int* buffer = (int*)malloc((server->graph->numUsers + 1) * sizeof(int));
+    if (!buffer) exit(1);
+    BFSScratch* scratch = createBFSScratch(server->graph->numUsers);
+
+    for (;;) {
+        pthread_mutex_lock(&server->lock);
+        while (!server->head && !server->stopping) {
+            pthread_cond_wait(&server->available, &server->lock);
+        }
+        ServerJob* job = server->head;
+        if (!job) {
+            pthread_mutex_unlock(&server->lock);
+            break;  // Servidor parando e fila vazia
+        }
+        server->head = job->next;
+        if (!server->head) server->tail = NULL;
+        pthread_mutex_unlock(&server->lock);
+
+        serverRunJob(server, job, buffer, scratch);
+        free(job);
+
+        pthread_mutex_lock(&server->lock);
+        if (--server->pending == 0) pthread_cond_signal(&server->jobsDone);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    free(buffer);
+    freeBFSScratch(scratch);
+    return NULL;
+}
+
+// Função para criar o servidor de consultas
+// graph: Grafo consultado (não pode ser alterado enquanto o servidor existir)
+// numWorkers: Número de threads do pool
+// treeCacheBytes: Orçamento do cache de árvores de BFS
+QueryServer* createQueryServer(Graph* graph, int numWorkers, size_t treeCacheBytes) {
+    QueryServer* server = (QueryServer*)malloc(sizeof(QueryServer));
+    if (!server) exit(1);  // Verificação de alocação de memória
+    if (numWorkers < 1) numWorkers = 1;
+    getCSR(graph);  // Construído antes das threads, que só fazem leituras
+    server->graph = graph;
+    server->trees = createBFSTreeCache(treeCacheBytes);
+    server->numWorkers = numWorkers;
+    server->head = NULL;
+    server->tail = NULL;
+    server->stopping = false;
+    server->pending = 0;
+    server->waiting = NULL;
+    server->dispatching = false;
+    server->round = NULL;
+    server->roundCapacity = 0;
+    server->numConnections = 0;
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->available, NULL);
+    pthread_cond_init(&server->jobsDone, NULL);
+    pthread_mutex_init(&server->batchLock, NULL);
+    pthread_cond_init(&server->roundDone, NULL);
+    pthread_cond_init(&server->connectionFree, NULL);
+    server->workers = (pthread_t*)malloc(numWorkers * sizeof(pthread_t));
+    if (!server->workers) exit(1);
+    for (int i = 0; i < numWorkers; i++) {
+        pthread_create(&server->workers[i], NULL, serverWorker, server);
+    }
+    return server;
+}
+
+// Função para encerrar o pool de threads e liberar o servidor (o grafo não é liberado)
+void freeQueryServer(QueryServer* server) {
+    if (server != NULL) {
+        pthread_mutex_lock(&server->lock);
+        server->stopping = true;
+        pthread_cond_broadcast(&server->available);
+        pthread_mutex_unlock(&server->lock);
+        for (int i = 0; i < server->numWorkers; i++) {
+            pthread_join(server->workers[i], NULL);
+        }
+        free(server->workers);
+        free(server->round);
+        freeBFSTreeCache(server->trees);
+        pthread_mutex_destroy(&server->lock);
+        pthread_cond_destroy(&server->available);
+        pthread_cond_destroy(&server->jobsDone);
+        pthread_mutex_destroy(&server->batchLock);
+        pthread_cond_destroy(&server->roundDone);
+        pthread_cond_destroy(&server->connectionFree);
+        free(server);
+    }
+}
+
+// Compara duas consultas por grupo, origem e posição no lote da conexão
+static int compareServerOrder(const void* x, const void* y) {
+    const ServerOrder* a = (const ServerOrder*)x;
+    const ServerOrder* b = (const ServerOrder*)y;
+    if (a->group != b->group) return a->group < b->group ? -1 : 1;
+    if (a->a != b->a) return a->a < b->a ? -1 : 1;
+    return (a->index > b->index) - (a->index < b->index);
+}
+
+// Acrescenta uma linha ao lote; retorna false para QUIT
+static bool serverParseLine(QueryServer* server, ServerBatch* batch, char* line) {
+    size_t size = strlen(line);
+    if (size > 0 && line[size - 1] == '\r') line[--size] = '\0';
+    char command[16];
+    int a;
+    int b;
+    char extra;
+    int fields = sscanf(line, "%15s %d %d %c", command, &a, &b, &extra);
+    if (fields <= 0) {
+        return true;  // Linha vazia
+    }
+    if (fields == 1 && strcmp(command, "QUIT") == 0) {
+        return false;
+    }
+    bool stats = fields == 1 && strcmp(command, "STATS") == 0;
+
+    if (batch->count == batch->capacity) {
+        int capacity = batch->capacity ? 2 * batch->capacity : 64;
+        batch->requests = (ServerRequest*)realloc(batch->requests, capacity * sizeof(ServerRequest));
+        batch->order = (ServerOrder*)realloc(batch->order, capacity * sizeof(ServerOrder));
+        if (!batch->requests || !batch->order) exit(1);
+        for (int i = batch->capacity; i < capacity; i++) {
+            batch->requests[i].response = NULL;
+            batch->requests[i].capacity = 0;
+        }
+        batch->capacity = capacity;
+    }
+    ServerRequest* request = &batch->requests[batch->count++];
+    request->length = 0;
+    request->command = COMMAND_INVALID;
+
+    int n = server->graph->numUsers;
+    if (stats) {
+        request->command = COMMAND_STATS;
+        return true;
+    }
+    if (fields != 3) {
+        responsePrintf(request, "ERR comando invalido\n");
+        return true;
+    }
+    if (strcmp(command, "PATH") == 0) {
+        request->command = COMMAND_PATH;
+    } else if (strcmp(command, "DIST") == 0) {
+        request->command = COMMAND_DIST;
+    } else if (strcmp(command, "MUTUAL") == 0) {
+        request->command = COMMAND_MUTUAL;
+    } else if (strcmp(command, "KHOP") == 0) {
+        request->command = COMMAND_KHOP;
+    } else {
+        responsePrintf(request, "ERR comando invalido\n");
+        return true;
+    }
+    bool bIsUser = request->command != COMMAND_KHOP;
+    if (a < 0 || a >= n || b < 0 || (bIsUser && b >= n)) {
+        responsePrintf(request, "ERR usuario invalido\n");
+        return true;
+    }
+    if (!bIsUser && b > n - 1) {
+        b = n - 1;  // Nenhum usuário está a mais de n - 1 saltos
+    }
+
+    request->a = a;
+    request->b = b;
+    ServerOrder* entry = &batch->order[batch->numOrdered++];
+    entry->group = request->command <= COMMAND_DIST ? 0 : (int)request->command;
+    entry->a = a;
+    entry->index = batch->count - 1;
+    entry->request = NULL;  // Preenchido na rodada (requests ainda pode ser realocado)
+    return true;
+}
+
+// Executa uma rodada com os lotes de first em diante: junta as consultas, divide em tarefas, entrega ao pool e
+// espera todas terminarem (só uma rodada é executada por vez)
+static void serverRunRound(QueryServer* server, ServerBatch* first) {
+    int total = 0;
+    for (ServerBatch* batch = first; batch; batch = batch->next) {
+        total += batch->numOrdered;
+    }
+    if (total == 0) {
+        return;
+    }
+    if (total > server->roundCapacity) {
+        server->roundCapacity = 2 * total;
+        server->round = (ServerOrder*)realloc(server->round, server->roundCapacity * sizeof(ServerOrder));
+        if (!server->round) exit(1);
+    }
+    ServerOrder* order = server->round;
+    int count = 0;
+    for (ServerBatch* batch = first; batch; batch = batch->next) {
+        for (int i = 0; i < batch->numOrdered; i++) {
+            order[count] = batch->order[i];
+            order[count].request = &batch->requests[batch->order[i].index];
+            count++;
+        }
+    }
+    qsort(order, count, sizeof(ServerOrder), compareServerOrder);
+
+    // PATH/DIST: uma tarefa por origem; MUTUAL/KHOP: tarefas de até SERVER_GROUP_SIZE consultas
+    ServerJob* head = NULL;
+    ServerJob* last = NULL;
+    int numJobs = 0;
+    int begin = 0;
+    while (begin < count) {
+        int end = begin + 1;
+        const ServerOrder* leader = &order[begin];
+        while (end < count && order[end].group == leader->group &&
+               (leader->group == 0 ? order[end].a == leader->a : end - begin < SERVER_GROUP_SIZE)) {
+            end++;
+        }
+        ServerJob* job = (ServerJob*)malloc(sizeof(ServerJob));
+        if (!job) exit(1);
+        job->order = order;
+        job->begin = begin;
+        job->end = end;
+        job->next = NULL;
+        if (last) last->next = job; else head = job;
+        last = job;
+        numJobs++;
+        begin = end;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->pending = numJobs;
+    if (server->tail) server->tail->next = head; else server->head = head;
+    server->tail = last;
+    pthread_cond_broadcast(&server->available);
+    while (server->pending > 0) {
+        pthread_cond_wait(&server->jobsDone, &server->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+// Entrega o lote de uma conexão à fila comum e espera a rodada que o incluir terminar
+// A conexão que encontra o servidor livre executa a rodada com todos os lotes que estão esperando
+static void serverRunBatch(QueryServer* server, ServerBatch* batch) {
+    if (batch->numOrdered == 0) {
+        return;
+    }
+    pthread_mutex_lock(&server->batchLock);
+    batch->finished = false;
+    batch->next = server->waiting;
+    server->waiting = batch;
+    while (!batch->finished) {
+        if (server->dispatching) {
+            pthread_cond_wait(&server->roundDone, &server->batchLock);
+            continue;
+        }
+        ServerBatch* first = server->waiting;
+        server->waiting = NULL;
+        server->dispatching = true;
+        pthread_mutex_unlock(&server->batchLock);
+
+        INSTRUMENT_BEGIN(batchTimer);
+        serverRunRound(server, first);
+        INSTRUMENT_END(PHASE_SERVER_BATCH, batchTimer);
+
+        pthread_mutex_lock(&server->batchLock);
+        for (ServerBatch* done = first; done; done = done->next) {
+            done->finished = true;
+        }
+        server->dispatching = false;
+        pthread_cond_broadcast(&server->roundDone);
+    }
+    pthread_mutex_unlock(&server->batchLock);
+}
+
+// Função para atender uma conexão até o fim da entrada ou QUIT
+// server: Servidor de consultas
+// inFd: Descritor de onde as consultas são lidas
+// outFd: Descritor onde as respostas são escritas
+void serveConnection(QueryServer* server, int inFd, int outFd) {
+    size_t capacity = SERVER_READ_SIZE + 1;
+    size_t used = 0;
+    char* input = (char*)malloc(capacity);
+    char* output = NULL;
+    size_t outputCapacity = 0;
+    if (!input) exit(1);  // Verificação de alocação de memória
+
+    ServerBatch batch;
+    batch.requests = NULL;
+    batch.order = NULL;
+    batch.capacity = 0;
+
+    bool open = true;
+    while (open) {
+        if (used == capacity - 1) {
+            capacity *= 2;  // Linha maior que o buffer
+            input = (char*)realloc(input, capacity);
+            if (!input) exit(1);
+        }
+        ssize_t got = read(inFd, input + used, capacity - 1 - used);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            open = false;
+            if (used == 0) break;
+            input[used++] = '\n';  // Última linha sem quebra
+        } else {
+            used += (size_t)got;
+        }
+
+        // Cada linha completa vira uma consulta do lote
+        batch.count = 0;
+        batch.numOrdered = 0;
+        size_t start = 0;
+        for (size_t i = 0; i < used; i++) {
+            if (input[i] == '\n') {
+                input[i] = '\0';
+                bool keepGoing = serverParseLine(server, &batch, input + start);
+                start = i + 1;
+                if (!keepGoing) {
+                    open = false;
+                    break;
+                }
+            }
+        }
+        serverRunBatch(server, &batch);
+
+        // STATS é respondido depois do lote, já contando as suas consultas
+        for (int i = 0; i < batch.count; i++) {
+            if (batch.requests[i].command == COMMAND_STATS) {
+#ifdef ED_INSTRUMENTATION
+                char* text = NULL;
+                size_t size = 0;
+                FILE* out = open_memstream(&text, &size);
+                if (!out) exit(1);
+                instrumentationReport(out, true);
+                fclose(out);
+                responsePrintf(&batch.requests[i], "OK %s\n", text);
+                free(text);
+#else
+                responsePrintf(&batch.requests[i], "ERR instrumentacao desabilitada\n");
+#endif
+            }
+        }
+
+        // Junta as respostas em ordem de chegada e escreve de uma vez
+        size_t total = 0;
+        for (int i = 0; i < batch.count; i++) {
+            total += batch.requests[i].length;
+        }
+        if (total > outputCapacity) {
+            outputCapacity = 2 * total;
+            output = (char*)realloc(output, outputCapacity);
+            if (!output) exit(1);
+        }
+        size_t offset = 0;
+        for (int i = 0; i < batch.count; i++) {
+            memcpy(output + offset, batch.requests[i].response, batch.requests[i].length);
+            offset += batch.requests[i].length;
+        }
+        if (total > 0 && !writeAll(outFd, output, total)) {
+            open = false;  // Cliente desconectado
+        }
+
+        memmove(input, input + start, used - start);
+        used -= start;
+    }
+
+    for (int i = 0; i < batch.capacity; i++) {
+        free(batch.requests[i].response);
+    }
+    free(batch.requests);
+    free(batch.order);
+    free(input);
+    free(output);
+}
+
+// Estrutura para passar uma conexão à thread que a atende
+typedef struct ServerConnection {
+    QueryServer* server;  // Servidor de consultas
+    int fd;  // Socket da conexão
+} ServerConnection;
+
+// Thread que atende uma conexão do socket
+static void* serverConnectionThread(void* arg) {
+    ServerConnection* connection = (ServerConnection*)arg;
+    QueryServer* server = connection->server;
+    serveConnection(server, connection->fd, connection->fd);
+    close(connection->fd);
+    free(connection);
+
+    pthread_mutex_lock(&server->batchLock);
+    server->numConnections--;
+    pthread_cond_signal(&server->connectionFree);
+    pthread_mutex_unlock(&server->batchLock);
+    return NULL;
+}
+
+// Função para criar o socket Unix do servidor e começar a escutar
+// path: Caminho do socket (um arquivo existente com o mesmo nome é removido)
+// Retorna o descritor do socket, ou -1 se não for possível criá-lo
+int listenSocketServer(const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        return -1;
+    }
+    unlink(path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+// Função para aceitar conexões no socket do servidor (só retorna em caso de erro)
+// server: Servidor de consultas
+// listener: Socket criado por listenSocketServer (é fechado no retorno)
+// path: Caminho do socket (removido no retorno)
+void runSocketServer(QueryServer* server, int listener, const char* path) {
+    signal(SIGPIPE, SIG_IGN);  // Um cliente que desconecta não deve derrubar o servidor
+
+    for (;;) {
+        // Acima do limite, as novas conexões esperam na fila do listen
+        pthread_mutex_lock(&server->batchLock);
+        while (server->numConnections >= SERVER_MAX_CONNECTIONS) {
+            pthread_cond_wait(&server->connectionFree, &server->batchLock);
+        }
+        pthread_mutex_unlock(&server->batchLock);
+
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        ServerConnection* connection = (ServerConnection*)malloc(sizeof(ServerConnection));
+        if (!connection) exit(1);
+        connection->server = server;
+        connection->fd = fd;
+        pthread_mutex_lock(&server->batchLock);
+        server->numConnections++;
+        pthread_mutex_unlock(&server->batchLock);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, serverConnectionThread, connection) != 0) {
+            close(fd);
+            free(connection);
+            pthread_mutex_lock(&server->batchLock);
+            server->numConnections--;
+            pthread_mutex_unlock(&server->batchLock);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listener);
+    unlink(path);
+}
+
+
+/*
+21-etapa: Saída com buffer
+
+Descrição:
+- `printGraph` fazia várias chamadas a `printf` por conexão; ao despejar grafos com milhões de usuários, a
+  formatação e as chamadas de sistema dominavam o tempo.
+- `OutputBuffer` acumula a saída em um buffer grande e reutilizável e só a envia ao descritor com uma chamada
+  `write` por buffer cheio. O texto é produzido aos poucos (streaming): o grafo inteiro nunca fica em memória.
+- Os inteiros são formatados por `formatInt`, que converte dois dígitos por vez com uma tabela, sem `printf`.
+- Em grafos grandes, a listagem é limitada pelos acessos às listas encadeadas, não pela formatação: `outputGraph`
+  mantém um cursor alguns nós à frente que já pede ao processador os usuários que serão copiados.
+- Com descritor -1 o buffer só acumula em memória e cresce quando necessário; a 22-etapa usa esse modo para
+  formatar trechos do grafo em paralelo antes de escrevê-los em ordem.
+- A saída com buffer não passa pelo `stdout` da biblioteca C: quem mistura as duas deve chamar `fflush(stdout)`
+  antes de usar o buffer e `outputFlush` antes de voltar a usar `printf`.
+
+Funções:
+- `formatInt`: Escreve um inteiro em decimal e retorna o número de caracteres.
+- `createOutputBuffer`: Cria o buffer de saída de um descritor.
+- `outputFlush`: Envia o conteúdo acumulado ao descritor (com `writeAll`, 17-etapa).
+- `freeOutputBuffer`: Envia o que falta e libera o buffer.
+- `outputBytes`, `outputString`, `outputChar`, `outputInt`: Acrescentam texto ao buffer.
+- `outputPath`: Escreve os nomes de um caminho separados por " -> ".
+- `outputGraph`: Escreve a lista de conexões de cada usuário (mesmo formato de `printGraph`).
+*/
+
+// Estrutura para representar o buffer de saída
+typedef struct OutputBuffer {
+    int fd;  // Descritor de destino
+    char* data;  // Buffer
+    size_t size;  // Capacidade do buffer
+    size_t used;  // Bytes acumulados
+    bool failed;  // true se alguma escrita falhou
+} OutputBuffer;
+
+#define OUTPUT_LOOKAHEAD 16  // Nós percorridos à frente da formatação em outputGraph
+
+// Pares de dígitos "00" .. "99" usados por formatInt
+static const char digitPairs[201] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// Função para escrever um inteiro em decimal
+// value: Valor a formatar
+// out: Destino com espaço para pelo menos 20 caracteres (não é terminado com '\0')
+// Retorna o número de caracteres escritos
+int formatInt(long long value, char* out) {
+    char digits[20];
+    unsigned long long v = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+    int pos = 20;
+
+    // Dois dígitos por iteração
+    while (v >= 100) {
+        int pair = (int)(v % 100) * 2;
+        v /= 100;
+        digits[--pos] = digitPairs[pair + 1];
+        digits[--pos] = digitPairs[pair];
+    }
+    if (v >= 10) {
+        int pair = (int)v * 2;
+        digits[--pos] = digitPairs[pair + 1];
+        digits[--pos] = digitPairs[pair];
+    } else {
+        digits[--pos] = (char)('0' + v);
+    }
+
+    int length = 0;
+    if (value < 0) {
+        out[length++] = '-';
+    }
+    memcpy(out + length, digits + pos, 20 - pos);
+    return length + 20 - pos;
+}
+
+// Função para criar o buffer de saída
+// fd: Descritor de destino (por exemplo, STDOUT_FILENO), ou -1 para só acumular em memória (o buffer cresce)
+// size: Capacidade do buffer em bytes (OUTPUT_BUFFER_SIZE é um bom padrão)
+OutputBuffer* createOutputBuffer(int fd, size_t size) {
+    OutputBuffer* out = (OutputBuffer*)malloc(sizeof(OutputBuffer));
+    if (!out) exit(1);  // Verificação de alocação de memória
+    out->fd = fd;
+    out->size = size < 64 ? 64 : size;  // Cabe pelo menos um inteiro formatado
+    out->data = (char*)malloc(out->size);
+    if (!out->data) exit(1);
+    out->used = 0;
+    out->failed = false;
+    return out;
+}
+
+// Função para enviar o conteúdo acumulado ao descritor (não faz nada em um buffer em memória)
+// Retorna false se alguma escrita falhou desde a criação do buffer
+bool outputFlush(OutputBuffer* out) {
+    if (out->fd < 0) {
+        return true;
+    }
+    if (out->used > 0 && !out->failed) {
+        out->failed = !writeAll(out->fd, out->data, out->used);
+    }
+    out->used = 0;
+    return !out->failed;
+}
+
+// Garante espaço livre para length bytes: envia o conteúdo ao descritor ou, em memória, aumenta o buffer
+static void outputReserve(OutputBuffer* out, size_t length) {
+    if (out->size - out->used >= length) {
+        return;
+    }
+    outputFlush(out);
+    if (out->size - out->used < length) {
+        while (out->size - out->used < length) {
+            out->size *= 2;
+        }
+        out->data = (char*)realloc(out->data, out->size);
+        if (!out->data) exit(1);  // Verificação de alocação de memória
+    }
+}
+
+// Função para enviar o que falta e liberar o buffer de saída
+// Retorna false se alguma escrita falhou
+bool freeOutputBuffer(OutputBuffer* out) {
+    bool ok = outputFlush(out);
+    free(out->data);
+    free(out);
+    return ok;
+}
+
+// Função para acrescentar bytes ao buffer
+// data: Bytes a escrever
+// length: Número de bytes
+void outputBytes(OutputBuffer* out, const char* data, size_t length) {
+    if (out->fd >= 0 && length > out->size - out->used) {
+        outputFlush(out);
+        if (length >= out->size) {
+            // Maior que o buffer: vai direto para o descritor
+            if (!out->failed) out->failed = !writeAll(out->fd, data, length);
+            return;
+        }
+    }
+    outputReserve(out, length);
+    memcpy(out->data + out->used, data, length);
+    out->used += length;
+}
+
+// Função para acrescentar uma string terminada em '\0'
+void outputString(OutputBuffer* out, const char* text) {
+    outputBytes(out, text, strlen(text));
+}
+
+// Função para acrescentar um caractere
+void outputChar(OutputBuffer* out, char c) {
+    outputReserve(out, 1);
+    out->data[out->used++] = c;
+}
+
+// Função para acrescentar um inteiro em decimal
+void outputInt(OutputBuffer* out, long long value) {
+    outputReserve(out, 20);
+    out->used += (size_t)formatInt(value, out->data + out->used);
+}
+
+// Função para escrever os nomes de um caminho
+// graph: Ponteiro para o grafo
+// result: Caminho encontrado
+void outputPath(OutputBuffer* out, Graph* graph, const PathResult* result) {
+    for (int i = 0; i < result->length; i++) {
+        outputString(out, graph->users[result->path[i]]->nome);
+        if (i < result->length - 1) {
+            outputBytes(out, " -> ", 4);
+        }
+    }
+}
+
+// Cursor que percorre todas as listas de adjacências em ordem, à frente da formatação em outputGraph
+typedef struct GraphCursor {
+    int row;  // Próxima lista a iniciar
+    AdjacencyNode* node;  // Nó atual (NULL no fim)
+} GraphCursor;
+
+// Avança o cursor um nó e pede ao processador o usuário desse nó
+static inline void graphCursorAdvance(Graph* graph, GraphCursor* cursor) {
+    if (cursor->node) cursor->node = cursor->node->next;
+    while (!cursor->node && cursor->row < graph->numUsers) {
+        cursor->node = graph->adjList[cursor->row++];
+    }
+    if (cursor->node) __builtin_prefetch(cursor->node->user);
+}
+
+// Função para escrever a lista de conexões de cada usuário
+// graph: Ponteiro para o grafo
+void outputGraph(OutputBuffer* out, Graph* graph) {
+    // O cursor fica OUTPUT_LOOKAHEAD nós à frente: quando um nome é copiado, o nó e o usuário já estão em cache
+    GraphCursor ahead = {0, NULL};
+    for (int k = 0; k < OUTPUT_LOOKAHEAD; k++) {
+        graphCursorAdvance(graph, &ahead);
+    }
+
+    for (int i = 0; i < graph->numUsers; i++) {
+        outputString(out, graph->users[i]->nome);
+        outputBytes(out, " (", 2);
+        outputInt(out, graph->users[i]->id);
+        outputBytes(out, "): ", 3);
+        AdjacencyNode* temp = graph->adjList[i];
+
+        // Se a lista de adjacências estiver vazia, apenas escreve "(nenhuma conexão)"
+        if (temp == NULL) {
+            outputString(out, "(nenhuma conexao)");
+        }
+        for (bool firstConnection = true; temp; temp = temp->next, firstConnection = false) {
+            graphCursorAdvance(graph, &ahead);
+            outputReserve(out, MAX_NAME_LENGTH + 2);
+            char* dst = out->data + out->used;
+            if (!firstConnection) {
+                *dst++ = ',';  // Adiciona uma vírgula entre as conexões
+                *dst++ = ' ';
+            }
+            size_t length = strlen(temp->user->nome);
+            memcpy(dst, temp->user->nome, length);
+            out->used = (size_t)(dst + length - out->data);
+        }
+        outputChar(out, '\n');
+    }
+}
+
+/*
+22-etapa: Exportação para Graphviz (DOT) e GraphML
+
+Descrição:
+- O README traz, para cada execução, o código DOT escrito à mão com o grafo e os caminhos destacados (menor
+  caminho em azul, maior caminho entre dois usuários em verde e maior caminho do grafo em vermelho).
+  `exportGraph` gera esse código direto do grafo, em DOT ou em GraphML.
+- Exporta o grafo inteiro ou só um subconjunto de usuários, por exemplo os membros de uma vizinhança de k saltos
+  (9-etapa). Só aparecem as conexões entre usuários exportados, cada uma uma única vez. No modo de seguidores
+  (24-etapa) o grafo é exportado como direcionado, com todas as conexões de saída.
+- Para grafos enormes há amostragem determinística de usuários (fração e semente) e cortes por grau mínimo e
+  máximo (esconder folhas ou hubs), para que o desenho continue utilizável e a exportação rápida.
+- Os usuários de cada caminho destacado são sempre exportados, mesmo fora do subconjunto ou dos filtros.
+- Os usuários são divididos em trechos formatados em paralelo (OpenMP), cada um em um `OutputBuffer` em memória
+  (21-etapa). Os trechos são copiados em ordem para a saída a cada rodada, o que limita a memória usada.
+- Os caminhos destacados vêm depois das conexões, cada um com sua cor; no DOT, o início e o fim de cada caminho
+  recebem as formas Mdiamond e Msquare, como no README.
+
+Funções:
+- `initExportOptions`: Preenche as opções padrão (DOT, grafo inteiro, sem filtros).
+- `exportGraph`: Escreve o grafo no formato escolhido.
+*/
+
+#define EXPORT_CHUNK_USERS 4096  // Usuários por trecho formatado por uma thread
+#define EXPORT_ROUND_CHUNKS 64  // Trechos formatados por rodada antes da escrita
+
+// Função para preencher as opções padrão de exportação
+void initExportOptions(ExportOptions* options) {
+    options->format = EXPORT_DOT;
+    options->members = NULL;
+    options->numMembers = 0;
+    options->sampleRate = 1.0;
+    options->seed = 0;
+    options->minDegree = 0;
+    options->maxDegree = 0;
+    options->highlights = NULL;
+    options->numHighlights = 0;
+}
+
+// Escreve um texto escapado: entre aspas no DOT, como conteúdo XML no GraphML
+static void outputEscaped(OutputBuffer* out, const char* text, ExportFormat format) {
+    for (; *text; text++) {
+        char c = *text;
+        if (format == EXPORT_DOT) {
+            if (c == '"' || c == '\\') outputChar(out, '\\');
+            outputChar(out, c);
+        } else if (c == '&') {
+            outputBytes(out, "&amp;", 5);
+        } else if (c == '<') {
+            outputBytes(out, "&lt;", 4);
+        } else if (c == '>') {
+            outputBytes(out, "&gt;", 4);
+        } else if (c == '"') {
+            outputBytes(out, "&quot;", 6);
+        } else {
+            outputChar(out, c);
+        }
+    }
+}
+
+// Escreve uma conexão; color é NULL para uma conexão comum
+static void exportEdge(OutputBuffer* out, int u, int v, const char* color, bool directed, ExportFormat format) {
+    if (format == EXPORT_DOT) {
+        outputBytes(out, "  ", 2);
+        outputInt(out, u);
+        outputBytes(out, directed ? " -> " : " -- ", 4);
+        outputInt(out, v);
+        if (color) {
+            outputBytes(out, " [color=", 8);
+            outputString(out, color);
+            outputBytes(out, ", penwidth=2]", 13);
+        }
+        outputBytes(out, ";\n", 2);
+    } else {
+        outputBytes(out, "    <edge source=\"n", 19);
+        outputInt(out, u);
+        outputBytes(out, "\" target=\"n", 11);
+        outputInt(out, v);
+        if (color) {
+            outputBytes(out, "\"><data key=\"color\">", 20);
+            outputEscaped(out, color, format);
+            outputBytes(out, "</data></edge>\n", 15);
+        } else {
+            outputBytes(out, "\"/>\n", 4);
+        }
+    }
+}
+
+// Escreve os usuários order[begin .. end - 1] e as suas conexões com usuários exportados de ID maior
+// (em um grafo direcionado, todas as conexões de saída para usuários exportados)
+static void exportUsers(OutputBuffer* out, Graph* graph, const int* order, int begin, int end,
+                        const unsigned char* included, const int* adjBegin, const int* adjEnd,
+                        const int* neighbors, ExportFormat format) {
+    for (int i = begin; i < end; i++) {
+        int u = order[i];
+        if (format == EXPORT_DOT) {
+            outputBytes(out, "  ", 2);
+            outputInt(out, u);
+            outputBytes(out, " [label=\"", 9);
+            outputEscaped(out, graph->users[u]->nome, format);
+            outputBytes(out, "\"];\n", 4);
+        } else {
+            outputBytes(out, "    <node id=\"n", 15);
+            outputInt(out, u);
+            outputBytes(out, "\"><data key=\"name\">", 19);
+            outputEscaped(out, graph->users[u]->nome, format);
+            outputBytes(out, "</data></node>\n", 15);
+        }
+        for (int e = adjBegin[u]; e < adjEnd[u]; e++) {
+            int v = neighbors[e];
+            if ((graph->directed || v > u) && included[v]) {
+                exportEdge(out, u, v, NULL, graph->directed, format);
+            }
+        }
+    }
+}
+
+// Função para exportar o grafo para o Graphviz (DOT) ou GraphML
+// out: Saída com buffer (21-etapa)
+// graph: Ponteiro para o grafo
+// options: Formato, subconjunto de usuários, filtros e caminhos destacados (ver initExportOptions)
+// Retorna o número de usuários exportados
+int exportGraph(OutputBuffer* out, Graph* graph, const ExportOptions* options) {
+    int n = graph->numUsers;
+    ExportFormat format = options->format;
+    unsigned char* included = (unsigned char*)calloc(n > 0 ? n : 1, sizeof(unsigned char));
+    if (!included) exit(1);  // Verificação de alocação de memória
+
+    // Usuários candidatos (todos ou o subconjunto) que passam pela amostragem e pelos cortes de grau
+    int numCandidates = options->members ? options->numMembers : n;
+    for (int i = 0; i < numCandidates; i++) {
+        int v = options->members ? options->members[i] : i;
+        if (v < 0 || v >= n) continue;
+        int degree = graph->degree[v];
+        if (degree < options->minDegree || (options->maxDegree > 0 && degree > options->maxDegree)) continue;
+        if (options->sampleRate < 1.0) {
+            unsigned long long state = options->seed + (unsigned long long)v * 0x9E3779B97F4A7C15ull;
+            if ((splitMix64(&state) >> 11) * (1.0 / 9007199254740992.0) >= options->sampleRate) continue;
+        }
+        included[v] = 1;
+    }
+    for (int h = 0; h < options->numHighlights; h++) {
+        const PathResult* path = options->highlights[h].path;
+        for (int i = 0; i < path->length; i++) {
+            included[path->path[i]] = 1;
+        }
+    }
+
+    // Ordem de escrita: IDs crescentes
+    int count = 0;
+    for (int v = 0; v < n; v++) {
+        count += included[v];
+    }
+    int* order = (int*)malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!order) exit(1);
+    count = 0;
+    for (int v = 0; v < n; v++) {
+        if (included[v]) order[count++] = v;
+    }
+
+    if (format == EXPORT_DOT) {
+        outputString(out, graph->directed ? "digraph " : "graph ");
+        outputString(out, "SocialNetwork {\n"
+                          "  // Definindo estilos para os nós\n"
+                          "  node [shape=circle, style=filled, color=lightgrey];\n\n"
+                          "  // Definindo os nós e suas conexões\n");
+    } else {
+        outputString(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                          "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+                          "  <key id=\"name\" for=\"node\" attr.name=\"name\" attr.type=\"string\"/>\n"
+                          "  <key id=\"color\" for=\"edge\" attr.name=\"color\" attr.type=\"string\"/>\n"
+                          "  <graph id=\"SocialNetwork\" edgedefault=\"");
+        outputString(out, graph->directed ? "directed\">\n" : "undirected\">\n");
+    }
+
+    // Trechos formatados em paralelo e escritos em ordem, rodada a rodada
+    const int* adjBegin;
+    const int* adjEnd;
+    const int* neighbors;
+    graphAdjacency(graph, &adjBegin, &adjEnd, &neighbors);  // Antes da região paralela
+    OutputBuffer* chunks[EXPORT_ROUND_CHUNKS];
+    for (int c = 0; c < EXPORT_ROUND_CHUNKS; c++) {
+        chunks[c] = createOutputBuffer(-1, 1 << 16);
+    }
+    for (int first = 0; first < count; first += EXPORT_CHUNK_USERS * EXPORT_ROUND_CHUNKS) {
+        int numChunks = (count - first + EXPORT_CHUNK_USERS - 1) / EXPORT_CHUNK_USERS;
+        if (numChunks > EXPORT_ROUND_CHUNKS) numChunks = EXPORT_ROUND_CHUNKS;
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int c = 0; c < numChunks; c++) {
+            int begin = first + c * EXPORT_CHUNK_USERS;
+            int end = begin + EXPORT_CHUNK_USERS < count ? begin + EXPORT_CHUNK_USERS : count;
+            exportUsers(chunks[c], graph, order, begin, end, included, adjBegin, adjEnd, neighbors, format);
+        }
+
+        for (int c = 0; c < numChunks; c++) {
+            outputBytes(out, chunks[c]->data, chunks[c]->used);
+            chunks[c]->used = 0;
+        }
+    }
+    for (int c = 0; c < EXPORT_ROUND_CHUNKS; c++) {
+        freeOutputBuffer(chunks[c]);
+    }
+
+    // Caminhos destacados
+    for (int h = 0; h < options->numHighlights; h++) {
+        const ExportHighlight* highlight = &options->highlights[h];
+        if (format == EXPORT_DOT) {
+            outputBytes(out, "\n  // Destacando ", 17);
+            outputString(out, highlight->label ? highlight->label : "caminho");
+            outputBytes(out, " (", 2);
+            outputString(out, highlight->color);
+            outputBytes(out, ")\n", 2);
+        }
+        for (int i = 0; i + 1 < highlight->path->length; i++) {
+            exportEdge(out, highlight->path->path[i], highlight->path->path[i + 1], highlight->color, graph->directed, format);
+        }
+    }
+    if (format == EXPORT_DOT) {
+        bool first = true;
+        for (int h = 0; h < options->numHighlights; h++) {
+            const ExportHighlight* highlight = &options->highlights[h];
+            if (highlight->path->length == 0) continue;
+            if (first) {
+                outputString(out, "\n  // Destacando nós de início e fim\n");
+                first = false;
+            }
+            for (int end = 0; end < 2; end++) {
+                outputBytes(out, "  ", 2);
+                outputInt(out, end ? highlight->path->path[highlight->path->length - 1] : highlight->path->path[0]);
+                outputString(out, end ? " [shape=Msquare, color=" : " [shape=Mdiamond, color=");
+                outputString(out, highlight->color);
+                outputBytes(out, "];\n", 3);
+            }
+        }
+        outputBytes(out, "}\n", 2);
+    } else {
+        outputString(out, "  </graph>\n</graphml>\n");
+    }
+
+    free(order);
+    free(included);
+    return count;
+}
+
+/*
+23-etapa: Conexões com peso (Dijkstra com heap radix e delta-stepping)
+
+Descrição:
+- Cada conexão pode ter um peso inteiro não negativo (força do vínculo, custo de interação). O peso fica no nó da
+  lista de adjacência e, no CSR, em `weights`, um array paralelo a `neighbors`. Grafos sem pesos não alocam
+  esse array e as buscas continuam usando a BFS.
+- As cópias derivadas do CSR (subgrafos, renumeração, CSR com folga, snapshots e o log de conexões) não levam
+  os pesos; um grafo com pesos sempre copia o CSR das listas.
+- Consultas de ponto a ponto (`weightedShortestPath`) usam Dijkstra com um heap radix: as chaves são distâncias
+  inteiras e nunca diminuem abaixo da última retirada, então cada entrada fica em um de 65 baldes conforme o bit
+  mais alto em que difere da última chave, e só muda de balde O(log W) vezes. O estado fica em um
+  `DijkstraScratch` reutilizável com carimbos (sem limpar arrays a cada consulta).
+- Distâncias de uma origem para todos (`weightedDistances`) usam delta-stepping em paralelo (OpenMP): os usuários
+  são agrupados em baldes de largura delta pela distância provisória, e todos os usuários do menor balde são
+  relaxados ao mesmo tempo, com mínimo atômico nas distâncias. Cada thread guarda os seus próprios baldes.
+  - Os números dos baldes são de 64 bits. Cada thread tem um anel fixo de `DELTA_RING_BINS` baldes, a janela a
+    partir do balde atual, e uma lista de usuários distantes para o que cai além da janela. Quando a janela
+    avança sobre baldes da lista distante (ou salta para eles, se o anel esvaziar), esses usuários passam para
+    o anel. A memória não depende de distância máxima / delta.
+- Pesos negativos são recusados por `addWeightedConnection` (as duas buscas supõem pesos não negativos).
+
+Funções:
+- `addWeightedConnection`: Adiciona uma conexão com peso (recusa pesos negativos).
+- `generateRandomWeights`: Sorteia pesos para as conexões existentes (os dois sentidos recebem o mesmo peso).
+- `createDijkstraScratch`: Aloca o estado reutilizável das consultas com peso.
+- `freeDijkstraScratch`: Libera o estado das consultas com peso.
+- `weightedShortestPath`: Menor caminho ponderado entre dois usuários (BFS se o grafo não tem pesos).
+- `weightedDistances`: Distâncias ponderadas de uma origem para todos os usuários.
+*/
+
+#define RADIX_BUCKETS 65  // Balde 0 (chave igual à última) e um balde por bit mais alto diferente
+
+// Estrutura para representar uma entrada do heap radix
+typedef struct RadixEntry {
+    unsigned long long key;  // Distância provisória
+    int vertex;  // ID do usuário
+} RadixEntry;
+
+// Estrutura para representar o heap radix (chaves monótonas)
+typedef struct RadixHeap {
+    RadixEntry* buckets[RADIX_BUCKETS];  // Entradas de cada balde
+    int sizes[RADIX_BUCKETS];  // Número de entradas de cada balde
+    int capacities[RADIX_BUCKETS];  // Capacidade de cada balde
+    unsigned long long last;  // Última chave retirada
+    int size;  // Número total de entradas
+} RadixHeap;
+
+// Estrutura com o estado reutilizável das consultas com peso
+typedef struct DijkstraScratch {
+    int numUsers;  // Número de usuários do grafo
+    int* stamp;  // stamp[v] == currentStamp quando distance[v] vale para a consulta atual
+    int currentStamp;  // Carimbo da consulta atual
+    long long* distance;  // Distância provisória de cada usuário
+    int* predecessor;  // Predecessor de cada usuário no melhor caminho encontrado
+    RadixHeap heap;  // Fila de prioridade
+    BFSScratch* bfs;  // Estado da BFS usada em grafos sem pesos
+} DijkstraScratch;
+
+// Balde de uma chave em relação à última chave retirada
+static inline int radixBucket(unsigned long long key, unsigned long long last) {
+    return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+// Insere uma entrada no balde indicado
+static void radixAppend(RadixHeap* heap, int bucket, unsigned long long key, int vertex) {
+    if (heap->sizes[bucket] == heap->capacities[bucket]) {
+        heap->capacities[bucket] = heap->capacities[bucket] ? 2 * heap->capacities[bucket] : 16;
+        heap->buckets[bucket] = (RadixEntry*)realloc(heap->buckets[bucket], heap->capacities[bucket] * sizeof(RadixEntry));
+        if (!heap->buckets[bucket]) exit(1);  // Verificação de alocação de memória
+    }
+    heap->buckets[bucket][heap->sizes[bucket]++] = (RadixEntry){key, vertex};
+}
+
+// Insere uma chave (nunca menor que a última retirada)
+static void radixPush(RadixHeap* heap, unsigned long long key, int vertex) {
+    radixAppend(heap, radixBucket(key, heap->last), key, vertex);
+    heap->size++;
+}
+
+// Retira uma entrada de chave mínima (o heap não pode estar vazio)
+static RadixEntry radixPop(RadixHeap* heap) {
+    if (heap->sizes[0] == 0) {
+        // Redistribui o primeiro balde não vazio a partir da sua menor chave; todas as entradas descem de balde
+        int i = 1;
+        while (heap->sizes[i] == 0) {
+            i++;
+        }
+        unsigned long long minimum = heap->buckets[i][0].key;
+        for (int k = 1; k < heap->sizes[i]; k++) {
+            if (heap->buckets[i][k].key < minimum) minimum = heap->buckets[i][k].key;
+        }
+        heap->last = minimum;
+        for (int k = 0; k < heap->sizes[i]; k++) {
+            RadixEntry entry = heap->buckets[i][k];
+            radixAppend(heap, radixBucket(entry.key, minimum), entry.key, entry.vertex);
+        }
+        heap->sizes[i] = 0;
+    }
+    heap->size--;
+    return heap->buckets[0][--heap->sizes[0]];
+}
+
+// Esvazia o heap mantendo os baldes alocados
+static void radixClear(RadixHeap* heap) {
+    for (int i = 0; i < RADIX_BUCKETS; i++) {
+        heap->sizes[i] = 0;
+    }
+    heap->last = 0;
+    heap->size = 0;
+}
+
+// Função para adicionar uma conexão com peso entre dois usuários
+// graph: Ponteiro para o grafo
+// src, dest: IDs dos usuários
+// weight: Peso da conexão (>= 0), o mesmo nos dois sentidos
+// Retorna false se o peso for negativo (a conexão não é criada)
+bool addWeightedConnection(Graph* graph, int src, int dest, int weight) {
+    if (weight < 0) {
+        return false;
+    }
+    addConnection(graph, src, dest);
+    graph->adjList[src]->weight = weight;  // addConnection insere no início das listas
+    graph->adjList[dest]->weight = weight;
+    if (graph->directed) {
+        graph->inList[src]->weight = weight;
+        graph->inList[dest]->weight = weight;
+    }
+    graph->weighted = true;
+    return true;
+}
+
+// Peso sorteado de uma conexão: depende só da semente e do par (o mesmo nos dois sentidos)
+static int randomConnectionWeight(int u, int v, int maxWeight, unsigned int seed) {
+    unsigned long long state = ((unsigned long long)seed << 40) ^ ((unsigned long long)(u < v ? u : v) << 20) ^
+                               (unsigned long long)(u < v ? v : u) * 0x9E3779B97F4A7C15ull;
+    return 1 + (int)(splitMix64(&state) % (unsigned long long)maxWeight);
+}
+
+// Função para sortear pesos para as conexões existentes
+// graph: Ponteiro para o grafo
+// maxWeight: Peso máximo (os pesos ficam entre 1 e maxWeight)
+// seed: Semente (o peso de cada conexão depende só da semente e dos dois usuários)
+void generateRandomWeights(Graph* graph, int maxWeight, unsigned int seed) {
+    if (maxWeight < 1) maxWeight = 1;
+    for (int u = 0; u < graph->numUsers; u++) {
+        for (AdjacencyNode* temp = graph->adjList[u]; temp; temp = temp->next) {
+            temp->weight = randomConnectionWeight(u, temp->user->id, maxWeight, seed);
+        }
+        // Em um grafo direcionado, a lista de entrada recebe o mesmo peso
+        for (AdjacencyNode* temp = graph->directed ? graph->inList[u] : NULL; temp; temp = temp->next) {
+            temp->weight = randomConnectionWeight(u, temp->user->id, maxWeight, seed);
+        }
+    }
+    graph->weighted = true;
+
+    // O CSR em cache não tem os pesos novos
+    graph->version++;
+    freeCSR(graph->csr);
+    graph->csr = NULL;
+    freeCSR(graph->reverseCSR);
+    graph->reverseCSR = NULL;
+    freeCSR(graph->undirectedCSR);
+    graph->undirectedCSR = NULL;
+}
+
+// Função para criar o estado reutilizável das consultas com peso
+// numUsers: Número de usuários do grafo
+DijkstraScratch* createDijkstraScratch(int numUsers) {
+    DijkstraScratch* scratch = (DijkstraScratch*)calloc(1, sizeof(DijkstraScratch));
+    if (!scratch) exit(1);  // Verificação de alocação de memória
+    scratch->numUsers = numUsers;
+    scratch->stamp = (int*)calloc(numUsers > 0 ? numUsers : 1, sizeof(int));
+    scratch->distance = (long long*)malloc((numUsers > 0 ? numUsers : 1) * sizeof(long long));
+    scratch->predecessor = (int*)malloc((numUsers > 0 ? numUsers : 1) * sizeof(int));
+    if (!scratch->stamp || !scratch->distance || !scratch->predecessor) exit(1);
+    scratch->currentStamp = 0;
+    scratch->bfs = createBFSScratch(numUsers);
+    return scratch;
+}
+
+// Função para liberar o estado das consultas com peso
+void freeDijkstraScratch(DijkstraScratch* scratch) {
+    if (scratch != NULL) {
+        for (int i = 0; i < RADIX_BUCKETS; i++) {
+            free(scratch->heap.buckets[i]);
+        }
+        free(scratch->stamp);
+        free(scratch->distance);
+        free(scratch->predecessor);
+        freeBFSScratch(scratch->bfs);
+        free(scratch);
+    }
+}
+
+// Inicia uma nova consulta: avança o carimbo e esvazia o heap
+// Retorna o carimbo da consulta
+static int dijkstraScratchReset(DijkstraScratch* scratch) {
+    if (scratch->currentStamp == INT_MAX) {
+        memset(scratch->stamp, 0, scratch->numUsers * sizeof(int));
+        scratch->currentStamp = 0;
+    }
+    radixClear(&scratch->heap);
+    return ++scratch->currentStamp;
+}
+
+// Função para encontrar o menor caminho ponderado entre dois usuários
+// graph: Ponteiro para o grafo
+// scratch: Estado reutilizável (createDijkstraScratch)
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// result: Resultado; path é o buffer do chamador e result->distance recebe o número de conexões do caminho
+// Retorna a soma dos pesos do caminho (-1 se não há caminho); em grafos sem pesos, o número de conexões (BFS)
+long long weightedShortestPath(Graph* graph, DijkstraScratch* scratch, int source, int target, PathResult* result) {
+    if (!graph->weighted) {
+        shortestPath(graph, scratch->bfs, source, target, result);
+        return result->distance;  // -1 se não há caminho
+    }
+
+    INSTRUMENT_BEGIN(searchTimer);
+    CSRGraph* csr = getCSR(graph);
+    int stamp = dijkstraScratchReset(scratch);
+    RadixHeap* heap = &scratch->heap;
+
+    scratch->stamp[source] = stamp;
+    scratch->distance[source] = 0;
+    scratch->predecessor[source] = -1;
+    radixPush(heap, 0, source);
+    long long found = -1;
+
+    while (heap->size > 0) {
+        RadixEntry entry = radixPop(heap);
+        int u = entry.vertex;
+        if ((long long)entry.key > scratch->distance[u]) {
+            continue;  // Entrada antiga: u já saiu do heap com uma distância menor
+        }
+        INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, 1);
+        if (u == target) {
+            found = (long long)entry.key;
+            break;
+        }
+        for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+            int v = csr->neighbors[e];
+            long long candidate = (long long)entry.key + csr->weights[e];
+            INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, 1);
+            if (scratch->stamp[v] != stamp || candidate < scratch->distance[v]) {
+                scratch->stamp[v] = stamp;
+                scratch->distance[v] = candidate;
+                scratch->predecessor[v] = u;
+                radixPush(heap, (unsigned long long)candidate, v);
+            }
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+
+    // Reconstrói o caminho a partir dos predecessores
+    result->length = 0;
+    result->distance = -1;
+    if (found < 0) {
+        return -1;
+    }
+    int length = 0;
+    for (int crawl = target; crawl != -1; crawl = scratch->predecessor[crawl]) {
+        length++;
+    }
+    result->distance = length - 1;
+    if (length <= result->capacity) {
+        result->length = length;
+        int crawl = target;
+        for (int i = length - 1; i >= 0; i--) {
+            result->path[i] = crawl;
+            crawl = scratch->predecessor[crawl];
+        }
+    }
+    return found;
+}
+
+#define DELTA_RING_BINS 256  // Baldes do anel de cada thread (janela a partir do balde atual)
+
+// Estrutura para representar um balde local da delta-stepping
+typedef struct DeltaBin {
+    int* items;  // Usuários do balde (podem se repetir)
+    int count;  // Número de usuários
+    int capacity;  // Capacidade de items
+} DeltaBin;
+
+// Estrutura para representar os baldes de uma thread
+typedef struct DeltaBuckets {
+    DeltaBin ring[DELTA_RING_BINS];  // Balde b da janela na posição b % DELTA_RING_BINS
+    DeltaBin far;  // Usuários com balde além da janela
+    long long farMin;  // Menor balde registrado na lista distante (LLONG_MAX se vazia)
+} DeltaBuckets;
+
+// Insere um usuário em um balde
+static void deltaBinPush(DeltaBin* bin, int v) {
+    if (bin->count == bin->capacity) {
+        bin->capacity = bin->capacity ? 2 * bin->capacity : 16;
+        bin->items = (int*)realloc(bin->items, bin->capacity * sizeof(int));
+        if (!bin->items) exit(1);  // Verificação de alocação de memória
+    }
+    bin->items[bin->count++] = v;
+}
+
+// Insere um usuário no balde bucket: no anel se estiver na janela que começa em current, senão na lista distante
+static void deltaBucketsPush(DeltaBuckets* buckets, long long bucket, long long current, int v) {
+    if (bucket - current < DELTA_RING_BINS) {
+        deltaBinPush(&buckets->ring[bucket % DELTA_RING_BINS], v);
+    } else {
+        deltaBinPush(&buckets->far, v);
+        if (bucket < buckets->farMin) buckets->farMin = bucket;
+    }
+}
+
+// Função para calcular as distâncias ponderadas de uma origem para todos os usuários
+// graph: Ponteiro para o grafo
+// source: ID do usuário de origem
+// delta: Largura dos baldes (<= 0 usa o peso médio das conexões)
+// distance: Array de saída com numUsers posições (-1 para usuários inalcançáveis)
+void weightedDistances(Graph* graph, int source, long long delta, long long* distance) {
+    int n = graph->numUsers;
+    if (!graph->weighted) {
+        // Sem pesos: a BFS completa já dá as distâncias
+        BFSTree* tree = buildBFSTree(graph, source);
+        for (int v = 0; v < n; v++) {
+            distance[v] = tree->distance[v];
+        }
+        releaseBFSTree(tree);
+        return;
+    }
+
+    CSRGraph* csr = getCSR(graph);  // Antes da região paralela
+    int numEntries = csr->offsets[n];
+    if (delta <= 0) {
+        long long total = 0;
+        for (int e = 0; e < numEntries; e++) {
+            total += csr->weights[e];
+        }
+        delta = numEntries > 0 && total / numEntries > 0 ? total / numEntries : 1;
+    }
+
+    atomic_llong* tentative = (atomic_llong*)malloc((n > 0 ? n : 1) * sizeof(atomic_llong));
+    int frontierCapacity = 1024;
+    int nextCapacity = 1024;
+    int* frontier = (int*)malloc(frontierCapacity * sizeof(int));
+    int* nextFrontier = (int*)malloc(nextCapacity * sizeof(int));
+    if (!tentative || !frontier || !nextFrontier) exit(1);  // Verificação de alocação de memória
+    for (int v = 0; v < n; v++) {
+        atomic_init(&tentative[v], LLONG_MAX);
+    }
+    atomic_store(&tentative[source], 0);
+    frontier[0] = source;
+    int frontierSize = 1;
+    long long currentBin = 0;
+    long long nextBin = LLONG_MAX;
+    bool moreBins = false;
+    atomic_int nextSize;
+    atomic_init(&nextSize, 0);
+
+    #pragma omp parallel
+    {
+        DeltaBuckets* buckets = (DeltaBuckets*)calloc(1, sizeof(DeltaBuckets));  // Baldes da thread
+        if (!buckets) exit(1);
+        buckets->farMin = LLONG_MAX;
+
+        while (frontierSize > 0 || moreBins) {
+            // Relaxa as conexões de todos os usuários do balde atual
+            #pragma omp for schedule(dynamic, 64)
+            for (int i = 0; i < frontierSize; i++) {
+                int u = frontier[i];
+                long long du = atomic_load_explicit(&tentative[u], memory_order_relaxed);
+                for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+                    int v = csr->neighbors[e];
+                    long long candidate = du + csr->weights[e];
+                    long long old = atomic_load_explicit(&tentative[v], memory_order_relaxed);
+                    while (candidate < old) {
+                        if (atomic_compare_exchange_weak_explicit(&tentative[v], &old, candidate, memory_order_relaxed,
+                                                                  memory_order_relaxed)) {
+                            deltaBucketsPush(buckets, candidate / delta, currentBin, v);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // Próximo balde: o menor balde não vazio (no anel ou na lista distante) entre todas as threads
+            long long localNext = buckets->farMin;
+            for (long long b = currentBin; b < currentBin + DELTA_RING_BINS && b < localNext; b++) {
+                if (buckets->ring[b % DELTA_RING_BINS].count > 0) {
+                    localNext = b;
+                    break;
+                }
+            }
+            #pragma omp single
+            {
+                nextBin = LLONG_MAX;
+                atomic_store(&nextSize, 0);
+            }
+            #pragma omp critical
+            {
+                if (localNext < nextBin) nextBin = localNext;
+            }
+            #pragma omp barrier
+
+            // A janela passa a começar em chosen: os usuários distantes que caem nela vão para o anel, e as
+            // entradas de usuários que já melhoraram para um balde anterior são descartadas
+            long long chosen = nextBin;
+            if (chosen != LLONG_MAX && buckets->farMin - chosen < DELTA_RING_BINS) {
+                DeltaBin* far = &buckets->far;
+                int kept = 0;
+                buckets->farMin = LLONG_MAX;
+                for (int i = 0; i < far->count; i++) {
+                    int v = far->items[i];
+                    long long b = atomic_load_explicit(&tentative[v], memory_order_relaxed) / delta;
+                    if (b < chosen) continue;
+                    if (b - chosen < DELTA_RING_BINS) {
+                        deltaBinPush(&buckets->ring[b % DELTA_RING_BINS], v);
+                    } else {
+                        far->items[kept++] = v;
+                        if (b < buckets->farMin) buckets->farMin = b;
+                    }
+                }
+                far->count = kept;
+            }
+
+            // Cada thread reserva a sua parte da nova fronteira e copia o seu balde
+            DeltaBin* bin = chosen != LLONG_MAX ? &buckets->ring[chosen % DELTA_RING_BINS] : NULL;
+            int count = bin ? bin->count : 0;
+            int offset = atomic_fetch_add(&nextSize, count);
+            #pragma omp barrier
+            #pragma omp single
+            {
+                int needed = atomic_load(&nextSize);
+                if (needed > nextCapacity) {
+                    nextCapacity = 2 * needed;
+                    free(nextFrontier);
+                    nextFrontier = (int*)malloc(nextCapacity * sizeof(int));
+                    if (!nextFrontier) exit(1);
+                }
+            }
+            if (count > 0) {
+                memcpy(nextFrontier + offset, bin->items, count * sizeof(int));
+                bin->count = 0;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            {
+                int* swapFrontier = frontier;
+                frontier = nextFrontier;
+                nextFrontier = swapFrontier;
+                int swapCapacity = frontierCapacity;
+                frontierCapacity = nextCapacity;
+                nextCapacity = swapCapacity;
+                frontierSize = atomic_load(&nextSize);
+                moreBins = chosen != LLONG_MAX;  // Balde vazio (só entradas descartadas): procura o próximo
+                currentBin = chosen;
+            }
+        }
+
+        for (int b = 0; b < DELTA_RING_BINS; b++) {
+            free(buckets->ring[b].items);
+        }
+        free(buckets->far.items);
+        free(buckets);
+    }
+
+    for (int v = 0; v < n; v++) {
+        long long d = atomic_load_explicit(&tentative[v], memory_order_relaxed);
+        distance[v] = d == LLONG_MAX ? -1 : d;
+    }
+    free(tentative);
+    free(frontier);
+    free(nextFrontier);
+}
+
+/*
+24-etapa: Grafo direcionado de seguidores (adjacência de saída e de entrada)
+
+Descrição:
+- No modo de seguidores (`enableDirectedMode`), uma conexão tem sentido: `addFollow(a, b)` significa que a segue
+  b. As listas `adjList` continuam com as conexões de saída (quem o usuário segue) e `inList` guarda as de
+  entrada (os seguidores). `addConnection` vira um par de seguidas mútuas.
+- O CSR (`getCSR`) tem as conexões de saída e o CSR reverso (`getReverseCSR`) as de entrada. Os dois ficam em
+  cache e são reconstruídos só depois de uma mudança, então percorrer as conexões no sentido contrário
+  (seguidores, PageRank "pull", etapas bottom-up) não transpõe o grafo na hora da consulta. Em grafos não
+  direcionados `getReverseCSR` devolve o próprio CSR, sem memória extra.
+- As buscas seguem o sentido das conexões: a BFS, as árvores de BFS e o Dijkstra usam as conexões de saída, a
+  sugestão de amizades vira "quem seguir" (seguidos de quem o usuário segue) e o PageRank soma as contribuições
+  dos seguidores.
+- A busca bidirecional expande, a cada nível, o lado com a menor fronteira: a partir da origem pelas conexões
+  de saída e a partir do destino pelas de entrada. Quando as duas buscas se encontram, o nível é concluído e o
+  menor caminho entre os encontros é escolhido.
+- As análises que supõem conexões sem sentido (triângulos e agrupamento, cores, comunidades e modularidade)
+  usam `getUndirectedCSR`: a união das conexões de saída e de entrada, sem repetições, também em cache. Assim
+  uma seguida em um só sentido conta como uma conexão, e três usuários ligados em qualquer sentido formam um
+  triângulo.
+- A exportação (22-etapa) escreve cada seguida com seta (`->` no DOT, `edgedefault="directed"` no GraphML).
+- O CSR com folga recebe só as conexões de saída.
+- O log de conexões e o grafo versionado supõem conexões nos dois sentidos e recusam o modo de seguidores:
+  `attachEdgeLog` retorna false para um grafo direcionado, `enableDirectedMode` retorna false se o grafo já
+  tem um log, e `createVersionedGraph` retorna NULL. `recoverCSR` (e portanto `compactEdgeLog`) recusa
+  aplicar mudanças do log a um snapshot que não seja simétrico.
+
+Funções:
+- `enableDirectedMode`: Coloca um grafo ainda sem conexões no modo de seguidores.
+- `addFollow`: Registra que um usuário segue outro.
+- `removeFollow`: Desfaz uma seguida.
+- `getReverseCSR`: Retorna o CSR das conexões de entrada, reconstruindo-o se alguma conexão mudou.
+- `getUndirectedCSR`: Retorna o CSR simétrico (conexões nos dois sentidos) usado pelas análises sem sentido.
+- `followersOf`: Seguidores de um usuário.
+- `followingOf`: Usuários que um usuário segue.
+- `bidirectionalShortestPath`: Menor caminho (no sentido das conexões) por BFS bidirecional.
+*/
+
+// Função para colocar o grafo no modo de seguidores (conexões com sentido)
+// graph: Ponteiro para o grafo (ainda sem conexões)
+// Retorna false se o grafo já tem conexões ou um log de conexões associado
+bool enableDirectedMode(Graph* graph) {
+    if (graph->directed) {
+        return true;
+    }
+    if (graph->edgeLog) {
+        return false;  // O log não guarda o sentido das conexões
+    }
+    for (int i = 0; i < graph->numUsers; i++) {
+        if (graph->adjList[i]) return false;
+    }
+    graph->inList = (AdjacencyNode**)calloc(graph->numUsers > 0 ? graph->numUsers : 1, sizeof(AdjacencyNode*));
+    graph->inDegree = (int*)calloc(graph->numUsers > 0 ? graph->numUsers : 1, sizeof(int));
+    if (!graph->inList || !graph->inDegree) exit(1);  // Verificação de alocação de memória
+    graph->directed = true;
+    return true;
+}
+
+// Função para registrar que um usuário segue outro
+// graph: Ponteiro para o grafo (no modo de seguidores)
+// follower: ID de quem segue
+// followee: ID de quem é seguido
+void addFollow(Graph* graph, int follower, int followee) {
+    AdjacencyNode* newNode = createNode(graph->users[followee]);
+    newNode->next = graph->adjList[follower];
+    graph->adjList[follower] = newNode;
+
+    newNode = createNode(graph->users[follower]);
+    newNode->next = graph->inList[followee];
+    graph->inList[followee] = newNode;
+
+    graph->degree[follower]++;
+    graph->inDegree[followee]++;
+    graphChanged(graph, follower, followee, true);
+}
+
+// Remove o nó de um usuário de uma lista de adjacência
+// Retorna true se o usuário estava na lista
+static bool unlinkAdjacency(AdjacencyNode** link, int user) {
+    while (*link) {
+        if ((*link)->user->id == user) {
+            AdjacencyNode* toDelete = *link;
+            *link = toDelete->next;
+            free(toDelete);
+            return true;
+        }
+        link = &(*link)->next;
+    }
+    return false;
+}
+
+// Função para desfazer uma seguida
+// graph: Ponteiro para o grafo (no modo de seguidores)
+// follower: ID de quem segue
+// followee: ID de quem é seguido
+// Retorna true se a seguida existia e foi removida
+bool removeFollow(Graph* graph, int follower, int followee) {
+    if (!unlinkAdjacency(&graph->adjList[follower], followee)) {
+        return false;
+    }
+    unlinkAdjacency(&graph->inList[followee], follower);
+    graph->degree[follower]--;
+    graph->inDegree[followee]--;
+    graphChanged(graph, follower, followee, false);
+    return true;
+}
+
+// Função que retorna o CSR das conexões de entrada, reconstruindo-o se alguma conexão mudou
+// graph: Ponteiro para o grafo
+// Em grafos não direcionados retorna o próprio CSR (as duas direções já estão nele).
+CSRGraph* getReverseCSR(Graph* graph) {
+    if (!graph->directed) {
+        return getCSR(graph);
+    }
+    if (!graph->reverseCSR) {
+        graph->reverseCSR = buildCSRFromLists(graph->numUsers, graph->inList, graph->inDegree, graph->weighted);
+    }
+    return graph->reverseCSR;
+}
+
+// Junta duas listas ordenadas sem repetições; out é NULL para só contar
+static int unionSorted(const int* a, int sizeA, const int* b, int sizeB, int* out) {
+    int i = 0;
+    int j = 0;
+    int count = 0;
+    while (i < sizeA || j < sizeB) {
+        int v;
+        if (j >= sizeB || (i < sizeA && a[i] < b[j])) {
+            v = a[i++];
+        } else if (i >= sizeA || b[j] < a[i]) {
+            v = b[j++];
+        } else {
+            v = a[i++];
+            j++;
+        }
+        if (out) out[count] = v;
+        count++;
+    }
+    return count;
+}
+
+// Função que retorna o CSR simétrico (conexões de saída e de entrada, sem repetições), reconstruindo-o se
+// alguma conexão mudou; não tem pesos
+// graph: Ponteiro para o grafo
+// Em grafos não direcionados retorna o próprio CSR.
+CSRGraph* getUndirectedCSR(Graph* graph) {
+    if (!graph->directed) {
+        return getCSR(graph);
+    }
+    if (!graph->undirectedCSR) {
+        const CSRGraph* out = getCSR(graph);
+        const CSRGraph* in = getReverseCSR(graph);
+        int n = graph->numUsers;
+        CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+        if (!csr) exit(1);  // Verificação de alocação de memória
+        csr->numUsers = n;
+        csr->offsets = (int*)malloc((n + 1) * sizeof(int));
+        if (!csr->offsets) exit(1);
+        csr->weights = NULL;
+
+        // Primeira passada conta, segunda preenche
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int v = 0; v < n; v++) {
+            csr->offsets[v + 1] = unionSorted(out->neighbors + out->offsets[v], out->offsets[v + 1] - out->offsets[v],
+                                              in->neighbors + in->offsets[v], in->offsets[v + 1] - in->offsets[v], NULL);
+        }
+        csr->offsets[0] = 0;
+        for (int v = 0; v < n; v++) {
+            csr->offsets[v + 1] += csr->offsets[v];
+        }
+        csr->neighbors = (int*)malloc((csr->offsets[n] + 1) * sizeof(int));
+        if (!csr->neighbors) exit(1);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int v = 0; v < n; v++) {
+            unionSorted(out->neighbors + out->offsets[v], out->offsets[v + 1] - out->offsets[v],
+                        in->neighbors + in->offsets[v], in->offsets[v + 1] - in->offsets[v], csr->neighbors + csr->offsets[v]);
+        }
+        graph->undirectedCSR = csr;
+    }
+    return graph->undirectedCSR;
+}
+
+// Função para obter os seguidores de um usuário
+// graph: Ponteiro para o grafo
+// user: ID do usuário
+// followers: Recebe o início da lista ordenada (válida até a próxima mudança nas conexões)
+// Retorna o número de seguidores (em grafos não direcionados, o número de amigos)
+int followersOf(Graph* graph, int user, const int** followers) {
+    CSRGraph* reverse = getReverseCSR(graph);
+    *followers = reverse->neighbors + reverse->offsets[user];
+    return reverse->offsets[user + 1] - reverse->offsets[user];
+}
+
+// Função para obter os usuários que um usuário segue
+// graph: Ponteiro para o grafo
+// user: ID do usuário
+// following: Recebe o início da lista ordenada (válida até a próxima mudança nas conexões)
+// Retorna o número de seguidos (em grafos não direcionados, o número de amigos)
+int followingOf(Graph* graph, int user, const int** following) {
+    CSRGraph* csr = getCSR(graph);
+    *following = csr->neighbors + csr->offsets[user];
+    return csr->offsets[user + 1] - csr->offsets[user];
+}
+
+// Expande um nível inteiro de um lado da busca bidirecional
+// side: Estado do lado expandido; other: Estado do outro lado
+// *head, *tail: Fronteira atual em side->queue[*head] .. side->queue[*tail - 1]
+// *best, *meetFrom, *meetTo: Melhor encontro até agora (distância total e conexão que liga os dois lados)
+static void bidirectionalExpand(const int* offsets, const int* neighbors, BFSScratch* side, const BFSScratch* other,
+                                int* head, int* tail, int* best, int* meetFrom, int* meetTo) {
+    int levelEnd = *tail;
+    int sideStamp = side->currentStamp;
+    int otherStamp = other->currentStamp;
+    while (*head < levelEnd) {
+        int u = side->queue[(*head)++];
+        INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, offsets[u + 1] - offsets[u]);
+        for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+            int v = neighbors[e];
+            if (other->stamp[v] == otherStamp) {
+                int total = side->distance[u] + 1 + other->distance[v];
+                if (*best < 0 || total < *best) {
+                    *best = total;
+                    *meetFrom = u;
+                    *meetTo = v;
+                }
+            }
+            if (side->stamp[v] != sideStamp) {
+                side->stamp[v] = sideStamp;
+                side->distance[v] = side->distance[u] + 1;
+                side->predecessor[v] = u;
+                side->queue[(*tail)++] = v;
+            }
+        }
+    }
+    INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, levelEnd);
+}
+
+// Função para encontrar o menor caminho por BFS bidirecional
+// graph: Ponteiro para o grafo
+// forward: Estado da busca a partir da origem (conexões de saída)
+// backward: Estado da busca a partir do destino (conexões de entrada)
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// result: Resultado (path é o buffer do chamador)
+// Retorna true se o caminho existe e coube em result->path (result->distance é -1 se não há caminho)
+bool bidirectionalShortestPath(Graph* graph, BFSScratch* forward, BFSScratch* backward, int source, int target, PathResult* result) {
+    INSTRUMENT_BEGIN(searchTimer);
+    CSRGraph* outgoing = getCSR(graph);
+    CSRGraph* incoming = getReverseCSR(graph);
+
+    bfsScratchReset(forward);
+    bfsScratchReset(backward);
+    forward->stamp[source] = forward->currentStamp;
+    forward->distance[source] = 0;
+    forward->predecessor[source] = -1;
+    forward->queue[0] = source;
+    backward->stamp[target] = backward->currentStamp;
+    backward->distance[target] = 0;
+    backward->predecessor[target] = -1;
+    backward->queue[0] = target;
+    int forwardHead = 0, forwardTail = 1;
+    int backwardHead = 0, backwardTail = 1;
+    int best = source == target ? 0 : -1;
+    int meetFrom = source, meetTo = target;
+
+    // Expande o lado com a menor fronteira até as buscas se encontrarem ou uma fronteira esvaziar
+    while (best < 0 && forwardHead < forwardTail && backwardHead < backwardTail) {
+        if (forwardTail - forwardHead <= backwardTail - backwardHead) {
+            bidirectionalExpand(outgoing->offsets, outgoing->neighbors, forward, backward, &forwardHead, &forwardTail,
+                                &best, &meetFrom, &meetTo);
+        } else {
+            // Do lado do destino, meetFrom / meetTo ficam invertidos: a conexão é meetTo -> meetFrom
+            bidirectionalExpand(incoming->offsets, incoming->neighbors, backward, forward, &backwardHead, &backwardTail,
+                                &best, &meetTo, &meetFrom);
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+
+    // Caminho: origem .. meetFrom pelos predecessores da ida, meetTo .. destino pelos da volta
+    result->length = 0;
+    result->distance = best;
+    if (best < 0) {
+        return false;
+    }
+    if (best + 1 > result->capacity) {
+        return false;
+    }
+    if (source == target) {
+        result->path[0] = source;
+        result->length = 1;
+        return true;
+    }
+    int i = forward->distance[meetFrom];
+    for (int crawl = meetFrom; crawl != -1; crawl = forward->predecessor[crawl]) {
+        result->path[i--] = crawl;
+    }
+    i = forward->distance[meetFrom] + 1;
+    for (int crawl = meetTo; crawl != -1; crawl = backward->predecessor[crawl]) {
+        result->path[i++] = crawl;
+    }
+    result->length = best + 1;
+    return true;
+}
+
+/*
+25-etapa: Contatos com data e alcançabilidade respeitando o tempo
+
+Descrição:
+- Para responder "como a informação chegou de A a B entre as datas T1 e T2", cada contato tem um instante e um
+  caminho só vale se os instantes dos contatos não diminuem ao longo dele. Os contatos ficam em uma lista de
+  `TemporalEdge` (o mesmo par pode ter vários contatos) e são compactados em um `TemporalCSR`, com a lista de
+  cada usuário ordenada por instante. Os instantes ficam em um array separado dos vizinhos, para que a busca
+  binária leia só os instantes.
+- Filtro de janela sem copiar o grafo: os contatos de um usuário entre T1 e T2 são uma faixa contígua da sua
+  lista, encontrada por duas buscas binárias (`temporalNeighbors`).
+- Chegada mais cedo (uma única passada): a informação parte da origem no instante T1. Os usuários são retirados
+  em ordem de chegada; ao retirar u, que recebeu a informação no instante a(u), uma busca binária pula os
+  contatos anteriores a a(u) e a varredura para no primeiro contato depois de T2. Cada usuário é retirado uma vez.
+- A chegada a um usuário é o instante do contato que o alcançou e nunca é menor que a última chegada retirada,
+  então a fila de prioridade é o heap radix e o estado é o `DijkstraScratch` da 23-etapa.
+
+Funções:
+- `generateTemporalEdges`: Sorteia contatos com data para as conexões do grafo.
+- `buildTemporalCSR`: Compacta uma lista de contatos em um CSR ordenado por instante.
+- `freeTemporalCSR`: Libera o CSR de contatos.
+- `temporalNeighbors`: Contatos de um usuário dentro de uma janela de tempo.
+- `earliestArrivalTimes`: Instante de chegada mais cedo da origem a todos os usuários.
+- `earliestArrivalPath`: Caminho de chegada mais cedo entre dois usuários, com o instante de cada contato.
+*/
+
+// Estrutura para ordenar os contatos de um usuário
+typedef struct TemporalEntry {
+    long long time;  // Instante do contato
+    int neighbor;  // Usuário contatado
+} TemporalEntry;
+
+// Função de comparação de contatos para o qsort (instante e depois vizinho)
+static int compareTemporalEntries(const void* a, const void* b) {
+    const TemporalEntry* x = (const TemporalEntry*)a;
+    const TemporalEntry* y = (const TemporalEntry*)b;
+    if (x->time != y->time) return (x->time > y->time) - (x->time < y->time);
+    return (x->neighbor > y->neighbor) - (x->neighbor < y->neighbor);
+}
+
+// Primeira posição de times[lo .. hi - 1] com instante >= time (hi se nenhuma)
+static int temporalLowerBound(const long long* times, int lo, int hi, long long time) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (times[mid] < time) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Função para sortear contatos com data para as conexões do grafo
+// graph: Ponteiro para o grafo
+// contactsPerConnection: Número de contatos de cada conexão
+// begin, end: Intervalo dos instantes sorteados
+// seed: Semente do sorteio
+// edges: Recebe o array de contatos (liberado pelo chamador com free); em grafos não direcionados cada conexão
+//        aparece uma vez, com src < dest, e em grafos direcionados cada seguida gera os seus contatos
+// Retorna o número de contatos
+int generateTemporalEdges(Graph* graph, int contactsPerConnection, long long begin, long long end, unsigned int seed, TemporalEdge** edges) {
+    int count = 0;
+    int capacity = 1024;
+    TemporalEdge* list = (TemporalEdge*)malloc(capacity * sizeof(TemporalEdge));
+    if (!list) exit(1);  // Verificação de alocação de memória
+    unsigned long long state = ((unsigned long long)seed << 32) ^ 0x5DEECE66Dull;
+    unsigned long long span = (unsigned long long)(end - begin) + 1;
+
+    for (int u = 0; u < graph->numUsers; u++) {
+        for (AdjacencyNode* temp = graph->adjList[u]; temp; temp = temp->next) {
+            int v = temp->user->id;
+            if (!graph->directed && v < u) {
+                continue;  // A conexão já foi vista a partir de v
+            }
+            for (int c = 0; c < contactsPerConnection; c++) {
+                if (count == capacity) {
+                    capacity *= 2;
+                    list = (TemporalEdge*)realloc(list, capacity * sizeof(TemporalEdge));
+                    if (!list) exit(1);
+                }
+                list[count].src = u;
+                list[count].dest = v;
+                list[count].time = begin + (long long)(splitMix64(&state) % span);
+                count++;
+            }
+        }
+    }
+
+    *edges = list;
+    return count;
+}
+
+// Função para compactar uma lista de contatos em um CSR ordenado por instante
+// numUsers: Número de usuários
+// edges: Contatos
+// count: Número de contatos
+// directed: false para inserir cada contato também no sentido dest -> src
+TemporalCSR* buildTemporalCSR(int numUsers, const TemporalEdge* edges, int count, bool directed) {
+    TemporalCSR* tcsr = (TemporalCSR*)malloc(sizeof(TemporalCSR));
+    if (!tcsr) exit(1);  // Verificação de alocação de memória
+    tcsr->numUsers = numUsers;
+    tcsr->directed = directed;
+    tcsr->offsets = (int*)calloc(numUsers + 1, sizeof(int));
+    if (!tcsr->offsets) exit(1);
+
+    // Conta os contatos de cada usuário e calcula o início de cada lista
+    for (int i = 0; i < count; i++) {
+        tcsr->offsets[edges[i].src + 1]++;
+        if (!directed) tcsr->offsets[edges[i].dest + 1]++;
+    }
+    for (int v = 0; v < numUsers; v++) {
+        tcsr->offsets[v + 1] += tcsr->offsets[v];
+    }
+
+    // Distribui os contatos e ordena cada lista por instante
+    int numEntries = tcsr->offsets[numUsers];
+    TemporalEntry* entries = (TemporalEntry*)malloc((numEntries + 1) * sizeof(TemporalEntry));
+    int* cursor = (int*)malloc((numUsers + 1) * sizeof(int));
+    tcsr->neighbors = (int*)malloc((numEntries + 1) * sizeof(int));
+    tcsr->times = (long long*)malloc((numEntries + 1) * sizeof(long long));
+    if (!entries || !cursor || !tcsr->neighbors || !tcsr->times) exit(1);
+    memcpy(cursor, tcsr->offsets, numUsers * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        entries[cursor[edges[i].src]++] = (TemporalEntry){edges[i].time, edges[i].dest};
+        if (!directed) entries[cursor[edges[i].dest]++] = (TemporalEntry){edges[i].time, edges[i].src};
+    }
+    for (int v = 0; v < numUsers; v++) {
+        qsort(entries + tcsr->offsets[v], tcsr->offsets[v + 1] - tcsr->offsets[v], sizeof(TemporalEntry),
+              compareTemporalEntries);
+    }
+    for (int e = 0; e < numEntries; e++) {
+        tcsr->neighbors[e] = entries[e].neighbor;
+        tcsr->times[e] = entries[e].time;
+    }
+
+    free(entries);
+    free(cursor);
+    return tcsr;
+}
+
+// Função para liberar o CSR de contatos
+void freeTemporalCSR(TemporalCSR* tcsr) {
+    if (tcsr != NULL) {
+        free(tcsr->offsets);
+        free(tcsr->neighbors);
+        free(tcsr->times);
+        free(tcsr);
+    }
+}
+
+// Função para obter os contatos de um usuário dentro de uma janela de tempo (sem cópia)
+// tcsr: CSR de contatos
+// user: ID do usuário
+// begin, end: Janela de tempo (inclusiva)
+// neighbors, times: Recebem o início da faixa de contatos da janela
+// Retorna o número de contatos na janela
+int temporalNeighbors(const TemporalCSR* tcsr, int user, long long begin, long long end, const int** neighbors, const long long** times) {
+    int first = temporalLowerBound(tcsr->times, tcsr->offsets[user], tcsr->offsets[user + 1], begin);
+    int last = end == LLONG_MAX ? tcsr->offsets[user + 1]
+                                : temporalLowerBound(tcsr->times, first, tcsr->offsets[user + 1], end + 1);
+    *neighbors = tcsr->neighbors + first;
+    *times = tcsr->times + first;
+    return last - first;
+}
+
+// Busca de chegada mais cedo a partir de source; para ao retirar target (-1 para percorrer tudo)
+// Ao final, distance[v] é o instante de chegada dos usuários com o carimbo retornado
+static int earliestArrivalSearch(const TemporalCSR* tcsr, DijkstraScratch* scratch, int source, int target,
+                                 long long begin, long long end) {
+    int stamp = dijkstraScratchReset(scratch);
+    RadixHeap* heap = &scratch->heap;
+    scratch->stamp[source] = stamp;
+    scratch->distance[source] = begin;
+    scratch->predecessor[source] = -1;
+    radixPush(heap, (unsigned long long)begin, source);
+
+    while (heap->size > 0) {
+        RadixEntry entry = radixPop(heap);
+        int u = entry.vertex;
+        long long arrival = (long long)entry.key;
+        if (arrival > scratch->distance[u]) {
+            continue;  // Entrada antiga: u já foi retirado com uma chegada anterior
+        }
+        INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, 1);
+        if (u == target) {
+            break;
+        }
+
+        // Só os contatos a partir da chegada a u e até o fim da janela podem levar a informação adiante
+        int first = temporalLowerBound(tcsr->times, tcsr->offsets[u], tcsr->offsets[u + 1], arrival);
+        for (int e = first; e < tcsr->offsets[u + 1] && tcsr->times[e] <= end; e++) {
+            int v = tcsr->neighbors[e];
+            long long time = tcsr->times[e];
+            INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, 1);
+            if (scratch->stamp[v] != stamp || time < scratch->distance[v]) {
+                scratch->stamp[v] = stamp;
+                scratch->distance[v] = time;
+                scratch->predecessor[v] = u;
+                radixPush(heap, (unsigned long long)time, v);
+            }
+        }
+    }
+    return stamp;
+}
+
+// Função para calcular o instante de chegada mais cedo da origem a todos os usuários
+// tcsr: CSR de contatos
+// scratch: Estado reutilizável (createDijkstraScratch com tcsr->numUsers)
+// source: ID do usuário de origem
+// begin, end: Janela de tempo (a informação parte da origem em begin; contatos depois de end são ignorados)
+// arrival: Array de saída com numUsers posições (-1 para usuários não alcançados na janela)
+// Retorna o número de usuários alcançados (incluindo a origem)
+int earliestArrivalTimes(const TemporalCSR* tcsr, DijkstraScratch* scratch, int source, long long begin, long long end, long long* arrival) {
+    INSTRUMENT_BEGIN(searchTimer);
+    int stamp = earliestArrivalSearch(tcsr, scratch, source, -1, begin, end);
+    int reached = 0;
+    for (int v = 0; v < tcsr->numUsers; v++) {
+        if (scratch->stamp[v] == stamp) {
+            arrival[v] = scratch->distance[v];
+            reached++;
+        } else {
+            arrival[v] = -1;
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+    return reached;
+}
+
+// Função para encontrar o caminho de chegada mais cedo entre dois usuários
+// tcsr: CSR de contatos
+// scratch: Estado reutilizável (createDijkstraScratch com tcsr->numUsers)
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// begin, end: Janela de tempo
+// result: Resultado; path é o buffer do chamador e result->distance recebe o número de contatos do caminho
+// hopTimes: Array opcional com result->capacity posições; hopTimes[i] recebe o instante em que path[i] recebeu
+//           a informação (hopTimes[0] = begin)
+// Retorna o instante de chegada ao destino (-1 se o destino não é alcançado na janela)
+long long earliestArrivalPath(const TemporalCSR* tcsr, DijkstraScratch* scratch, int source, int target, long long begin, long long end, PathResult* result, long long* hopTimes) {
+    INSTRUMENT_BEGIN(searchTimer);
+    int stamp = earliestArrivalSearch(tcsr, scratch, source, target, begin, end);
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+
+    result->length = 0;
+    result->distance = -1;
+    if (scratch->stamp[target] != stamp) {
+        return -1;
+    }
+    int length = 0;
+    for (int crawl = target; crawl != -1; crawl = scratch->predecessor[crawl]) {
+        length++;
+    }
+    result->distance = length - 1;
+    if (length <= result->capacity) {
+        result->length = length;
+        int crawl = target;
+        for (int i = length - 1; i >= 0; i--) {
+            result->path[i] = crawl;
+            if (hopTimes) hopTimes[i] = scratch->distance[crawl];
+            crawl = scratch->predecessor[crawl];
+        }
+    }
+    return scratch->distance[target];
+}
+
+/*
+26-etapa: BFS fora da memória (out-of-core) sobre o snapshot mapeado
+
+Descrição:
+- Para grafos maiores que a memória, a BFS percorre diretamente o arquivo de snapshot da 17-etapa mapeado com
+  `mmap`, e o sistema operacional traz do disco só as páginas usadas.
+- Cada nível é processado em lotes ordenados: a fronteira é um bitmap percorrido em ordem crescente de ID, então
+  os offsets e as listas de vizinhos de um lote formam uma faixa contígua do arquivo, lida sempre para a frente.
+  Um lote fecha quando as suas listas somam `batchBytes`.
+- Dicas ao kernel (`madvise`): antes de processar um lote, a faixa do lote seguinte é pedida com `MADV_WILLNEED`
+  (leitura antecipada enquanto o lote atual é processado) e a faixa já processada é liberada com
+  `MADV_DONTNEED`, para que o conjunto residente não cresça com o grafo. Dentro do lote, o bit de visitado de
+  vizinhos um pouco à frente é buscado com `__builtin_prefetch`.
+- O estado por usuário fica em bitmaps (visitados, fronteira atual e próxima, 1 bit por usuário cada). Com
+  `workDir`, os bitmaps são arquivos temporários desse diretório (apagados logo após a criação) mapeados em
+  memória, que o kernel pode devolver ao disco; sem `workDir`, são memória anônima.
+- Os vizinhos de cada lote são percorridos em paralelo (OpenMP), com "ou" atômico nos bitmaps.
+- A BFS em memória (19-etapa) continua sendo a escolha quando o grafo cabe na memória.
+
+Funções:
+- `externalBFS`: BFS completa a partir de uma origem sobre um arquivo de snapshot.
+*/
+
+#define EXTERNAL_BFS_BATCH_BYTES ((size_t)64 << 20)  // Tamanho padrão das listas de vizinhos de um lote
+#define EXTERNAL_BFS_MAX_BATCH 65536  // Máximo de usuários da fronteira em um lote
+#define EXTERNAL_BFS_LOOKAHEAD 16  // Distância (em vizinhos) do prefetch do bitmap de visitados
+
+// Cria um bitmap zerado de `words` palavras de 64 bits
+// workDir: Diretório do arquivo que guarda o bitmap (NULL para memória anônima)
+// Retorna NULL em caso de erro
+static atomic_ullong* createSpillBitmap(const char* workDir, size_t words) {
+    size_t bytes = (words > 0 ? words : 1) * sizeof(atomic_ullong);
+    void* data = MAP_FAILED;
+    if (!workDir) {
+        data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    } else {
+        size_t dirLength = strlen(workDir);
+        char* path = (char*)malloc(dirLength + 16);
+        if (!path) exit(1);  // Verificação de alocação de memória
+        memcpy(path, workDir, dirLength);
+        memcpy(path + dirLength, "/edbfs-XXXXXX", 14);
+        int fd = mkstemp(path);
+        if (fd >= 0) {
+            unlink(path);  // O arquivo some quando o mapeamento for desfeito
+            if (ftruncate(fd, (off_t)bytes) == 0) {
+                data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+        }
+        free(path);
+    }
+    return data == MAP_FAILED ? NULL : (atomic_ullong*)data;
+}
+
+// Aplica uma dica do madvise às páginas que cobrem data[begin .. end - 1]
+static void adviseRange(const void* data, size_t begin, size_t end, int advice) {
+    static size_t pageSize = 0;
+    if (pageSize == 0) {
+        pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    }
+    if (end <= begin) {
+        return;
+    }
+    uintptr_t first = ((uintptr_t)data + begin) & ~(uintptr_t)(pageSize - 1);
+    uintptr_t last = (uintptr_t)data + end;
+    madvise((void*)first, last - first, advice);
+}
+
+// Lote de usuários da fronteira, em ordem crescente de ID
+typedef struct ExternalBatch {
+    int* users;  // Usuários do lote
+    int count;  // Número de usuários
+    size_t begin, end;  // Faixa de bytes das listas do lote a partir do início dos vizinhos
+} ExternalBatch;
+
+// Retira do bitmap da fronteira o próximo lote a partir de *word (as palavras lidas são zeradas)
+static void externalNextBatch(atomic_ullong* frontier, size_t numWords, size_t* word, const int* offsets,
+                              size_t batchBytes, ExternalBatch* batch) {
+    batch->count = 0;
+    size_t bytes = 0;
+    while (*word < numWords && batch->count < EXTERNAL_BFS_MAX_BATCH && bytes < batchBytes) {
+        unsigned long long bits = atomic_load_explicit(&frontier[*word], memory_order_relaxed);
+        if (bits == 0) {
+            (*word)++;
+            continue;
+        }
+        int v = (int)(*word * 64) + __builtin_ctzll(bits);
+        bits &= bits - 1;
+        atomic_store_explicit(&frontier[*word], bits, memory_order_relaxed);
+        batch->users[batch->count++] = v;
+        bytes += (size_t)(offsets[v + 1] - offsets[v]) * sizeof(int);
+    }
+    if (batch->count > 0) {
+        batch->begin = (size_t)offsets[batch->users[0]] * sizeof(int);
+        batch->end = (size_t)offsets[batch->users[batch->count - 1] + 1] * sizeof(int);
+    }
+}
+
+// Função de BFS completa fora da memória sobre um arquivo de snapshot
+// snapshotPath: Arquivo de snapshot (writeCSRSnapshot / compactEdgeLog)
+// workDir: Diretório dos bitmaps temporários (NULL para mantê-los em memória anônima)
+// source: ID do usuário de origem
+// batchBytes: Bytes de listas de vizinhos por lote (0 para o padrão de 64 MB)
+// distance: Array opcional com numUsers posições; recebe a distância de cada usuário (-1 se inalcançável)
+// numLevels: Recebe o número de níveis da BFS (opcional)
+// Retorna o número de usuários alcançados (incluindo a origem), ou -1 se o snapshot ou os bitmaps falharem
+long long externalBFS(const char* snapshotPath, const char* workDir, int source, size_t batchBytes, int* distance, int* numLevels) {
+    MappedCSR* mapped = mapCSRSnapshot(snapshotPath);
+    if (!mapped) {
+        return -1;
+    }
+    const int* offsets = mapped->csr.offsets;
+    const int* neighbors = mapped->csr.neighbors;
+    int n = mapped->csr.numUsers;
+    if (source < 0 || source >= n) {
+        unmapCSRSnapshot(mapped);
+        return -1;
+    }
+    if (batchBytes == 0) {
+        batchBytes = EXTERNAL_BFS_BATCH_BYTES;
+    }
+
+    size_t numWords = ((size_t)n + 63) / 64;
+    atomic_ullong* visited = createSpillBitmap(workDir, numWords);
+    atomic_ullong* frontier = createSpillBitmap(workDir, numWords);
+    atomic_ullong* next = createSpillBitmap(workDir, numWords);
+    if (!visited || !frontier || !next) {
+        if (visited) munmap(visited, numWords * sizeof(atomic_ullong));
+        if (frontier) munmap(frontier, numWords * sizeof(atomic_ullong));
+        if (next) munmap(next, numWords * sizeof(atomic_ullong));
+        unmapCSRSnapshot(mapped);
+        return -1;
+    }
+    ExternalBatch batches[2];
+    for (int b = 0; b < 2; b++) {
+        batches[b].users = (int*)malloc(EXTERNAL_BFS_MAX_BATCH * sizeof(int));
+        if (!batches[b].users) exit(1);  // Verificação de alocação de memória
+    }
+
+    // A leitura é para a frente, mas esparsa: a leitura antecipada fica por conta das dicas de cada lote
+    adviseRange(neighbors, 0, (size_t)offsets[n] * sizeof(int), MADV_RANDOM);
+    if (distance) {
+        for (int v = 0; v < n; v++) {
+            distance[v] = -1;
+        }
+        distance[source] = 0;
+    }
+    atomic_store(&visited[source / 64], 1ull << (source % 64));
+    atomic_store(&frontier[source / 64], 1ull << (source % 64));
+    long long reached = 1;
+    long long frontierSize = 1;
+    int level = 0;
+
+    while (frontierSize > 0) {
+        long long discovered = 0;
+        size_t word = 0;
+        int current = 0;
+        externalNextBatch(frontier, numWords, &word, offsets, batchBytes, &batches[current]);
+        if (batches[current].count > 0) {
+            adviseRange(neighbors, batches[current].begin, batches[current].end, MADV_WILLNEED);
+        }
+
+        while (batches[current].count > 0) {
+            // Separa o lote seguinte e pede as suas páginas antes de processar o atual
+            ExternalBatch* batch = &batches[current];
+            ExternalBatch* following = &batches[1 - current];
+            externalNextBatch(frontier, numWords, &word, offsets, batchBytes, following);
+            if (following->count > 0) {
+                adviseRange(neighbors, following->begin, following->end, MADV_WILLNEED);
+            }
+
+            #pragma omp parallel for schedule(dynamic, 64) reduction(+:discovered)
+            for (int i = 0; i < batch->count; i++) {
+                int u = batch->users[i];
+                int first = offsets[u];
+                int last = offsets[u + 1];
+                for (int e = first; e < last; e++) {
+                    if (e + EXTERNAL_BFS_LOOKAHEAD < last) {
+                        __builtin_prefetch(&visited[neighbors[e + EXTERNAL_BFS_LOOKAHEAD] / 64], 1);
+                    }
+                    int v = neighbors[e];
+                    unsigned long long bit = 1ull << (v % 64);
+                    if (atomic_load_explicit(&visited[v / 64], memory_order_relaxed) & bit) {
+                        continue;
+                    }
+                    if (!(atomic_fetch_or_explicit(&visited[v / 64], bit, memory_order_relaxed) & bit)) {
+                        atomic_fetch_or_explicit(&next[v / 64], bit, memory_order_relaxed);
+                        if (distance) distance[v] = level + 1;
+                        discovered++;
+                    }
+                }
+                INSTRUMENT_COUNT(COUNTER_EDGES_SCANNED, last - first);
+            }
+            INSTRUMENT_COUNT(COUNTER_VERTICES_DEQUEUED, batch->count);
+
+            // As listas do lote não serão lidas de novo neste nível
+            adviseRange(neighbors, batch->begin, batch->end, MADV_DONTNEED);
+            current = 1 - current;
+        }
+
+        // A próxima fronteira vira a atual; a atual já foi zerada durante a leitura dos lotes
+        atomic_ullong* swap = frontier;
+        frontier = next;
+        next = swap;
+        frontierSize = discovered;
+        reached += discovered;
+        if (discovered > 0) level++;
+    }
+
+    if (numLevels) *numLevels = level + 1;
+    for (int b = 0; b < 2; b++) {
+        free(batches[b].users);
+    }
+    munmap(visited, numWords * sizeof(atomic_ullong));
+    munmap(frontier, numWords * sizeof(atomic_ullong));
+    munmap(next, numWords * sizeof(atomic_ullong));
+    unmapCSRSnapshot(mapped);
+    return reached;
+}
+
+/*
+27-etapa: Grafo particionado em vários processos (BFS distribuída por IPC local)
+
+Descrição:
+- Simulação, em uma única máquina, do protocolo de uma BFS distribuída: os usuários são divididos em partições
+  e cada partição é atendida por um processo próprio (criado com `fork`), que copia para o seu heap as listas
+  de vizinhos dos seus usuários e só consulta essa cópia. O processo que cria o grafo particionado vira o
+  coordenador.
+- Limite atual: isto não reduz a memória necessária. O coordenador precisa do `Graph` inteiro e do seu CSR
+  antes do `fork`, e cada processo herda (copy-on-write) todo o heap do coordenador, sem liberá-lo. O que a
+  etapa isola é a troca de mensagens: cada partição só conhece as próprias listas e o dono de cada usuário,
+  então o mesmo protocolo funcionaria com processos que carregassem apenas a sua faixa do grafo.
+- As partições podem ser faixas contíguas de IDs com aproximadamente o mesmo número de conexões (padrão) ou
+  sair das comunidades de Louvain (`partitionByCommunity`), que deixam a maioria das conexões dentro de uma
+  mesma partição e reduzem as mensagens.
+- BFS sincronizada por níveis:
+  - O coordenador envia a consulta a todas as partições; o dono da origem começa a fronteira.
+  - A cada nível, cada partição expande a sua fronteira. Vizinhos da própria partição entram direto na próxima
+    fronteira; os demais viram mensagens (vizinho, predecessor) agrupadas pela partição dona.
+  - As mensagens passam pelo coordenador, que as entrega aos donos. Cada partição só lê depois de enviar tudo
+    o que tinha, então os canais bloqueantes não travam.
+  - Cada partição responde quantos usuários novos descobriu e se encontrou o destino. A busca para quando o
+    destino é encontrado ou nenhuma partição descobre usuários novos. O caminho é reconstruído pedindo o
+    predecessor de cada usuário ao seu dono.
+- O transporte é plugável (`PartitionTransport`); o padrão usa um par de sockets Unix por partição. Outro
+  transporte (memória compartilhada, TCP entre máquinas) só precisa implementar as mesmas funções.
+- O resultado tem o mesmo formato de `shortestPath`; a distância é sempre a mesma, mas entre caminhos mínimos
+  diferentes pode ser escolhido outro.
+- O grafo particionado é uma cópia: mudanças no grafo original depois da criação não chegam às partições.
+
+Funções:
+- `partitionByCommunity`: Distribui as comunidades de Louvain entre as partições, equilibrando as conexões.
+- `createPartitionedGraph`: Cria os processos das partições.
+- `freePartitionedGraph`: Encerra os processos e libera o coordenador.
+- `partitionedShortestPath`: Menor caminho pela BFS distribuída.
+*/
+
+// Comandos do coordenador para as partições
+typedef enum PartitionCommandType {
+    PARTITION_START,  // Nova consulta (a = origem, b = destino)
+    PARTITION_EXPAND,  // Expandir a fronteira e enviar as mensagens para outras partições
+    PARTITION_DELIVER,  // Mensagens recebidas (a = número de pares (vizinho, predecessor) que seguem)
+    PARTITION_PARENT,  // Pedido do predecessor de um usuário (a = usuário)
+    PARTITION_QUIT  // Encerrar o processo
+} PartitionCommandType;
+
+// Estrutura para representar um comando do coordenador
+typedef struct PartitionCommand {
+    int type;  // PartitionCommandType
+    int a, b;  // Argumentos
+} PartitionCommand;
+
+// Estrutura com o estado de uma partição (no processo da partição)
+typedef struct PartitionWorker {
+    int part;  // Número da partição
+    int numParts;  // Número de partições
+    const int* owner;  // Partição dona de cada usuário
+    const int* localIndex;  // Índice de cada usuário dentro da sua partição
+    int localCount;  // Número de usuários da partição
+    int* globalIds;  // ID global de cada usuário local
+    int* offsets;  // CSR local: vizinhos (IDs globais) do usuário local i em neighbors[offsets[i] .. offsets[i + 1] - 1]
+    int* neighbors;
+    int* stamp;  // stamp[i] == currentStamp quando o usuário local i foi visitado na consulta atual
+    int currentStamp;
+    int* parent;  // Predecessor (ID global) de cada usuário local visitado
+    int* frontier;  // Usuários locais da fronteira atual
+    int frontierSize;
+    int* next;  // Usuários locais descobertos neste nível
+    int nextSize;
+    int target;  // Destino da consulta atual
+    bool found;  // true se o destino pertence à partição e foi visitado
+    int** outbox;  // Pares (vizinho, predecessor) para cada partição
+    int* outCount;  // Número de inteiros em cada outbox
+    int* outCapacity;  // Capacidade de cada outbox
+    const PartitionTransport* transport;
+    void* transportState;
+} PartitionWorker;
+
+// Estrutura para representar o grafo particionado (no coordenador)
+typedef struct PartitionedGraph {
+    int numUsers;  // Número de usuários
+    int numParts;  // Número de partições (processos)
+    int* owner;  // Partição dona de cada usuário
+    pid_t* workers;  // Processo de cada partição
+    const PartitionTransport* transport;  // Transporte das mensagens
+    void* transportState;  // Estado do transporte
+    int** pending;  // Pares recebidos no nível atual, por partição de destino
+    int* pendingCount;  // Número de inteiros em cada pending
+    int* pendingCapacity;  // Capacidade de cada pending
+    bool failed;  // true se algum processo deixou de responder
+} PartitionedGraph;
+
+// Estado do transporte por sockets Unix
+typedef struct SocketTransport {
+    int numParts;  // Número de partições
+    int (*fds)[2];  // fds[p][0]: ponta do coordenador; fds[p][1]: ponta da partição p
+} SocketTransport;
+
+static bool socketTransportCreate(int numParts, void** state) {
+    SocketTransport* transport = (SocketTransport*)malloc(sizeof(SocketTransport));
+    if (!transport) exit(1);  // Verificação de alocação de memória
+    transport->numParts = numParts;
+    transport->fds = (int(*)[2])malloc(numParts * sizeof(int[2]));
+    if (!transport->fds) exit(1);
+    for (int p = 0; p < numParts; p++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, transport->fds[p]) != 0) {
+            for (int q = 0; q < p; q++) {
+                close(transport->fds[q][0]);
+                close(transport->fds[q][1]);
+            }
+            free(transport->fds);
+            free(transport);
+            return false;
+        }
+    }
+    *state = transport;
+    return true;
+}
+
+static void socketTransportAttachWorker(void* state, int part) {
+    SocketTransport* transport = (SocketTransport*)state;
+    for (int p = 0; p < transport->numParts; p++) {
+        close(transport->fds[p][0]);
+        if (p != part) close(transport->fds[p][1]);
+        transport->fds[p][0] = -1;
+        if (p != part) transport->fds[p][1] = -1;
+    }
+}
+
+static void socketTransportAttachCoordinator(void* state) {
+    SocketTransport* transport = (SocketTransport*)state;
+    for (int p = 0; p < transport->numParts; p++) {
+        close(transport->fds[p][1]);
+        transport->fds[p][1] = -1;
+    }
+}
+
+// A ponta usada é a que continua aberta neste processo
+static int socketTransportFd(SocketTransport* transport, int part) {
+    return transport->fds[part][0] >= 0 ? transport->fds[part][0] : transport->fds[part][1];
+}
+
+static bool socketTransportSend(void* state, int part, const void* data, size_t size) {
+    int fd = socketTransportFd((SocketTransport*)state, part);
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+static bool socketTransportReceive(void* state, int part, void* data, size_t size) {
+    int fd = socketTransportFd((SocketTransport*)state, part);
+    char* bytes = (char*)data;
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+static void socketTransportDestroy(void* state) {
+    SocketTransport* transport = (SocketTransport*)state;
+    for (int p = 0; p < transport->numParts; p++) {
+        if (transport->fds[p][0] >= 0) close(transport->fds[p][0]);
+        if (transport->fds[p][1] >= 0) close(transport->fds[p][1]);
+    }
+    free(transport->fds);
+    free(transport);
+}
+
+const PartitionTransport unixSocketTransport = {
+    "unix-socket",
+    socketTransportCreate,
+    socketTransportAttachWorker,
+    socketTransportAttachCoordinator,
+    socketTransportSend,
+    socketTransportReceive,
+    socketTransportDestroy
+};
+
+// Acrescenta um par (vizinho, predecessor) a um array dinâmico de inteiros
+static void partitionAppendPair(int** items, int* count, int* capacity, int v, int parent) {
+    if (*count + 2 > *capacity) {
+        *capacity = *capacity ? 2 * *capacity : 1024;
+        *items = (int*)realloc(*items, *capacity * sizeof(int));
+        if (!*items) exit(1);  // Verificação de alocação de memória
+    }
+    (*items)[(*count)++] = v;
+    (*items)[(*count)++] = parent;
+}
+
+// Visita um usuário da partição; retorna true se ele ainda não tinha sido visitado
+static bool partitionVisit(PartitionWorker* w, int v, int parent) {
+    int i = w->localIndex[v];
+    if (w->stamp[i] == w->currentStamp) {
+        return false;
+    }
+    w->stamp[i] = w->currentStamp;
+    w->parent[i] = parent;
+    w->next[w->nextSize++] = i;
+    if (v == w->target) w->found = true;
+    return true;
+}
+
+// Laço do processo de uma partição: atende os comandos do coordenador até QUIT ou o canal fechar
+static void partitionWorkerMain(PartitionWorker* w) {
+    const PartitionTransport* t = w->transport;
+    PartitionCommand command;
+    int* counts = (int*)malloc(w->numParts * sizeof(int));
+    int* incoming = NULL;
+    int incomingCapacity = 0;
+    if (!counts) exit(1);  // Verificação de alocação de memória
+
+    while (t->receive(w->transportState, w->part, &command, sizeof(command))) {
+        if (command.type == PARTITION_QUIT) {
+            break;
+        } else if (command.type == PARTITION_START) {
+            if (w->currentStamp == INT_MAX) {
+                memset(w->stamp, 0, (w->localCount > 0 ? w->localCount : 1) * sizeof(int));
+                w->currentStamp = 0;
+            }
+            w->currentStamp++;
+            w->target = command.b;
+            w->found = false;
+            w->nextSize = 0;
+            if (w->owner[command.a] == w->part) {
+                partitionVisit(w, command.a, -1);
+            }
+            // A origem é a fronteira do nível 0
+            int* swap = w->frontier;
+            w->frontier = w->next;
+            w->next = swap;
+            w->frontierSize = w->nextSize;
+            w->nextSize = 0;
+        } else if (command.type == PARTITION_EXPAND) {
+            // Expande a fronteira: vizinhos locais entram direto na próxima fronteira
+            for (int p = 0; p < w->numParts; p++) {
+                w->outCount[p] = 0;
+            }
+            for (int f = 0; f < w->frontierSize; f++) {
+                int i = w->frontier[f];
+                int u = w->globalIds[i];
+                for (int e = w->offsets[i]; e < w->offsets[i + 1]; e++) {
+                    int v = w->neighbors[e];
+                    int p = w->owner[v];
+                    if (p == w->part) {
+                        partitionVisit(w, v, u);
+                    } else {
+                        partitionAppendPair(&w->outbox[p], &w->outCount[p], &w->outCapacity[p], v, u);
+                    }
+                }
+            }
+            for (int p = 0; p < w->numParts; p++) {
+                counts[p] = w->outCount[p] / 2;
+            }
+            bool ok = t->send(w->transportState, w->part, counts, w->numParts * sizeof(int));
+            for (int p = 0; ok && p < w->numParts; p++) {
+                if (w->outCount[p] > 0) {
+                    ok = t->send(w->transportState, w->part, w->outbox[p], w->outCount[p] * sizeof(int));
+                }
+            }
+            if (!ok) break;
+        } else if (command.type == PARTITION_DELIVER) {
+            // Aplica as mensagens das outras partições e responde (descobertos, destino encontrado)
+            int numInts = 2 * command.a;
+            if (numInts > incomingCapacity) {
+                incomingCapacity = numInts;
+                free(incoming);
+                incoming = (int*)malloc(incomingCapacity * sizeof(int));
+                if (!incoming) exit(1);
+            }
+            if (numInts > 0 && !t->receive(w->transportState, w->part, incoming, numInts * sizeof(int))) break;
+            for (int k = 0; k < numInts; k += 2) {
+                partitionVisit(w, incoming[k], incoming[k + 1]);
+            }
+            int status[2] = { w->nextSize, w->found };
+            int* swap = w->frontier;
+            w->frontier = w->next;
+            w->next = swap;
+            w->frontierSize = w->nextSize;
+            w->nextSize = 0;
+            if (!t->send(w->transportState, w->part, status, sizeof(status))) break;
+        } else if (command.type == PARTITION_PARENT) {
+            int i = w->localIndex[command.a];
+            int parent = w->stamp[i] == w->currentStamp ? w->parent[i] : -1;
+            if (!t->send(w->transportState, w->part, &parent, sizeof(parent))) break;
+        }
+    }
+    free(counts);
+    free(incoming);
+}
+
+// Faixas contíguas de IDs com aproximadamente o mesmo número de conexões
+static void partitionByRange(CSRGraph* csr, int numParts, int* owner) {
+    long long total = csr->offsets[csr->numUsers];
+    int part = 0;
+    for (int v = 0; v < csr->numUsers; v++) {
+        // A partição avança quando a soma das conexões anteriores passa da sua cota
+        while (part + 1 < numParts && (long long)csr->offsets[v] * numParts >= total * (part + 1)) {
+            part++;
+        }
+        owner[v] = part;
+    }
+}
+
+// Função para distribuir as comunidades de Louvain entre as partições
+// Cada comunidade (da maior para a menor em conexões) vai para a partição com menos conexões até o momento.
+// graph: Ponteiro para o grafo
+// numParts: Número de partições
+// owner: Array de saída com a partição de cada usuário
+void partitionByCommunity(Graph* graph, int numParts, int* owner) {
+    int n = graph->numUsers;
+    int numCommunities;
+    int* community = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    if (!community) exit(1);  // Verificação de alocação de memória
+    louvainCommunities(graph, community, &numCommunities);
+
+    // Conexões de cada comunidade, em pares (conexões << 32 | comunidade) para ordenar
+    long long* weights = (long long*)calloc(numCommunities > 0 ? numCommunities : 1, sizeof(long long));
+    long long* load = (long long*)calloc(numParts, sizeof(long long));
+    int* target = (int*)malloc((numCommunities > 0 ? numCommunities : 1) * sizeof(int));
+    if (!weights || !load || !target) exit(1);
+    for (int v = 0; v < n; v++) {
+        weights[community[v]] += graph->degree[v] + 1;  // + 1 para que usuários isolados também pesem
+    }
+    for (int c = 0; c < numCommunities; c++) {
+        weights[c] = (weights[c] << 32) | c;
+    }
+    qsort(weights, numCommunities, sizeof(long long), compareLongLongs);
+    for (int k = numCommunities - 1; k >= 0; k--) {
+        int lightest = 0;
+        for (int p = 1; p < numParts; p++) {
+            if (load[p] < load[lightest]) lightest = p;
+        }
+        target[weights[k] & 0xffffffffll] = lightest;
+        load[lightest] += weights[k] >> 32;
+    }
+    for (int v = 0; v < n; v++) {
+        owner[v] = target[community[v]];
+    }
+
+    free(community);
+    free(weights);
+    free(load);
+    free(target);
+}
+
+// Função para criar o grafo particionado
+// graph: Ponteiro para o grafo, inteiro na memória (as partições recebem uma cópia das suas listas)
+// numParts: Número de partições (processos)
+// owner: Partição de cada usuário (NULL para faixas contíguas de IDs)
+// transport: Transporte das mensagens (NULL para unixSocketTransport)
+// Retorna NULL se os canais ou os processos não puderem ser criados
+PartitionedGraph* createPartitionedGraph(Graph* graph, int numParts, const int* owner, const PartitionTransport* transport) {
+    int n = graph->numUsers;
+    CSRGraph* csr = getCSR(graph);
+    if (!transport) transport = &unixSocketTransport;
+
+    PartitionedGraph* pg = (PartitionedGraph*)calloc(1, sizeof(PartitionedGraph));
+    if (!pg) exit(1);  // Verificação de alocação de memória
+    pg->numUsers = n;
+    pg->numParts = numParts;
+    pg->transport = transport;
+    pg->owner = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    pg->workers = (pid_t*)malloc(numParts * sizeof(pid_t));
+    pg->pending = (int**)calloc(numParts, sizeof(int*));
+    pg->pendingCount = (int*)calloc(numParts, sizeof(int));
+    pg->pendingCapacity = (int*)calloc(numParts, sizeof(int));
+    int* localIndex = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    int* localCount = (int*)calloc(numParts, sizeof(int));
+    if (!pg->owner || !pg->workers || !pg->pending || !pg->pendingCount || !pg->pendingCapacity || !localIndex ||
+        !localCount) exit(1);
+    if (owner) {
+        memcpy(pg->owner, owner, n * sizeof(int));
+    } else {
+        partitionByRange(csr, numParts, pg->owner);
+    }
+    for (int v = 0; v < n; v++) {
+        localIndex[v] = localCount[pg->owner[v]]++;
+    }
+
+    if (!transport->create(numParts, &pg->transportState)) {
+        free(localIndex);
+        free(localCount);
+        pg->numParts = 0;
+        freePartitionedGraph(pg);
+        return NULL;
+    }
+
+    fflush(NULL);  // Nada pendente nos buffers do stdio é duplicado nos processos
+    int started = 0;
+    for (int p = 0; p < numParts; p++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            break;
+        }
+        if (pid == 0) {
+            // Processo da partição: copia as suas listas e atende o coordenador
+            transport->attachWorker(pg->transportState, p);
+            PartitionWorker w;
+            memset(&w, 0, sizeof(w));
+            w.part = p;
+            w.numParts = numParts;
+            w.owner = pg->owner;
+            w.localIndex = localIndex;
+            w.localCount = localCount[p];
+            int size = w.localCount > 0 ? w.localCount : 1;
+            w.globalIds = (int*)malloc(size * sizeof(int));
+            w.offsets = (int*)malloc((size + 1) * sizeof(int));
+            w.stamp = (int*)calloc(size, sizeof(int));
+            w.parent = (int*)malloc(size * sizeof(int));
+            w.frontier = (int*)malloc(size * sizeof(int));
+            w.next = (int*)malloc(size * sizeof(int));
+            w.outbox = (int**)calloc(numParts, sizeof(int*));
+            w.outCount = (int*)calloc(numParts, sizeof(int));
+            w.outCapacity = (int*)calloc(numParts, sizeof(int));
+            if (!w.globalIds || !w.offsets || !w.stamp || !w.parent || !w.frontier || !w.next || !w.outbox ||
+                !w.outCount || !w.outCapacity) _exit(1);
+            w.offsets[0] = 0;
+            for (int v = 0; v < n; v++) {
+                if (pg->owner[v] == p) {
+                    int i = localIndex[v];
+                    w.globalIds[i] = v;
+                    w.offsets[i + 1] = csr->offsets[v + 1] - csr->offsets[v];
+                }
+            }
+            for (int i = 0; i < w.localCount; i++) {
+                w.offsets[i + 1] += w.offsets[i];
+            }
+            w.neighbors = (int*)malloc((w.offsets[w.localCount] + 1) * sizeof(int));
+            if (!w.neighbors) _exit(1);
+            for (int i = 0; i < w.localCount; i++) {
+                int v = w.globalIds[i];
+                memcpy(w.neighbors + w.offsets[i], csr->neighbors + csr->offsets[v],
+                       (csr->offsets[v + 1] - csr->offsets[v]) * sizeof(int));
+            }
+            w.transport = transport;
+            w.transportState = pg->transportState;
+            partitionWorkerMain(&w);
+            _exit(0);  // Sem atexit nem buffers do coordenador
+        }
+        pg->workers[started++] = pid;
+    }
+    transport->attachCoordinator(pg->transportState);
+    free(localIndex);
+    free(localCount);
+
+    if (started < numParts) {
+        pg->numParts = started;  // Só os processos criados recebem QUIT
+        freePartitionedGraph(pg);
+        return NULL;
+    }
+    return pg;
+}
+
+// Função para encerrar os processos e liberar o grafo particionado
+void freePartitionedGraph(PartitionedGraph* pg) {
+    if (pg == NULL) {
+        return;
+    }
+    PartitionCommand quit = { PARTITION_QUIT, 0, 0 };
+    for (int p = 0; p < pg->numParts; p++) {
+        pg->transport->send(pg->transportState, p, &quit, sizeof(quit));
+    }
+    if (pg->transportState) {
+        pg->transport->destroy(pg->transportState);  // Fecha os canais: um processo parado em receive também sai
+    }
+    for (int p = 0; p < pg->numParts; p++) {
+        waitpid(pg->workers[p], NULL, 0);
+    }
+    for (int p = 0; p < pg->numParts; p++) {
+        free(pg->pending[p]);
+    }
+    free(pg->pending);
+    free(pg->pendingCount);
+    free(pg->pendingCapacity);
+    free(pg->owner);
+    free(pg->workers);
+    free(pg);
+}
+
+// Envia um comando a todas as partições
+static bool partitionBroadcast(PartitionedGraph* pg, PartitionCommand command) {
+    for (int p = 0; p < pg->numParts; p++) {
+        if (!pg->transport->send(pg->transportState, p, &command, sizeof(command))) return false;
+    }
+    return true;
+}
+
+// Executa um nível da BFS distribuída
+// *discovered recebe o total de usuários descobertos e *found se o destino foi alcançado
+static bool partitionLevel(PartitionedGraph* pg, long long* discovered, bool* found) {
+    const PartitionTransport* t = pg->transport;
+    int numParts = pg->numParts;
+    int* counts = (int*)malloc(numParts * sizeof(int));
+    if (!counts) exit(1);  // Verificação de alocação de memória
+    bool ok = partitionBroadcast(pg, (PartitionCommand){ PARTITION_EXPAND, 0, 0 });
+
+    // Recolhe as mensagens de cada partição, agrupadas pela partição de destino
+    for (int p = 0; p < numParts; p++) {
+        pg->pendingCount[p] = 0;
+    }
+    for (int p = 0; ok && p < numParts; p++) {
+        ok = t->receive(pg->transportState, p, counts, numParts * sizeof(int));
+        for (int d = 0; ok && d < numParts; d++) {
+            int numInts = 2 * counts[d];
+            if (pg->pendingCount[d] + numInts > pg->pendingCapacity[d]) {
+                pg->pendingCapacity[d] = 2 * (pg->pendingCount[d] + numInts);
+                pg->pending[d] = (int*)realloc(pg->pending[d], pg->pendingCapacity[d] * sizeof(int));
+                if (!pg->pending[d]) exit(1);
+            }
+            if (numInts > 0) {
+                ok = t->receive(pg->transportState, p, pg->pending[d] + pg->pendingCount[d], numInts * sizeof(int));
+                pg->pendingCount[d] += numInts;
+            }
+        }
+    }
+
+    // Entrega as mensagens aos donos e soma as respostas
+    for (int p = 0; ok && p < numParts; p++) {
+        PartitionCommand deliver = { PARTITION_DELIVER, pg->pendingCount[p] / 2, 0 };
+        ok = t->send(pg->transportState, p, &deliver, sizeof(deliver)) &&
+             (pg->pendingCount[p] == 0 ||
+              t->send(pg->transportState, p, pg->pending[p], pg->pendingCount[p] * sizeof(int)));
+    }
+    *discovered = 0;
+    *found = false;
+    for (int p = 0; ok && p < numParts; p++) {
+        int status[2];
+        ok = t->receive(pg->transportState, p, status, sizeof(status));
+        if (ok) {
+            *discovered += status[0];
+            *found = *found || status[1];
+        }
+    }
+
+    free(counts);
+    return ok;
+}
+
+// Função para encontrar o menor caminho pela BFS distribuída
+// pg: Grafo particionado
+// source: ID do usuário de origem
+// target: ID do usuário de destino
+// result: Resultado (path é o buffer do chamador)
+// Retorna true se o caminho existe e coube em result->path (result->distance é -1 se não há caminho ou se algum
+// processo deixou de responder, o que também marca o grafo particionado como falho)
+bool partitionedShortestPath(PartitionedGraph* pg, int source, int target, PathResult* result) {
+    INSTRUMENT_BEGIN(searchTimer);
+    result->length = 0;
+    result->distance = -1;
+    if (pg->failed) {
+        return false;
+    }
+
+    bool ok = partitionBroadcast(pg, (PartitionCommand){ PARTITION_START, source, target });
+    int distance = source == target ? 0 : -1;
+    int level = 0;
+    while (ok && distance < 0) {
+        long long discovered;
+        bool found;
+        ok = partitionLevel(pg, &discovered, &found);
+        level++;
+        if (found) {
+            distance = level;
+        } else if (discovered == 0) {
+            break;  // Nenhuma partição tem fronteira: o destino é inalcançável
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_SEARCH, searchTimer);
+    if (!ok) {
+        pg->failed = true;
+        return false;
+    }
+    result->distance = distance;
+    if (distance < 0 || distance + 1 > result->capacity) {
+        return false;
+    }
+
+    // Reconstrói o caminho pedindo o predecessor de cada usuário ao seu dono
+    INSTRUMENT_BEGIN(reconstructTimer);
+    int crawl = target;
+    for (int i = distance; i >= 0 && ok; i--) {
+        result->path[i] = crawl;
+        if (i > 0) {
+            int p = pg->owner[crawl];
+            PartitionCommand request = { PARTITION_PARENT, crawl, 0 };
+            ok = pg->transport->send(pg->transportState, p, &request, sizeof(request)) &&
+                 pg->transport->receive(pg->transportState, p, &crawl, sizeof(crawl));
+        }
+    }
+    INSTRUMENT_END(PHASE_BFS_RECONSTRUCT, reconstructTimer);
+    if (!ok) {
+        pg->failed = true;
+        result->distance = -1;
+        return false;
+    }
+    result->length = distance + 1;
+    return true;
+}
+
+/*
+Funcoes Auxiliares:
+
+1. `freeGraph`
+    - Objetivo:
+      - Liberar toda a memória alocada para o grafo.
+    - Descrição:
+      - Esta função percorre a lista de adjacências de cada usuário e libera a memória associada a essas listas.
+        Depois, libera a memória da lista de adjacências e dos próprios usuários.
+        Por fim, a função libera a memória alocada para a estrutura do grafo em si.
+        A função é importante para evitar vazamentos de memória ao desalocar todos os recursos utilizados pelo grafo.
+*/
+
+// Função para liberar a memória alocada para o grafo
+// graph: Ponteiro para o grafo
+void freeGraph(Graph* graph) {
+    for (int i = 0; i < graph->numUsers; i++) {
+        AdjacencyNode* temp = graph->adjList[i];
+        while (temp) {
+            AdjacencyNode* toDelete = temp;
+            temp = temp->next;
+            free(toDelete);
+        }
+    }
+    free(graph->adjList);
+    free(graph->visited);
+    free(graph->degree);
+    freeCSR(graph->csr);
+    if (graph->directed) {
+        for (int i = 0; i < graph->numUsers; i++) {
+            AdjacencyNode* temp = graph->inList[i];
+            while (temp) {
+                AdjacencyNode* toDelete = temp;
+                temp = temp->next;
+                free(toDelete);
+            }
+        }
+        free(graph->inList);
+        free(graph->inDegree);
+        freeCSR(graph->reverseCSR);
+        freeCSR(graph->undirectedCSR);
+    }
+    freeSlackCSR(graph->slack);
+    freeShortestPathCache(graph);
+
+    // Libera a memória alocada para os usuários
+    for (int i = 0; i < graph->numUsers; i++) {
+        free(graph->users[i]);
+    }
+    free(graph->users);
+
+    free(graph);
+}
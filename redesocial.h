@@ -0,0 +1,473 @@
+/*
+Biblioteca da rede social (redesocial.h)
+
+Descrição:
+- Interface pública do grafo e dos algoritmos implementados em `redesocial.c`. O programa de linha de comando
+  (`main.c`), o benchmark e outros programas incluem este arquivo e ligam com a biblioteca `redesocial`.
+- As buscas de caminho (`shortestPath`, `longestPath`, `longestPathBetween`) não imprimem nada: o resultado vai
+  para um `PathResult` com buffer do chamador e o estado da busca fica em um `BFSScratch` reutilizável, de modo
+  que uma consulta não aloca memória.
+- As estruturas internas (caches, servidor, grafo versionado, log) são opacas e só são usadas pelas funções abaixo.
+*/
+
+#ifndef REDESOCIAL_H
+#define REDESOCIAL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define MAX_NAME_LENGTH 10
+#define SERVER_TREE_CACHE_BYTES ((size_t)64 << 20)  // Orçamento do cache de árvores de BFS do servidor
+#define OUTPUT_BUFFER_SIZE ((size_t)1 << 20)  // Capacidade padrão do buffer de saída
+
+// Contadores de eventos da instrumentação (opção de compilação ED_INSTRUMENTATION)
+typedef enum InstrumentCounter {
+    COUNTER_VERTICES_DEQUEUED,
+    COUNTER_EDGES_SCANNED,
+    COUNTER_DFS_EXPANDED,
+    COUNTER_ALLOCATIONS,
+    NUM_COUNTERS
+} InstrumentCounter;
+
+// Fases cronometradas
+typedef enum InstrumentPhase {
+    PHASE_MAIN_BUILD,
+    PHASE_MAIN_PRINT,
+    PHASE_MAIN_QUERIES,
+    PHASE_BFS_SEARCH,
+    PHASE_BFS_RECONSTRUCT,
+    PHASE_DFS_LONGEST,
+    PHASE_DFS_LONGEST_2,
+    PHASE_SERVER_BATCH,
+    NUM_PHASES
+} InstrumentPhase;
+
+#ifdef ED_INSTRUMENTATION
+
+unsigned long long instrumentNow();
+void instrumentCount(InstrumentCounter counter, unsigned long long amount);
+void instrumentPhase(InstrumentPhase phase, unsigned long long start);
+void instrumentationReport(FILE* out, bool json);
+void instrumentationReportAtExit();
+
+#define INSTRUMENT_COUNT(counter, amount) instrumentCount(counter, amount)
+#define INSTRUMENT_BEGIN(timer) unsigned long long timer = instrumentNow()
+#define INSTRUMENT_END(phase, timer) instrumentPhase(phase, timer)
+
+#else
+
+#define INSTRUMENT_COUNT(counter, amount) ((void)0)
+#define INSTRUMENT_BEGIN(timer) ((void)0)
+#define INSTRUMENT_END(phase, timer) ((void)0)
+
+#endif
+
+// Estrutura para representar um usuário
+typedef struct User {
+    int id;  // ID único do usuário
+    char nome[MAX_NAME_LENGTH];  // Nome do usuário
+} User;
+
+// Estrutura para representar um nó na lista de adjacência
+typedef struct AdjacencyNode {
+    User* user;  // Ponteiro para o usuário conectado
+    int weight;  // Peso da conexão (1 em grafos sem pesos)
+    struct AdjacencyNode* next;  // Ponteiro para o próximo nó adjacente
+} AdjacencyNode;
+
+// Estrutura para representar as adjacências em formato CSR (Compressed Sparse Row)
+// Os vizinhos do usuário v ficam em neighbors[offsets[v]] .. neighbors[offsets[v + 1] - 1], ordenados por ID.
+typedef struct CSRGraph {
+    int numUsers;  // Número de usuários (nós)
+    int* offsets;  // Array de numUsers + 1 posições com o início de cada lista
+    int* neighbors;  // Array com todos os vizinhos, lista após lista
+    int* weights;  // Peso de cada posição de neighbors (NULL em grafos sem pesos)
+} CSRGraph;
+
+// Estrutura para representar o grafo
+typedef struct Graph {
+    User** users;  // Array de ponteiros para os usuários
+    AdjacencyNode** adjList;  // Array de listas de adjacências (em grafos direcionados, quem cada usuário segue)
+    int numUsers;  // Número de usuários (nós)
+    int* visited;  // Array para rastrear os usuários visitados
+    int* degree;  // Número de conexões de cada usuário (em grafos direcionados, conexões de saída)
+    CSRGraph* csr;  // CSR em cache (NULL quando precisa ser reconstruído)
+    bool directed;  // true no modo de seguidores (conexões com sentido)
+    AdjacencyNode** inList;  // Listas de seguidores de cada usuário (NULL em grafos não direcionados)
+    int* inDegree;  // Número de seguidores de cada usuário (NULL em grafos não direcionados)
+    CSRGraph* reverseCSR;  // CSR das conexões de entrada em cache (NULL quando precisa ser reconstruído)
+    CSRGraph* undirectedCSR;  // CSR simétrico de um grafo direcionado em cache (NULL quando precisa ser reconstruído)
+    struct SlackCSR* slack;  // CSR com folga atualizado a cada mudança (NULL se desabilitado)
+    struct ShortestPathCache* pathCache;  // Cache de menores caminhos (NULL se desabilitado)
+    struct EdgeLog* edgeLog;  // Log onde as mudanças são gravadas (NULL se desabilitado)
+    unsigned long long version;  // Incrementada a cada mudança nas conexões
+    bool weighted;  // true se alguma conexão tem peso (senão as buscas usam a BFS)
+} Graph;
+
+// Estrutura para representar uma fila
+typedef struct Queue {
+    int* items;  // Array de itens da fila
+    int capacity;  // Capacidade do array de itens
+    int front;  // Índice do primeiro item
+    int rear;  // Índice do último item
+} Queue;
+
+// Métricas de pontuação das sugestões
+typedef enum RecommendationScore {
+    SCORE_COMMON_NEIGHBORS,  // Número de amigos em comum
+    SCORE_ADAMIC_ADAR,  // Soma de 1 / log(grau) dos amigos em comum
+    SCORE_JACCARD  // Amigos em comum / união dos amigos
+} RecommendationScore;
+
+// Estrutura para representar uma sugestão de amizade
+typedef struct Recommendation {
+    int userId;  // ID do usuário sugerido
+    double score;  // Pontuação da sugestão
+} Recommendation;
+
+// Estrutura com o estado reutilizável de uma BFS
+typedef struct BFSScratch {
+    int numUsers;  // Número de usuários do grafo
+    int* stamp;  // stamp[v] == currentStamp quando v foi visitado na busca atual
+    int currentStamp;  // Carimbo da busca atual
+    int* queue;  // Fila da busca (numUsers posições)
+    int* distance;  // Distância de cada usuário visitado
+    int* predecessor;  // Predecessor de cada usuário visitado
+    int* localIndex;  // Índice local de cada usuário em um subconjunto (subgrafo induzido)
+} BFSScratch;
+
+// Estrutura para representar o resultado de uma busca de caminho
+// O chamador fornece o buffer path; as funções de busca não alocam memória.
+typedef struct PathResult {
+    int* path;  // IDs do caminho, da origem ao destino (buffer do chamador)
+    int capacity;  // Número de posições de path
+    int length;  // Número de usuários no caminho (0 se não há caminho)
+    int distance;  // Número de conexões do caminho (-1 se não há caminho)
+} PathResult;
+
+// Estrutura para representar a vizinhança de k saltos de um usuário
+typedef struct KHopResult {
+    int* members;  // IDs dos membros em ordem de distância (members[0] é o próprio usuário)
+    int* levelStart;  // Membros a distância d: members[levelStart[d]] .. members[levelStart[d + 1] - 1]
+    int numLevels;  // Número de distâncias presentes (0 .. numLevels - 1)
+    int count;  // Número total de membros
+    bool truncated;  // true se a busca parou por atingir maxResults
+    CSRGraph* subgraph;  // Subgrafo induzido, com vértice i = members[i] (NULL se não solicitado)
+} KHopResult;
+
+// Estrutura para representar a função de vizinhança de um grafo
+typedef struct NeighborhoodFunction {
+    double* values;  // values[t]: estimativa dos pares (u, v) com distância <= t (inclui u == v)
+    double* histogram;  // histogram[t]: estimativa dos pares com distância exatamente t (t >= 1)
+    int numSteps;  // Número de posições em values e histogram
+    double averageDistance;  // Distância média entre pares alcançáveis
+    double effectiveDiameter;  // Menor distância (interpolada) que cobre 90% dos pares alcançáveis
+} NeighborhoodFunction;
+
+// Estrutura para representar uma mudança em uma direção de uma conexão
+typedef struct EdgeDelta {
+    int src;  // ID do usuário de origem
+    int dest;  // ID do usuário de destino
+    long long sequence;  // Ordem em que a mudança foi registrada
+    bool added;  // true para inserção, false para remoção
+} EdgeDelta;
+
+// Estrutura para representar uma versão imutável do grafo
+typedef struct GraphSnapshot {
+    CSRGraph* csr;  // Adjacência da versão
+    unsigned long long version;  // Número da versão
+    unsigned long long retireEpoch;  // Época em que a versão foi substituída
+    struct GraphSnapshot* nextRetired;  // Próxima versão aguardando liberação
+} GraphSnapshot;
+
+// Estrutura para representar um snapshot mapeado em memória
+typedef struct MappedCSR {
+    CSRGraph csr;  // CSR apontando para o arquivo mapeado
+    void* mapping;  // Início do mapeamento
+    size_t mappingSize;  // Tamanho do mapeamento
+} MappedCSR;
+
+// Estrutura para representar uma árvore de BFS
+typedef struct BFSTree {
+    int source;  // ID do usuário de origem
+    int numUsers;  // Número de usuários
+    unsigned long long version;  // Versão do grafo em que a árvore foi calculada
+    int* distance;  // Distância de cada usuário até a origem (-1 se inalcançável)
+    int* predecessor;  // Predecessor de cada usuário no caminho a partir da origem (-1 na origem)
+    atomic_int references;  // Referências (cache + quem obteve a árvore)
+    unsigned long long lastUse;  // Relógio do cache no último uso
+} BFSTree;
+
+// Formatos de exportação do grafo
+typedef enum ExportFormat {
+    EXPORT_DOT,  // Graphviz (DOT)
+    EXPORT_GRAPHML  // GraphML
+} ExportFormat;
+
+// Estrutura para representar um caminho destacado na exportação
+typedef struct ExportHighlight {
+    const PathResult* path;  // Caminho destacado
+    const char* color;  // Cor do Graphviz ("blue", "green", "red")
+    const char* label;  // Descrição usada no comentário do DOT (NULL para "caminho")
+} ExportHighlight;
+
+// Estrutura para representar as opções de exportação
+typedef struct ExportOptions {
+    ExportFormat format;  // Formato de saída
+    const int* members;  // Usuários a exportar (NULL para todos), por exemplo os membros de uma KHopResult
+    int numMembers;  // Número de usuários em members
+    double sampleRate;  // Fração dos usuários mantida pela amostragem (1.0 mantém todos)
+    unsigned long long seed;  // Semente da amostragem
+    int minDegree;  // Usuários com grau menor são omitidos
+    int maxDegree;  // Usuários com grau maior são omitidos (0 = sem limite)
+    const ExportHighlight* highlights;  // Caminhos destacados
+    int numHighlights;  // Número de caminhos destacados
+} ExportOptions;
+
+// Estrutura para representar um contato com data (mensagem, curtida, interação)
+typedef struct TemporalEdge {
+    int src;  // ID do usuário de origem
+    int dest;  // ID do usuário de destino
+    long long time;  // Instante do contato (>= 0, por exemplo segundos desde 1970)
+} TemporalEdge;
+
+// Estrutura para representar os contatos em formato CSR, ordenados por instante dentro de cada usuário
+// Os contatos de saída de v ficam nas posições offsets[v] .. offsets[v + 1] - 1 de neighbors e times.
+typedef struct TemporalCSR {
+    int numUsers;  // Número de usuários (nós)
+    int* offsets;  // Array de numUsers + 1 posições com o início de cada lista
+    int* neighbors;  // Usuário contatado em cada posição
+    long long* times;  // Instante de cada posição (crescente dentro de cada lista)
+    bool directed;  // false se cada contato foi inserido nos dois sentidos
+} TemporalCSR;
+
+// Estrutura para representar o meio de comunicação entre o coordenador e os processos de um grafo particionado
+// O estado é criado antes do fork; cada lado chama attach uma vez e depois troca mensagens pelo canal `part`
+// (no processo de uma partição, o seu próprio número). send e receive transferem exatamente size bytes.
+typedef struct PartitionTransport {
+    const char* name;  // Nome do transporte
+    bool (*create)(int numParts, void** state);  // Cria os canais (antes do fork)
+    void (*attachWorker)(void* state, int part);  // No processo da partição: fica só com o próprio canal
+    void (*attachCoordinator)(void* state);  // No coordenador: fecha as pontas dos processos
+    bool (*send)(void* state, int part, const void* data, size_t size);  // Envia bytes pelo canal
+    bool (*receive)(void* state, int part, void* data, size_t size);  // Recebe bytes do canal
+    void (*destroy)(void* state);  // Fecha os canais e libera o estado
+} PartitionTransport;
+
+// Transporte padrão: um par de sockets Unix por partição
+extern const PartitionTransport unixSocketTransport;
+
+// Estruturas opacas
+typedef struct Recommender Recommender;
+typedef struct PPRScratch PPRScratch;
+typedef struct SlackCSR SlackCSR;
+typedef struct ShortestPathCache ShortestPathCache;
+typedef struct VersionedGraph VersionedGraph;
+typedef struct EdgeLog EdgeLog;
+typedef struct PathLRUCache PathLRUCache;
+typedef struct BFSTreeCache BFSTreeCache;
+typedef struct QueryServer QueryServer;
+typedef struct OutputBuffer OutputBuffer;
+typedef struct DijkstraScratch DijkstraScratch;
+typedef struct PartitionedGraph PartitionedGraph;
+
+// 1-etapa: Estrutura de Dados para o Grafo
+AdjacencyNode* createNode(User* user);
+Graph* createGraph(int numUsers, char* names[]);
+Graph* createNumberedGraph(int numUsers);
+void addConnection(Graph* graph, int src, int dest);
+
+// 2-etapa: Gerar Conexões Aleatórias
+bool connectionExists(Graph* graph, int src, int dest);
+void generateRandomConnections(Graph* graph, int numConnections);
+void generateUniformConnections(Graph* graph, int numConnections, unsigned int seed);
+void generatePreferentialConnections(Graph* graph, int connectionsPerUser, unsigned int seed);
+int countConnections(Graph* graph);
+
+// 3-etapa: Implementar a Busca em Largura (BFS) para encontrar o menor caminho
+Queue* createQueue(int capacity);
+int isEmpty(Queue* queue);
+int enqueue(Queue* queue, int value);
+int dequeue(Queue* queue);
+void freeQueue(Queue* queue);
+bool shortestPath(Graph* graph, BFSScratch* scratch, int startVertex, int finalVertex, PathResult* result);
+
+// 4-etapa: Encontrar o Maior Caminho do grafo
+void dfsFindLongestPath(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* endVertex, int* bestPath);
+bool longestPath(Graph* graph, BFSScratch* scratch, PathResult* result);
+
+// 5-etapa: Implementa DFS para descobrir o caminho mais longo entre dois pontos.
+void dfsFindLongestPath_2(Graph* graph, int currentVertex, int* visited, int* currentPath, int pathIndex, int* maxPathLength, int* bestPath, int finalVertex);
+bool longestPathBetween(Graph* graph, BFSScratch* scratch, int startVertex, int finalVertex, PathResult* result);
+
+// 6-etapa: Amigos em comum
+CSRGraph* buildCSR(Graph* graph);
+CSRGraph* getCSR(Graph* graph);
+void freeCSR(CSRGraph* csr);
+int intersectSorted(const int* a, int na, const int* b, int nb, int* out);
+int mutualFriends(Graph* graph, int a, int b, int* result);
+int countMutualFriends(Graph* graph, int a, int b);
+
+// 7-etapa: Sugestão de amizades ("pessoas que você talvez conheça")
+Recommender* createRecommender(int numUsers, int maxNeighborSample);
+void freeRecommender(Recommender* rec);
+int recommendFriends(Graph* graph, Recommender* rec, int user, int k, RecommendationScore metric, Recommendation* result);
+void recommendFriendsBatch(Graph* graph, const int* users, int count, int k, RecommendationScore metric,
+                           int maxNeighborSample, Recommendation* results, int* resultCounts);
+
+// 8-etapa: Contagem de triângulos e coeficiente de agrupamento
+long long countTriangles(Graph* graph, long long* perUser);
+double localClusteringCoefficients(Graph* graph, double* coefficient);
+long long approximateTriangles(Graph* graph, int numSamples, unsigned long long seed, double* globalClustering);
+
+// 9-etapa: Vizinhança de k saltos (rede ego)
+BFSScratch* createBFSScratch(int numUsers);
+void freeBFSScratch(BFSScratch* scratch);
+CSRGraph* extractInducedSubgraph(Graph* graph, BFSScratch* scratch, const int* members, int count);
+int kHopNeighborhood(Graph* graph, BFSScratch* scratch, int user, int maxHops, int maxResults, bool buildSubgraph, KHopResult* result);
+void freeKHopResult(KHopResult* result);
+
+// 10-etapa: Função de vizinhança aproximada e histograma de graus de separação (HyperANF)
+void computeNeighborhoodFunction(Graph* graph, int log2Registers, int maxSteps, NeighborhoodFunction* result);
+void freeNeighborhoodFunction(NeighborhoodFunction* result);
+
+// 11-etapa: Centralidade de intermediação (betweenness) pelo algoritmo de Brandes
+void computeBetweenness(Graph* graph, double* centrality);
+double approximateBetweenness(Graph* graph, int numSamples, unsigned long long seed, double* centrality);
+
+// 12-etapa: PageRank e PageRank personalizado
+int computePageRank(Graph* graph, double damping, double tolerance, int maxIterations, double* rank);
+PPRScratch* createPPRScratch(int numUsers);
+void freePPRScratch(PPRScratch* scratch);
+int personalizedPageRank(Graph* graph, PPRScratch* scratch, int user, double alpha, double epsilon, int maxResults, Recommendation* result);
+
+// 13-etapa: Detecção de comunidades (propagação de rótulos e Louvain)
+double computeModularity(Graph* graph, const int* community);
+double labelPropagationCommunities(Graph* graph, int maxIterations, unsigned long long seed, int* community, int* numCommunities);
+double louvainCommunities(Graph* graph, int* community, int* numCommunities);
+void communityOrdering(const int* community, int numUsers, int numCommunities, int* order);
+CSRGraph* reorderCSR(const CSRGraph* csr, const int* order);
+
+// 14-etapa: Decomposição em k-cores
+int coreDecomposition(Graph* graph, int* core);
+int parallelCoreDecomposition(Graph* graph, int* core);
+CSRGraph* extractMaxCore(Graph* graph, BFSScratch* scratch, int** members, int* count);
+
+// 15-etapa: Remoção de conexões, adjacência dinâmica e cache incremental de menores caminhos
+CSRGraph* buildCSRFromSlack(const SlackCSR* slack);
+void freeSlackCSR(SlackCSR* slack);
+void enableDynamicAdjacency(Graph* graph);
+int bfsShortestPathView(const int* begin, const int* end, const int* neighbors, BFSScratch* scratch,
+                        int source, int target, int* visitedCount);
+bool removeConnection(Graph* graph, int src, int dest);
+ShortestPathCache* createShortestPathCache(Graph* graph, int capacity);
+void freeShortestPathCache(Graph* graph);
+int cachedShortestPath(Graph* graph, int source, int target, int* path, int* pathLength);
+
+// 16-etapa: Leituras concorrentes com snapshots (grafo versionado)
+long long normalizeEdgeDeltas(EdgeDelta* deltas, long long count);
+CSRGraph* mergeCSRWithDeltas(const CSRGraph* base, int numUsers, const EdgeDelta* deltas, long long count);
+VersionedGraph* createVersionedGraph(Graph* graph);
+void freeVersionedGraph(VersionedGraph* vg);
+int registerReader(VersionedGraph* vg);
+void unregisterReader(VersionedGraph* vg, int slot);
+const GraphSnapshot* readerEnter(VersionedGraph* vg, int slot);
+void readerExit(VersionedGraph* vg, int slot);
+void versionedAddConnection(VersionedGraph* vg, int src, int dest);
+void versionedRemoveConnection(VersionedGraph* vg, int src, int dest);
+unsigned long long publishSnapshot(VersionedGraph* vg);
+int snapshotShortestPath(const GraphSnapshot* snapshot, BFSScratch* scratch, int source, int target, int* path, int* pathLength);
+
+// 17-etapa: Log de conexões somente-anexação, replay e compactação
+EdgeLog* openEdgeLog(const char* path, int numUsers);
+bool edgeLogFlush(EdgeLog* log, bool sync);
+bool edgeLogAppend(EdgeLog* log, int src, int dest, bool added);
+void closeEdgeLog(EdgeLog* log);
+bool attachEdgeLog(Graph* graph, EdgeLog* log);
+long long replayEdgeLog(const char* path, int* numUsers, EdgeDelta** deltas);
+bool writeCSRSnapshot(const CSRGraph* csr, const char* path);
+MappedCSR* mapCSRSnapshot(const char* path);
+void unmapCSRSnapshot(MappedCSR* mapped);
+CSRGraph* recoverCSR(const char* snapshotPath, const char* logPath, int numUsers);
+bool compactEdgeLog(EdgeLog* log, const char* snapshotPath, const char* logPath);
+
+// 18-etapa: Cache LRU concorrente de consultas de caminho
+PathLRUCache* createPathLRUCache(int capacity, int numShards);
+void freePathLRUCache(PathLRUCache* cache);
+int lruShortestPath(Graph* graph, PathLRUCache* cache, BFSScratch* scratch, int source, int target, int* path, int* pathLength);
+void pathLRUCacheStats(PathLRUCache* cache, long long* hits, long long* misses);
+
+// 19-etapa: Cache de árvores de BFS por origem
+BFSTree* buildBFSTree(Graph* graph, int source);
+int bfsTreePath(const BFSTree* tree, int target, int* path);
+void releaseBFSTree(BFSTree* tree);
+BFSTreeCache* createBFSTreeCache(size_t memoryBudget);
+void freeBFSTreeCache(BFSTreeCache* cache);
+BFSTree* acquireBFSTree(Graph* graph, BFSTreeCache* cache, int source);
+int bfsTreeShortestPath(Graph* graph, BFSTreeCache* cache, int source, int target, int* path, int* pathLength);
+
+// 20-etapa: Modo servidor de consultas
+Graph* createGraphFromCSR(CSRGraph* csr);
+QueryServer* createQueryServer(Graph* graph, int numWorkers, size_t treeCacheBytes);
+void freeQueryServer(QueryServer* server);
+void serveConnection(QueryServer* server, int inFd, int outFd);
+int listenSocketServer(const char* path);
+void runSocketServer(QueryServer* server, int listener, const char* path);
+
+// 21-etapa: Saída com buffer
+int formatInt(long long value, char* out);
+OutputBuffer* createOutputBuffer(int fd, size_t size);
+bool outputFlush(OutputBuffer* out);
+bool freeOutputBuffer(OutputBuffer* out);
+void outputBytes(OutputBuffer* out, const char* data, size_t length);
+void outputString(OutputBuffer* out, const char* text);
+void outputChar(OutputBuffer* out, char c);
+void outputInt(OutputBuffer* out, long long value);
+void outputPath(OutputBuffer* out, Graph* graph, const PathResult* result);
+void outputGraph(OutputBuffer* out, Graph* graph);
+
+// 22-etapa: Exportação para Graphviz (DOT) e GraphML
+void initExportOptions(ExportOptions* options);
+int exportGraph(OutputBuffer* out, Graph* graph, const ExportOptions* options);
+
+// 23-etapa: Conexões com peso (Dijkstra com heap radix e delta-stepping)
+bool addWeightedConnection(Graph* graph, int src, int dest, int weight);
+void generateRandomWeights(Graph* graph, int maxWeight, unsigned int seed);
+DijkstraScratch* createDijkstraScratch(int numUsers);
+void freeDijkstraScratch(DijkstraScratch* scratch);
+long long weightedShortestPath(Graph* graph, DijkstraScratch* scratch, int source, int target, PathResult* result);
+void weightedDistances(Graph* graph, int source, long long delta, long long* distance);
+
+// 24-etapa: Grafo direcionado de seguidores (adjacência de saída e de entrada)
+bool enableDirectedMode(Graph* graph);
+void addFollow(Graph* graph, int follower, int followee);
+bool removeFollow(Graph* graph, int follower, int followee);
+CSRGraph* getReverseCSR(Graph* graph);
+CSRGraph* getUndirectedCSR(Graph* graph);
+int followersOf(Graph* graph, int user, const int** followers);
+int followingOf(Graph* graph, int user, const int** following);
+bool bidirectionalShortestPath(Graph* graph, BFSScratch* forward, BFSScratch* backward, int source, int target, PathResult* result);
+
+// 25-etapa: Contatos com data e alcançabilidade respeitando o tempo
+int generateTemporalEdges(Graph* graph, int contactsPerConnection, long long begin, long long end, unsigned int seed, TemporalEdge** edges);
+TemporalCSR* buildTemporalCSR(int numUsers, const TemporalEdge* edges, int count, bool directed);
+void freeTemporalCSR(TemporalCSR* tcsr);
+int temporalNeighbors(const TemporalCSR* tcsr, int user, long long begin, long long end, const int** neighbors, const long long** times);
+int earliestArrivalTimes(const TemporalCSR* tcsr, DijkstraScratch* scratch, int source, long long begin, long long end, long long* arrival);
+long long earliestArrivalPath(const TemporalCSR* tcsr, DijkstraScratch* scratch, int source, int target, long long begin, long long end, PathResult* result, long long* hopTimes);
+
+// 26-etapa: BFS fora da memória (out-of-core) sobre o snapshot mapeado
+long long externalBFS(const char* snapshotPath, const char* workDir, int source, size_t batchBytes, int* distance, int* numLevels);
+
+// 27-etapa: Grafo particionado em vários processos (BFS distribuída por IPC local)
+void partitionByCommunity(Graph* graph, int numParts, int* owner);
+PartitionedGraph* createPartitionedGraph(Graph* graph, int numParts, const int* owner, const PartitionTransport* transport);
+void freePartitionedGraph(PartitionedGraph* pg);
+bool partitionedShortestPath(PartitionedGraph* pg, int source, int target, PathResult* result);
+
+// Funções auxiliares
+void freeGraph(Graph* graph);
+
+#endif
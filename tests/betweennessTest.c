@@ -0,0 +1,75 @@
+// Teste da intermediação exata (11-etapa) em grafos pequenos não direcionados e no modo de seguidores
+// (24-etapa), com os valores conferidos à mão.
+#include "redesocial.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Função para comparar a intermediação de um grafo com os valores esperados
+// name: Nome do caso, usado nas mensagens
+// numUsers: Número de usuários
+// edges: Pares (origem, destino) das conexões
+// numEdges: Número de conexões
+// directed: Se as conexões são seguidas (modo de seguidores)
+// expected: Intermediação esperada de cada usuário
+// Retorna o número de falhas
+static int checkBetweenness(const char* name, int numUsers, const int (*edges)[2], int numEdges, bool directed, const double* expected) {
+    Graph* graph = createNumberedGraph(numUsers);
+    if (directed) enableDirectedMode(graph);
+    for (int i = 0; i < numEdges; i++) {
+        if (directed) {
+            addFollow(graph, edges[i][0], edges[i][1]);
+        } else {
+            addConnection(graph, edges[i][0], edges[i][1]);
+        }
+    }
+
+    double* centrality = (double*)malloc(numUsers * sizeof(double));
+    if (!centrality) exit(1);  // Verificação de alocação de memória
+    computeBetweenness(graph, centrality);
+
+    int failures = 0;
+    for (int v = 0; v < numUsers; v++) {
+        if (fabs(centrality[v] - expected[v]) > 1e-9) {
+            printf("%s: usuario %d: intermediacao %g, esperado %g\n", name, v, centrality[v], expected[v]);
+            failures++;
+        }
+    }
+    free(centrality);
+    freeGraph(graph);
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+
+    // Cadeia 0 - 1 - 2: só o par {0, 2} passa por 1
+    static const int chain[][2] = { {0, 1}, {1, 2} };
+    static const double chainExpected[] = { 0.0, 1.0, 0.0 };
+    failures += checkBetweenness("cadeia", 3, chain, 2, false, chainExpected);
+    failures += checkBetweenness("cadeia direcionada", 3, chain, 2, true, chainExpected);
+
+    // Cadeia 0 -> 1 -> 2 -> 3: pares ordenados (0, 2), (0, 3) passam por 1 e (0, 3), (1, 3) por 2
+    static const int longChain[][2] = { {0, 1}, {1, 2}, {2, 3} };
+    static const double longChainExpected[] = { 0.0, 2.0, 2.0, 0.0 };
+    failures += checkBetweenness("cadeia longa", 4, longChain, 3, false, longChainExpected);
+    failures += checkBetweenness("cadeia longa direcionada", 4, longChain, 3, true, longChainExpected);
+
+    // Ciclo 0 -> 1 -> 2 -> 0: cada usuário está no único caminho entre os outros dois; sem direção não há
+    // intermediários
+    static const int cycle[][2] = { {0, 1}, {1, 2}, {2, 0} };
+    static const double cycleDirectedExpected[] = { 1.0, 1.0, 1.0 };
+    static const double cycleExpected[] = { 0.0, 0.0, 0.0 };
+    failures += checkBetweenness("triangulo", 3, cycle, 3, false, cycleExpected);
+    failures += checkBetweenness("ciclo direcionado", 3, cycle, 3, true, cycleDirectedExpected);
+
+    // Estrela com seguidas 1 -> 0 e 0 -> 2, 0 -> 3: o centro liga 1 a 2 e 1 a 3, mas 2 e 3 não se alcançam
+    static const int star[][2] = { {1, 0}, {0, 2}, {0, 3} };
+    static const double starDirectedExpected[] = { 2.0, 0.0, 0.0, 0.0 };
+    static const double starExpected[] = { 3.0, 0.0, 0.0, 0.0 };
+    failures += checkBetweenness("estrela", 4, star, 3, false, starExpected);
+    failures += checkBetweenness("estrela direcionada", 4, star, 3, true, starDirectedExpected);
+
+    printf("computeBetweenness: %d falha(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
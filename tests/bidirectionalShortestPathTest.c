@@ -0,0 +1,85 @@
+// Teste da busca bidirecional no modo de seguidores (24-etapa): a distância deve ser a mesma de
+// shortestPath, e o caminho deve seguir o sentido das conexões.
+#include "redesocial.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_QUERIES 500  // Consultas por grafo
+
+// Função para conferir um caminho devolvido pela busca bidirecional
+// graph: Grafo direcionado
+// result: Caminho a conferir
+// source, target: Extremos esperados
+// Retorna true se o caminho começa em source, termina em target e cada passo é uma seguida
+static bool validFollowPath(Graph* graph, const PathResult* result, int source, int target) {
+    if (result->length != result->distance + 1 || result->path[0] != source || result->path[result->length - 1] != target) {
+        return false;
+    }
+    for (int i = 0; i + 1 < result->length; i++) {
+        const int* following;
+        int count = followingOf(graph, result->path[i], &following);
+        bool found = false;
+        for (int k = 0; k < count && !found; k++) {
+            found = following[k] == result->path[i + 1];
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Função para comparar a busca bidirecional com shortestPath em um grafo direcionado sorteado
+// numUsers: Número de usuários
+// followsPerUser: Média de seguidas por usuário
+// seed: Semente do grafo e das consultas
+// Retorna o número de falhas
+static int checkBidirectional(int numUsers, int followsPerUser, unsigned int seed) {
+    Graph* graph = createNumberedGraph(numUsers);
+    enableDirectedMode(graph);
+    srand(seed);
+    for (int i = 0; i < followsPerUser * numUsers; i++) {
+        int a = rand() % numUsers;
+        int b = rand() % numUsers;
+        if (a != b && !connectionExists(graph, a, b)) addFollow(graph, a, b);
+    }
+
+    BFSScratch* scratch = createBFSScratch(numUsers);
+    BFSScratch* forward = createBFSScratch(numUsers);
+    BFSScratch* backward = createBFSScratch(numUsers);
+    PathResult expected = { (int*)malloc(numUsers * sizeof(int)), numUsers, 0, 0 };
+    PathResult result = { (int*)malloc(numUsers * sizeof(int)), numUsers, 0, 0 };
+    if (!expected.path || !result.path) exit(1);  // Verificação de alocação de memória
+
+    int failures = 0;
+    for (int q = 0; q < TEST_QUERIES; q++) {
+        int source = rand() % numUsers;
+        int target = q == 0 ? source : rand() % numUsers;  // A primeira consulta tem origem igual ao destino
+        bool foundExpected = shortestPath(graph, scratch, source, target, &expected);
+        bool found = bidirectionalShortestPath(graph, forward, backward, source, target, &result);
+        if (found != foundExpected || result.distance != expected.distance) {
+            printf("n=%d: %d -> %d: distancia %d, bidirecional %d\n", numUsers, source, target, expected.distance, result.distance);
+            failures++;
+        } else if (found && !validFollowPath(graph, &result, source, target)) {
+            printf("n=%d: %d -> %d: caminho bidirecional invalido\n", numUsers, source, target);
+            failures++;
+        }
+    }
+
+    freeBFSScratch(scratch);
+    freeBFSScratch(forward);
+    freeBFSScratch(backward);
+    free(expected.path);
+    free(result.path);
+    freeGraph(graph);
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    failures += checkBidirectional(200, 2, 1);  // Pequeno e esparso: muitos pares sem caminho
+    failures += checkBidirectional(5000, 3, 2);
+    failures += checkBidirectional(20000, 8, 3);  // Denso: as duas fronteiras crescem rápido
+    printf("bidirectionalShortestPath: %d falha(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
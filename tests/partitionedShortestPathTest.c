@@ -0,0 +1,108 @@
+// Teste do grafo particionado em processos (27-etapa): o menor caminho distribuído deve ter a mesma
+// distância que a BFS local e ser um caminho válido do grafo.
+#include "redesocial.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+
+#define TEST_USERS 5000  // Usuários de cada grafo
+#define TEST_PARTS 4  // Partições (processos)
+#define TEST_QUERIES 200  // Consultas por grafo
+
+// Função para conferir um caminho devolvido pela busca particionada
+// graph: Grafo original
+// result: Caminho a conferir
+// source, target: Extremos esperados
+// Retorna true se o caminho começa em source, termina em target e só usa conexões do grafo
+static bool validPath(Graph* graph, const PathResult* result, int source, int target) {
+    if (result->length != result->distance + 1 || result->path[0] != source || result->path[result->length - 1] != target) {
+        return false;
+    }
+    for (int i = 0; i + 1 < result->length; i++) {
+        if (!connectionExists(graph, result->path[i], result->path[i + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Função para comparar a busca particionada com shortestPath em consultas sorteadas
+// name: Nome do grafo nas mensagens de erro
+// graph: Grafo com as conexões já criadas
+// owner: Partição de cada usuário (NULL para faixas contíguas de IDs)
+// seed: Semente das consultas
+// Retorna o número de falhas
+static int checkPartitioned(const char* name, Graph* graph, const int* owner, unsigned int seed) {
+    int n = graph->numUsers;
+    PartitionedGraph* pg = createPartitionedGraph(graph, TEST_PARTS, owner, NULL);
+    if (!pg) {
+        printf("%s: createPartitionedGraph falhou\n", name);
+        return 1;
+    }
+    BFSScratch* scratch = createBFSScratch(n);
+    PathResult local = { (int*)malloc(n * sizeof(int)), n, 0, 0 };
+    PathResult distributed = { (int*)malloc(n * sizeof(int)), n, 0, 0 };
+    if (!local.path || !distributed.path) exit(1);  // Verificação de alocação de memória
+
+    int failures = 0;
+    srand(seed);
+    for (int q = 0; q < TEST_QUERIES; q++) {
+        int source = rand() % n;
+        int target = q == 0 ? source : rand() % n;  // A primeira consulta tem origem igual ao destino
+        bool foundLocal = shortestPath(graph, scratch, source, target, &local);
+        bool foundDistributed = partitionedShortestPath(pg, source, target, &distributed);
+        if (foundLocal != foundDistributed || local.distance != distributed.distance) {
+            printf("%s: %d -> %d: distancia %d, particionado %d\n", name, source, target, local.distance, distributed.distance);
+            failures++;
+        } else if (foundDistributed && !validPath(graph, &distributed, source, target)) {
+            printf("%s: %d -> %d: caminho particionado invalido\n", name, source, target);
+            failures++;
+        }
+    }
+
+    freePartitionedGraph(pg);
+    freeBFSScratch(scratch);
+    free(local.path);
+    free(distributed.path);
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+
+    // Grafo de ligação preferencial com partições por faixa de IDs
+    Graph* graph = createNumberedGraph(TEST_USERS);
+    generatePreferentialConnections(graph, 3, 1);
+    failures += checkPartitioned("preferencial", graph, NULL, 1);
+
+    // Mesmo grafo com partições por comunidade
+    int* owner = (int*)malloc(TEST_USERS * sizeof(int));
+    if (!owner) exit(1);  // Verificação de alocação de memória
+    partitionByCommunity(graph, TEST_PARTS, owner);
+    failures += checkPartitioned("comunidades", graph, owner, 2);
+    free(owner);
+    freeGraph(graph);
+
+    // Grafo direcionado esparso (há pares sem caminho)
+    graph = createNumberedGraph(TEST_USERS);
+    enableDirectedMode(graph);
+    srand(3);
+    for (int i = 0; i < 2 * TEST_USERS; i++) {
+        int a = rand() % TEST_USERS;
+        int b = rand() % TEST_USERS;
+        if (a != b && !connectionExists(graph, a, b)) addFollow(graph, a, b);
+    }
+    failures += checkPartitioned("direcionado", graph, NULL, 4);
+    freeGraph(graph);
+
+    // Os processos das partições já terminaram e foram recolhidos
+    errno = 0;
+    if (waitpid(-1, NULL, WNOHANG) != -1 || errno != ECHILD) {
+        printf("processo de particao nao recolhido\n");
+        failures++;
+    }
+
+    printf("partitionedShortestPath: %d falha(s)\n", failures);
+    return failures == 0 ? 0 : 1;
+}